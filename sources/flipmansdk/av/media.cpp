@@ -4,6 +4,7 @@
 
 #include <flipmansdk/av/media.h>
 #include <flipmansdk/core/application.h>
+#include <flipmansdk/core/framecache.h>
 #include <flipmansdk/plugins/mediareader.h>
 #include <flipmansdk/plugins/pluginregistry.h>
 #include <QEventLoop>
@@ -19,6 +20,11 @@ public:
         bool open;
         core::File file;
         core::Error error;
+        core::ImageBuffer image;
+        Time time;
+        TimeRange seekRange;
+        bool cached = false;
+        bool seekPending = false;
         QScopedPointer<plugins::MediaReader> reader;
     };
     Data d;
@@ -52,6 +58,9 @@ Media::open(const core::File& file)
     p->d.file = file;
     p->d.open = false;
     p->d.error.reset();
+    p->d.seekRange.reset();
+    p->d.cached = false;
+    p->d.seekPending = false;
 
     plugins::MediaReader* reader = p->reader(file.extension());
 
@@ -102,14 +111,48 @@ Time
 Media::read()
 {
     Q_ASSERT("media is not open" && isOpen());
-    return p->d.reader->read();
+    plugins::MediaReader* reader = p->d.reader.get();
+    const QString key = p->d.file.filePath();
+    const Time time = this->time();
+    const bool cacheFrames = reader->supportsImage() && !reader->supportsFrameCache();
+    if (cacheFrames) {
+        if (core::frameCache()->find(key, time.frames(), p->d.image)) {
+            // serve cached frames without touching the reader, it is only
+            // repositioned once a frame is missed, scrubbing never decodes.
+            p->d.cached = true;
+            p->d.seekPending = true;
+            p->d.time = Time(time, time.ticks() + time.tpf());
+            return p->d.time;
+        }
+        if (p->d.seekPending) {
+            const TimeRange range = p->d.seekRange.isValid() ? p->d.seekRange : reader->timeRange();
+            reader->seek(TimeRange(time, range.end() - time));
+            p->d.seekPending = false;
+        }
+    }
+    p->d.cached = false;
+    const Time next = reader->read();
+    if (cacheFrames && next > time) {
+        core::frameCache()->insert(key, time.frames(), reader->image());
+    }
+    return next;
 }
 
 Time
 Media::seek(const TimeRange& range) const
 {
     Q_ASSERT("media is not open" && isOpen());
-    return p->d.reader->seek(range);
+    plugins::MediaReader* reader = p->d.reader.get();
+    p->d.seekRange = range;
+    p->d.cached = false;
+    if (reader->supportsImage() && !reader->supportsFrameCache()
+        && core::frameCache()->contains(p->d.file.filePath(), range.start().frames())) {
+        p->d.seekPending = true;
+        p->d.time = range.start();
+        return p->d.time;
+    }
+    p->d.seekPending = false;
+    return reader->seek(range);
 }
 
 Time
@@ -123,7 +166,7 @@ Time
 Media::time() const
 {
     Q_ASSERT("media is not open" && isOpen());
-    return p->d.reader->time();
+    return p->d.seekPending ? p->d.time : p->d.reader->time();
 }
 
 Fps
@@ -157,7 +200,7 @@ core::ImageBuffer
 Media::image() const
 {
     Q_ASSERT("media is not open and must support images" && isOpen() && p->d.reader->supportsImage());
-    return p->d.reader->image();
+    return p->d.cached ? p->d.image : p->d.reader->image();
 }
 
 core::MetaData
@@ -4,19 +4,196 @@
 
 #include <flipmansdk/av/mediaprocessor.h>
 #include <flipmansdk/core/application.h>
+#include <flipmansdk/core/threadpool.h>
 #include <flipmansdk/plugins/mediawriter.h>
 #include <flipmansdk/plugins/pluginregistry.h>
-#include <QtConcurrent>
+#include <QMap>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <memory>
 
 namespace flipman::sdk::av {
+
+namespace {
+    struct Frame {
+        qint64 index = 0;
+        Time time;
+        core::ImageBuffer image;
+    };
+
+    template<typename T> class BoundedQueue {
+    public:
+        explicit BoundedQueue(qsizetype capacity)
+            : capacity(qMax<qsizetype>(1, capacity))
+        {}
+
+        bool push(T item)
+        {
+            QMutexLocker locker(&mutex);
+            while (!closed && items.size() >= capacity)
+                notFull.wait(&mutex);
+            if (closed)
+                return false;
+            items.enqueue(std::move(item));
+            notEmpty.wakeOne();
+            return true;
+        }
+
+        bool pop(T& item)
+        {
+            // a closed queue still hands out what it holds, abort() drops it.
+            QMutexLocker locker(&mutex);
+            while (!closed && items.isEmpty())
+                notEmpty.wait(&mutex);
+            if (items.isEmpty())
+                return false;
+            item = items.dequeue();
+            notFull.wakeOne();
+            return true;
+        }
+
+        void close()
+        {
+            QMutexLocker locker(&mutex);
+            closed = true;
+            notFull.wakeAll();
+            notEmpty.wakeAll();
+        }
+
+        void abort()
+        {
+            QMutexLocker locker(&mutex);
+            items.clear();
+            closed = true;
+            notFull.wakeAll();
+            notEmpty.wakeAll();
+        }
+
+    private:
+        QMutex mutex;
+        QWaitCondition notFull;
+        QWaitCondition notEmpty;
+        QQueue<T> items;
+        qsizetype capacity;
+        bool closed = false;
+    };
+}  // namespace
+
 class MediaProcessorPrivate {
 public:
+    struct Pipeline {
+        Pipeline(qsizetype workers, qsizetype window);
+        void fail(const core::Error& error);
+        bool waitForWindow(qint64 index);
+        void advance();
+        void started();
+        void finished();
+        void waitForFinished();
+        BoundedQueue<Frame> read;
+        BoundedQueue<Frame> converted;
+        qsizetype window;
+        std::atomic<qsizetype> workers;
+        std::atomic<bool> failed { false };
+        QMutex mutex;
+        QWaitCondition progress;
+        qint64 written = 0;
+        int running = 0;
+        core::Error error;
+    };
+    static core::ImageBuffer convert(const core::ImageBuffer& image);
+    static core::Error writeError(const core::File& file, const Time& time, const core::Error& error);
     struct Data {
         core::Error error;
     };
     Data d;
 };
 
+MediaProcessorPrivate::Pipeline::Pipeline(qsizetype workers, qsizetype window)
+    : read(workers)
+    , converted(window)
+    , window(window)
+    , workers(workers)
+{}
+
+void
+MediaProcessorPrivate::Pipeline::fail(const core::Error& error)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (!failed.exchange(true))
+            this->error = error;
+        progress.wakeAll();
+    }
+    read.abort();
+    converted.abort();
+}
+
+bool
+MediaProcessorPrivate::Pipeline::waitForWindow(qint64 index)
+{
+    // the reader never runs more than a window of frames ahead of the
+    // writer, frames waiting to be reordered stay bounded.
+    QMutexLocker locker(&mutex);
+    while (!failed && index - written >= window)
+        progress.wait(&mutex);
+    return !failed;
+}
+
+void
+MediaProcessorPrivate::Pipeline::advance()
+{
+    QMutexLocker locker(&mutex);
+    written++;
+    progress.wakeAll();
+}
+
+void
+MediaProcessorPrivate::Pipeline::started()
+{
+    QMutexLocker locker(&mutex);
+    running++;
+}
+
+void
+MediaProcessorPrivate::Pipeline::finished()
+{
+    QMutexLocker locker(&mutex);
+    if (--running == 0)
+        progress.wakeAll();
+}
+
+void
+MediaProcessorPrivate::Pipeline::waitForFinished()
+{
+    QMutexLocker locker(&mutex);
+    while (running > 0)
+        progress.wait(&mutex);
+}
+
+core::ImageBuffer
+MediaProcessorPrivate::convert(const core::ImageBuffer& image)
+{
+    // writers expect rgb, ycbcr frames from video readers are decoded here,
+    // 10-bit v210 keeps its precision as half.
+    if (!image.isYCbCr())
+        return image;
+
+    const bool wide = image.pixelLayout() == core::ImageBuffer::PixelLayout::V210;
+    return core::ImageBuffer::decode(image, wide ? core::ImageFormat::Half : core::ImageFormat::UInt8);
+}
+
+core::Error
+MediaProcessorPrivate::writeError(const core::File& file, const Time& time, const core::Error& error)
+{
+    return core::Error("mediaprocessor", QString("could not write frame for file: %1, error: %2")
+                                             .arg(file.fileName(time.frames()))
+                                             .arg(error.message()));
+}
+
 MediaProcessor::MediaProcessor(QObject* parent)
     : QObject(parent)
     , p(new MediaProcessorPrivate())
@@ -29,31 +206,99 @@ MediaProcessor::write(Media& media, const TimeRange& timeRange, const core::File
 {
     QScopedPointer<plugins::MediaWriter> writer(
         core::pluginRegistry()->getPlugin<plugins::MediaWriter>(file.extension()));
-    if (writer) {
-        writer->open(file);
-        writer->setTimeRange(timeRange);
-        av::Time time = media.seek(timeRange);
-        for (qint64 frame = timeRange.start().frames(); frame < timeRange.duration().frames(); frame++) {
-            av::Time next = av::Time::fromFrames(frame, media.fps());
-            if (time < next || frame == timeRange.start().frames()) {
+    if (!writer) {
+        p->d.error = core::Error("mediaprocessor",
+                                 QString("could not find plugin for extension: %1").arg(file.extension()));
+        qWarning() << "warning: " << p->d.error.message();
+        return false;
+    }
+
+    writer->open(file);
+    writer->setTimeRange(timeRange);
+
+    // three stages connected by bounded queues: a reader on its own thread
+    // so it never waits behind pool work, workers on the core thread pool
+    // that convert and, for concurrent writers, also encode and write, and
+    // the calling thread that commits frames in order.
+    const bool concurrent = writer->supportsConcurrent();
+    const qsizetype workers = qMax(1, core::threadPool()->maxThreadCount() - 1);
+    auto pipeline = std::make_shared<MediaProcessorPrivate::Pipeline>(workers, workers * 2);
+
+    const qint64 start = timeRange.start().frames();
+    const qint64 end = start + timeRange.duration().frames();
+
+    QScopedPointer<QThread> reader(QThread::create([pipeline, &media, &timeRange, start, end]() {
+        Time time = media.seek(timeRange);
+        for (qint64 frame = start; frame < end; frame++) {
+            const Time next = Time::fromFrames(frame, media.fps());
+            if (time < next || frame == start) {
                 time = media.read();
             }
-            if (!writer->write(media.image())) {
-                p->d.error = core::Error("mediaprocessor",
-                                         QString("could not write frame for file: %1").arg(file.fileName(frame)));
-                qWarning() << "warning: " << p->d.error.message();
-                return false;
+            Frame item { frame - start, next, media.image() };
+            if (!pipeline->waitForWindow(item.index) || !pipeline->read.push(std::move(item)))
+                break;
+        }
+        pipeline->read.close();
+    }));
+    reader->start();
+
+    plugins::MediaWriter* target = writer.data();
+    for (qsizetype i = 0; i < workers; ++i) {
+        pipeline->started();
+        core::threadPool()->start([pipeline, target, concurrent, &file]() {
+            Frame item;
+            while (pipeline->read.pop(item)) {
+                item.image = MediaProcessorPrivate::convert(item.image);
+                if (concurrent) {
+                    target->write(item.image, item.time);
+                    const core::Error error = target->error();
+                    if (error.hasError()) {
+                        pipeline->fail(MediaProcessorPrivate::writeError(file, item.time, error));
+                        break;
+                    }
+                    item.image = core::ImageBuffer();
+                }
+                if (!pipeline->converted.push(std::move(item)))
+                    break;
+            }
+            if (--pipeline->workers == 0)
+                pipeline->converted.close();
+            pipeline->finished();
+        });
+    }
+
+    // progress follows committed frames, a stalled writer holds back the
+    // reader through the window instead of reporting frames still queued.
+    QMap<qint64, Frame> pending;
+    qint64 index = 0;
+    Frame item;
+    while (pipeline->converted.pop(item)) {
+        pending.insert(item.index, std::move(item));
+        while (!pending.isEmpty() && pending.firstKey() == index) {
+            Frame frame = pending.take(index);
+            if (!concurrent) {
+                writer->write(frame.image);
+                const core::Error error = writer->error();
+                if (error.hasError()) {
+                    pipeline->fail(MediaProcessorPrivate::writeError(file, frame.time, error));
+                    break;
+                }
             }
-            Q_EMIT progressChanged(next, timeRange);
+            pipeline->advance();
+            index++;
+            Q_EMIT progressChanged(frame.time, timeRange);
         }
-        return true;
     }
-    else {
-        p->d.error = core::Error("mediaprocessor",
-                                 QString("could not find plugin for extension: %1").arg(file.extension()));
+    reader->wait();
+    pipeline->waitForFinished();
+
+    if (pipeline->failed) {
+        p->d.error = pipeline->error;
         qWarning() << "warning: " << p->d.error.message();
         return false;
     }
+    Q_EMIT finished();
+    return true;
 }
 
 core::Error
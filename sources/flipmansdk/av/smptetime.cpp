@@ -2,37 +2,14 @@
 // Copyright (c) 2022 - present Mikael Sundell.
 
 #include <flipmansdk/av/smptetime.h>
+#include <QString>
 
-namespace flipman::sdk::av {
-class SmpteTimePrivate : public QSharedData {
-public:
-    qint64 frame() const;
-    void update();
-    struct Data {
-        Time time;
-        quint32 counter = 0;
-        qint16 hours = 0;
-        qint16 minutes = 0;
-        qint16 seconds = 0;
-        qint16 frames = 0;
-        qint16 subFrames = 1;
-        qint16 subFrameDivisor = 0;
-        bool negatives = true;
-        bool fullHours = true;
-    };
-    Data d;
-};
-
-qint64
-SmpteTimePrivate::frame() const
-{
-    Q_ASSERT("time is not valid" && d.time.isValid());
+#include <limits>
 
-    return d.time.frames();
-}
+namespace flipman::sdk::av {
 
 void
-SmpteTimePrivate::update()
+SmpteTime::update()
 {
     Q_ASSERT("time is not valid" && d.time.isValid());
 
@@ -63,108 +40,96 @@ SmpteTimePrivate::update()
     }
 }
 
-SmpteTime::SmpteTime()
-    : p(new SmpteTimePrivate())
-{}
-
 SmpteTime::SmpteTime(const Time& time)
-    : p(new SmpteTimePrivate())
 {
-    p->d.time = time;
-    p->update();
+    d.time = time;
+    update();
 }
 
-SmpteTime::SmpteTime(const SmpteTime& other)
-    : p(other.p)
-{}
-
-SmpteTime::~SmpteTime() {}
-
 quint32
 SmpteTime::counter() const
 {
-    return p->d.counter;
+    return d.counter;
 }
 
 qint16
 SmpteTime::hours() const
 {
-    return p->d.hours;
+    return d.hours;
 }
 
 qint16
 SmpteTime::minutes() const
 {
-    return p->d.minutes;
+    return d.minutes;
 }
 
 qint16
 SmpteTime::seconds() const
 {
-    return p->d.seconds;
+    return d.seconds;
 }
 
 qint16
 SmpteTime::frames() const
 {
-    return p->d.frames;
+    return d.frames;
 }
 
 qint16
 SmpteTime::subFrames() const
 {
-    return p->d.subFrames;
+    return d.subFrames;
 }
 
 qint16
 SmpteTime::subframeDivisor() const
 {
-    return p->d.subFrameDivisor;
+    return d.subFrameDivisor;
 }
 
 qint64
 SmpteTime::frame() const
 {
-    return p->frame();
+    Q_ASSERT("time is not valid" && d.time.isValid());
+
+    return d.time.frames();
 }
 
 Time
 SmpteTime::time() const
 {
-    return p->d.time;
+    return d.time;
 }
 
 bool
 SmpteTime::negatives() const
 {
-    return p->d.negatives;
+    return d.negatives;
 }
 
 void
 SmpteTime::setTime(const Time& time)
 {
-    p.detach();
-    p->d.time = time;
-    p->update();
+    d.time = time;
+    update();
 }
 
 void
 SmpteTime::setNegatives(bool negatives)
 {
-    if (p->d.negatives != negatives) {
-        p.detach();
-        p->d.negatives = negatives;
-        p->update();
+    if (d.negatives != negatives) {
+        d.negatives = negatives;
+        update();
     }
 }
 
 void
 SmpteTime::setFullHours(bool fullHours)
 {
-    if (p->d.fullHours != fullHours) {
-        p.detach();
-        p->d.fullHours = fullHours;
-        p->update();
+    if (d.fullHours != fullHours) {
+        d.fullHours = fullHours;
+        update();
     }
 }
 
@@ -172,48 +137,38 @@ QString
 SmpteTime::toString() const
 {
     QString text;
-    if (p->d.time.fps().dropFrame()) {
+    if (d.time.fps().dropFrame()) {
         text = "%1:%2:%3.%4";  // use . for drop frames
     }
     else {
         text = "%1:%2:%3:%4";
     }
     return QString(text)
-        .arg(p->d.hours, 2, 10, QChar('0'))
-        .arg(p->d.minutes, 2, 10, QChar('0'))
-        .arg(p->d.seconds, 2, 10, QChar('0'))
-        .arg(p->d.frames, 2, 10, QChar('0'));
+        .arg(d.hours, 2, 10, QChar('0'))
+        .arg(d.minutes, 2, 10, QChar('0'))
+        .arg(d.seconds, 2, 10, QChar('0'))
+        .arg(d.frames, 2, 10, QChar('0'));
 }
 
 bool
 SmpteTime::isValid() const
 {
-    return p->d.hours >= 0 && p->d.hours < 24 && p->d.minutes >= 0 && p->d.minutes < 60 && p->d.seconds >= 0
-           && p->d.seconds < 60 && p->d.frames >= 0 && p->d.subFrames >= 0 && p->d.subFrameDivisor > 0;
+    return d.hours >= 0 && d.hours < 24 && d.minutes >= 0 && d.minutes < 60 && d.seconds >= 0
+           && d.seconds < 60 && d.frames >= 0 && d.subFrames >= 0 && d.subFrameDivisor > 0;
 }
 
 void
 SmpteTime::reset()
 {
-    p.detach();
-    p->d.time.reset();
-}
-
-SmpteTime&
-SmpteTime::operator=(const SmpteTime& other)
-{
-    if (this != &other) {
-        p = other.p;
-    }
-    return *this;
+    d.time.reset();
 }
 
 bool
 SmpteTime::operator==(const SmpteTime& other) const
 {
-    return p->d.counter == other.p->d.counter && p->d.hours == other.p->d.hours && p->d.minutes == other.p->d.minutes
-           && p->d.seconds == other.p->d.seconds && p->d.frames == other.p->d.frames
-           && p->d.subFrames == other.p->d.subFrames && p->d.subFrameDivisor == other.p->d.subFrameDivisor;
+    return d.counter == other.d.counter && d.hours == other.d.hours && d.minutes == other.d.minutes
+           && d.seconds == other.d.seconds && d.frames == other.d.frames
+           && d.subFrames == other.d.subFrames && d.subFrameDivisor == other.d.subFrameDivisor;
 }
 
 bool
@@ -249,18 +204,18 @@ SmpteTime::operator>=(const SmpteTime& other) const
 SmpteTime
 SmpteTime::operator+(const SmpteTime& other) const
 {
-    Q_ASSERT("fps must match" && p->d.time.fps() == other.time().fps());
+    Q_ASSERT("fps must match" && d.time.fps() == other.time().fps());
     qint64 frames = this->time().frames() + other.time().frames();
-    Time time = Time::fromFrames(frames, p->d.time.fps());
+    Time time = Time::fromFrames(frames, d.time.fps());
     return SmpteTime(time);
 }
 
 SmpteTime
 SmpteTime::operator-(const SmpteTime& other) const
 {
-    Q_ASSERT("fps must match" && p->d.time.fps() == other.time().fps());
+    Q_ASSERT("fps must match" && d.time.fps() == other.time().fps());
     qint64 frames = this->time().frames() - other.time().frames();
-    Time time = Time::fromFrames(frames, p->d.time.fps());
+    Time time = Time::fromFrames(frames, d.time.fps());
     return SmpteTime(time);
 }
 
@@ -3,267 +3,165 @@
 // https://github.com/mikaelsundell/flipman
 
 #include <flipmansdk/av/time.h>
+#include <QString>
+#include <QtMath>
 
-namespace flipman::sdk::av {
-class TimePrivate : public QSharedData {
-public:
-    qreal tpf();
-    qint64 ticks(qint64 frame);
-    qint64 frame(qint64 ticks);
-    qint64 frames();
-    QString toString(qreal seconds);
-    struct Data {
-        Fps fps = Fps::fps24();
-        qint64 ticks = 0;
-        qint32 timeScale = 24000;  // default timescale
-    };
-    Data d;
-};
-
-qreal
-TimePrivate::tpf()
-{
-    return static_cast<qreal>(d.timeScale) / d.fps.real();
-};
+#include <cmath>
 
-qint64
-TimePrivate::ticks(qint64 frame)
-{
-    return static_cast<qint64>(std::round(frame * tpf()));
-}
-
-qint64
-TimePrivate::frame(qint64 ticks)
-{
-    return static_cast<qint64>(std::round(ticks / tpf()));
-}
-
-qint64
-TimePrivate::frames()
-{
-    return static_cast<qint64>(std::round(d.ticks / tpf()));
-}
+namespace flipman::sdk::av {
 
-QString
-TimePrivate::toString(qreal seconds)
-{
-    qint64 secs = qFloor(seconds);  // complete seconds
-    qint64 minutes = secs / 60;
-    qint64 hours = minutes / 60;
-    secs %= 60;
-    minutes %= 60;
-    if (hours > 0) {
-        return QString("%1:%2:%3")
-            .arg(hours, 2, 10, QChar('0'))
-            .arg(minutes, 2, 10, QChar('0'))
-            .arg(secs, 2, 10, QChar('0'));
-    }
-    else {
-        return QString("%1:%2").arg(minutes, 2, 10, QChar('0')).arg(secs, 2, 10, QChar('0'));
+namespace {
+    qint64 rescale(qint64 value, qint64 multiplier, qint64 divisor)
+    {
+        // value * multiplier / divisor rounded half away from zero, the same
+        // rounding std::round gives but without going through floating point.
+        // an invalid time or fps has a zero divisor and converts to 0.
+        if (divisor <= 0)
+            return 0;
+
+#if defined(__SIZEOF_INT128__)
+        const __int128 numerator = static_cast<__int128>(value) * multiplier;
+        const __int128 scale = static_cast<__int128>(divisor) * 2;
+        if (numerator >= 0)
+            return static_cast<qint64>((numerator * 2 + divisor) / scale);
+        return -static_cast<qint64>((-numerator * 2 + divisor) / scale);
+#else
+        return static_cast<qint64>(std::llround(static_cast<long double>(value) * multiplier / divisor));
+#endif
     }
-}
 
-Time::Time()
-    : p(new TimePrivate())
-{
-    p->d.timeScale = 0;
-}
-
-Time::Time(qint64 ticks, qint32 timeScale, const Fps& fps)
-    : p(new TimePrivate())
-{
-    p->d.ticks = ticks;
-    p->d.timeScale = timeScale;
-    p->d.fps = fps;
-}
-
-Time::Time(const Time& other, qint64 ticks)
-    : p(other.p)
-{
-    setTicks(ticks);
-}
-
-Time::Time(const Time& other, const Fps& fps)
-    : p(other.p)
-{
-    setFps(fps);
-}
-
-Time::Time(const Time& other)
-    : p(other.p)
-{}
-
-Time::~Time() {}
-
-
-Fps
-Time::fps() const
-{
-    return p->d.fps;
-}
+    int compare(const Time& time, const Time& other)
+    {
+        if (time.timeScale() == other.timeScale())
+            return (time.ticks() > other.ticks()) - (time.ticks() < other.ticks());
+
+#if defined(__SIZEOF_INT128__)
+        const __int128 lhs = static_cast<__int128>(time.ticks()) * other.timeScale();
+        const __int128 rhs = static_cast<__int128>(other.ticks()) * time.timeScale();
+#else
+        const long double lhs = static_cast<long double>(time.ticks()) * other.timeScale();
+        const long double rhs = static_cast<long double>(other.ticks()) * time.timeScale();
+#endif
+        return (lhs > rhs) - (lhs < rhs);
+    }
 
-qint64
-Time::ticks() const
-{
-    return p->d.ticks;
-}
+    QString toString(qreal seconds)
+    {
+        qint64 secs = qFloor(seconds);  // complete seconds
+        qint64 minutes = secs / 60;
+        qint64 hours = minutes / 60;
+        secs %= 60;
+        minutes %= 60;
+        if (hours > 0) {
+            return QString("%1:%2:%3")
+                .arg(hours, 2, 10, QChar('0'))
+                .arg(minutes, 2, 10, QChar('0'))
+                .arg(secs, 2, 10, QChar('0'));
+        }
+        else {
+            return QString("%1:%2").arg(minutes, 2, 10, QChar('0')).arg(secs, 2, 10, QChar('0'));
+        }
+    }
+}  // namespace
 
 qint64
 Time::ticks(qint64 frame) const
 {
-    return p->ticks(frame);
-}
-
-qint32
-Time::timeScale() const
-{
-    return p->d.timeScale;
+    // ticks for a frame are rounded once from timescale * den / num, no
+    // error accumulates over frames as it would stepping by tpf().
+    return rescale(frame, static_cast<qint64>(d.timeScale) * d.fps.denominator(), d.fps.numerator());
 }
 
 qint64
 Time::tpf() const
 {
-    return static_cast<qint64>(std::round(p->tpf()));
+    return rescale(d.timeScale, d.fps.denominator(), d.fps.numerator());
 }
 
 qint64
 Time::frame(qint64 ticks) const
 {
-    return p->frame(ticks);
+    return rescale(ticks, d.fps.numerator(), static_cast<qint64>(d.timeScale) * d.fps.denominator());
 }
 
 qint64
 Time::lastFrame() const
 {
-    return p->frames() - 1;
+    return frames() - 1;
 }
 
 qint64
 Time::frames() const
 {
-    return p->frames();
+    return frame(d.ticks);
 }
 
 qint64
 Time::align(qint64 ticks) const
 {
-    return this->ticks(p->frame(ticks));
+    return this->ticks(frame(ticks));
 }
 
 qreal
 Time::seconds() const
 {
-    return static_cast<qreal>(p->d.ticks) / p->d.timeScale;
+    return static_cast<qreal>(d.ticks) / d.timeScale;
 }
 
 QString
 Time::toString(qint64 ticks) const
 {
-    return p->toString(static_cast<qreal>(ticks) / p->d.timeScale);
+    return av::toString(static_cast<qreal>(ticks) / d.timeScale);
 }
 
 QString
 Time::toString() const
 {
-    return p->toString(seconds());
-}
-
-bool
-Time::isValid() const
-{
-    return p->d.timeScale > 0;
+    return av::toString(seconds());
 }
 
 void
 Time::reset()
 {
-    p.reset(new TimePrivate());
-}
-
-void
-Time::setTicks(qint64 ticks)
-{
-    if (p->d.ticks != ticks) {
-        p.detach();
-        p->d.ticks = ticks;
-    }
-}
-
-void
-Time::setTimeScale(qint32 timeScale)
-{
-    if (p->d.timeScale != timeScale) {
-        p.detach();
-        p->d.timeScale = timeScale;
-    }
-}
-
-void
-Time::setFps(const Fps& fps)
-{
-    if (p->d.fps != fps) {
-        p.detach();
-        p->d.fps = fps;
-    }
-}
-
-Time&
-Time::operator=(const Time& other)
-{
-    if (this != &other) {
-        p = other.p;
-    }
-    return *this;
-}
-
-bool
-Time::operator==(const Time& other) const
-{
-    return p->d.ticks == other.p->d.ticks && p->d.timeScale == other.p->d.timeScale && p->d.fps == other.p->d.fps;
-}
-
-bool
-Time::operator!=(const Time& other) const
-{
-    return !(*this == other);
+    d = Data();
 }
 
 bool
 Time::operator<(const Time& other) const
 {
-    return seconds() < other.seconds();
+    return compare(*this, other) < 0;
 }
 
 bool
 Time::operator>(const Time& other) const
 {
-    return seconds() > other.seconds();
+    return compare(*this, other) > 0;
 }
 
 bool
 Time::operator<=(const Time& other) const
 {
-    return seconds() <= other.seconds();
+    return compare(*this, other) <= 0;
 }
 
 bool
 Time::operator>=(const Time& other) const
 {
-    return seconds() >= other.seconds();
+    return compare(*this, other) >= 0;
 }
 
 Time
 Time::operator+(const Time& other) const
 {
-    Q_ASSERT("timescale does not match" && p->d.timeScale == other.p->d.timeScale);
-    return Time(p->d.ticks + other.p->d.ticks, p->d.timeScale, p->d.fps);
+    Q_ASSERT("timescale does not match" && d.timeScale == other.d.timeScale);
+    return Time(d.ticks + other.d.ticks, d.timeScale, d.fps);
 }
 
 Time
 Time::operator-(const Time& other) const
 {
-    Q_ASSERT("timescale does not match" && p->d.timeScale == other.p->d.timeScale);
-    return Time(p->d.ticks - other.p->d.ticks, p->d.timeScale, p->d.fps);
+    Q_ASSERT("timescale does not match" && d.timeScale == other.d.timeScale);
+    return Time(d.ticks - other.d.ticks, d.timeScale, d.fps);
 }
 
 Time::operator double() const { return seconds(); }
@@ -277,21 +175,15 @@ Time::zero(const Fps& fps)
 Time
 Time::fromFrames(qint64 frame, const Fps& fps)
 {
-    Time time;
-    time.p->d.fps = fps;
-    time.p->d.timeScale = 24000;
-    time.p->d.ticks = time.p->ticks(frame);
+    Time time(0, 24000, fps);
+    time.d.ticks = time.ticks(frame);
     return time;
 }
 
 Time
 Time::fromSeconds(qreal seconds, const Fps& fps)
 {
-    Time time;
-    time.p->d.fps = fps;
-    time.p->d.timeScale = 24000;
-    time.p->d.ticks = time.p->d.timeScale * seconds;
-    return time;
+    return Time(static_cast<qint64>(24000 * seconds), 24000, fps);
 }
 
 Time
@@ -303,17 +195,6 @@ Time::convert(const Time& time, const Fps& to)
 Time
 Time::convert(const Time& time, qint32 timeScale)
 {
-    qint64 numerator = time.ticks() * timeScale;
-    qint64 remainder = numerator % time.timeScale();
-    qint64 ticks = numerator / time.timeScale();
-    if (remainder >= (time.timeScale() / 2)) {
-        if (time.ticks() > 0) {
-            ticks += 1;
-        }
-        else if (time.ticks() < 0) {
-            ticks -= 1;
-        }
-    }
-    return Time(ticks, timeScale, time.fps());
+    return Time(rescale(time.ticks(), timeScale, time.timeScale()), timeScale, time.fps());
 }
 }  // namespace flipman::sdk::av
@@ -5,8 +5,10 @@
 #include <flipmansdk/av/timeline.h>
 #include <flipmansdk/av/timer.h>
 #include <flipmansdk/av/track.h>
+#include <QMutex>
 #include <QPointer>
 #include <QThreadPool>
+#include <QtConcurrent>
 #include <QtGlobal>
 
 namespace flipman::sdk::av {
@@ -14,6 +16,11 @@ class TimelinePrivate {
 public:
     void init();
     void reset();
+    void run(quint64 generation);
+    TimeRange playRange() const;
+    Time frameTime(const TimeRange& range, qint64 offset) const;
+    QList<render::ImageLayer> read(const Time& time);
+    void publish(const Time& time, const QList<render::ImageLayer>& imageLayers);
     struct Data {
         Time time = Time();
         TimeRange timeRange = TimeRange();
@@ -26,9 +33,14 @@ public:
         std::atomic<bool> loop = false;
         std::atomic<bool> everyFrame = false;
         std::atomic<bool> playing = false;
+        std::atomic<quint64> generation = 0;
+        std::atomic<bool> seeking = false;
+        Timeline::Stats stats;
+        mutable QMutex mutex;
         core::Error error;
     };
     Data d;
+    QThreadPool playback;
     QPointer<Timeline> object;
 };
 
@@ -36,6 +48,175 @@ void
 TimelinePrivate::init()
 {
     d.threadPool.setMaxThreadCount(1);
+    playback.setMaxThreadCount(1);
+}
+
+void
+TimelinePrivate::reset()
+{
+    d.playing = false;
+    d.generation++;
+    playback.waitForDone();
+}
+
+void
+TimelinePrivate::run(quint64 generation)
+{
+    // frames are scheduled against the start of playback, frame n is due n
+    // frame durations after the first. Late frames are dropped unless every
+    // frame mode is set, then each frame is read and presented in order and
+    // a late frame restarts the schedule.
+    const TimeRange range = playRange();
+    const Fps fps = d.fps.isValid() ? d.fps : range.start().fps();
+    const quint64 frameNs = static_cast<quint64>((1e9 * fps.denominator()) / fps.numerator());
+
+    qint64 offset = 0;
+    qint64 index = 0;
+    qint64 base = 0;
+    qint64 presented = 0;
+    Timer timer;
+    Timer rate;
+    rate.start();
+
+    // a stopped run exits even if playback has been started again, the new
+    // run has its own generation.
+    while (d.playing && d.generation == generation) {
+        if (d.seeking.exchange(false) || index == 0) {
+            QMutexLocker locker(&d.mutex);
+            offset = d.time.frames() - range.start().frames();
+            index = 0;
+            base = 0;
+            timer.start();
+            timer.start(fps);
+        }
+        else if (!d.everyFrame) {
+            const qint64 due = base + static_cast<qint64>(timer.elapsed() / frameNs);
+            if (due > index) {
+                QMutexLocker locker(&d.mutex);
+                d.stats.dropped += due - index;
+                for (; index < due; ++index)
+                    timer.next(fps);
+            }
+        }
+
+        const Time time = frameTime(range, offset + index);
+        if (!time.isValid())
+            break;
+
+        const QList<render::ImageLayer> imageLayers = read(time);
+        if (index > 0) {
+            const bool onTime = timer.elapsed() < quint64(index - base) * frameNs;
+            if (onTime)
+                timer.wait();
+
+            if (onTime || !d.everyFrame) {
+                timer.next(fps);
+            }
+            else {
+                timer.start();
+                timer.start(fps);
+                base = index;
+            }
+
+            QMutexLocker locker(&d.mutex);
+            if (onTime)
+                d.stats.onTime++;
+            else
+                d.stats.late++;
+        }
+        else {
+            QMutexLocker locker(&d.mutex);
+            d.stats.onTime++;
+        }
+        publish(time, imageLayers);
+        index++;
+
+        presented++;
+        if (rate.elapsed() >= 1000000000) {
+            Q_EMIT object->actualFpsChanged(presented * 1e9 / qMax<quint64>(1, rate.elapsed()));
+            presented = 0;
+            rate.restart();
+        }
+    }
+
+    if (d.generation == generation && d.playing.exchange(false))
+        Q_EMIT object->playChanged(false);
+}
+
+TimeRange
+TimelinePrivate::playRange() const
+{
+    QMutexLocker locker(&d.mutex);
+    return d.ioRange.isValid() ? d.ioRange : d.timeRange;
+}
+
+Time
+TimelinePrivate::frameTime(const TimeRange& range, qint64 offset) const
+{
+    const Time start = range.start();
+    const qint64 duration = range.duration().frames();
+    if (duration <= 0)
+        return Time();
+
+    if (offset < 0 || offset >= duration) {
+        if (!d.loop)
+            return Time();
+        offset = ((offset % duration) + duration) % duration;
+    }
+    return Time(start, start.ticks(start.frames() + offset));
+}
+
+QList<render::ImageLayer>
+TimelinePrivate::read(const Time& time)
+{
+    struct Job {
+        Clip* clip = nullptr;
+        qint64 offset = 0;
+        render::ImageLayer imageLayer;
+    };
+
+    QList<Job> jobs;
+    {
+        QMutexLocker locker(&d.mutex);
+        for (Track* track : d.tracks) {
+            for (Clip* clip : track->clips(time))
+                jobs.append({ clip, time.frames() - track->clipRange(clip).start().frames() });
+        }
+    }
+
+    // clips decode in parallel on the timeline thread pool, the playback
+    // thread takes part so a single thread still makes progress.
+    QtConcurrent::blockingMap(&d.threadPool, jobs, [](Job& job) {
+        Media media = job.clip->media();
+        const Time start = media.timeRange().start();
+        const Time mediaTime(start, start.ticks(start.frames() + job.offset));
+        if (media.time().frames() != mediaTime.frames())
+            media.seek(TimeRange(mediaTime, media.timeRange().end() - mediaTime));
+
+        media.read();
+        job.imageLayer.setImage(media.image());
+        job.imageLayer.setImageEffect(job.clip->imageEffect());
+        job.imageLayer.setTransform(job.clip->transform());
+    });
+
+    QList<render::ImageLayer> imageLayers;
+    for (const Job& job : jobs)
+        imageLayers.append(job.imageLayer);
+    return imageLayers;
+}
+
+void
+TimelinePrivate::publish(const Time& time, const QList<render::ImageLayer>& imageLayers)
+{
+    {
+        QMutexLocker locker(&d.mutex);
+        d.time = time;
+        d.stats.presented++;
+    }
+    for (const render::ImageLayer& imageLayer : imageLayers)
+        Q_EMIT object->imageLayerChanged(imageLayer);
+
+    Q_EMIT object->timeChanged(time);
 }
 
 Timeline::Timeline(QObject* parent)
@@ -46,19 +227,27 @@ Timeline::Timeline(QObject* parent)
     p->object = this;
 }
 
-Timeline::~Timeline() {}
+Timeline::~Timeline() { p->reset(); }
 
 void
 Timeline::reset()
 {
+    p->reset();
     p.reset(new TimelinePrivate());
     p->init();
+    p->object = this;
 }
 
 bool
 Timeline::isPlaying() const
 {
-    return true;
+    return p->d.playing;
+}
+
+bool
+Timeline::everyFrame() const
+{
+    return p->d.everyFrame;
 }
 
 TimeRange
@@ -76,6 +265,7 @@ Timeline::ioRange() const
 Time
 Timeline::time() const
 {
+    QMutexLocker locker(&p->d.mutex);
     return p->d.time;
 }
 
@@ -118,19 +308,53 @@ Timeline::loop() const
 bool
 Timeline::hasTrack(Track* track) const
 {
+    QMutexLocker locker(&p->d.mutex);
     return p->d.tracks.contains(track);
 }
 
 QList<Track*>
 Timeline::tracks() const
 {
+    QMutexLocker locker(&p->d.mutex);
     return p->d.tracks;
 }
 
+QList<Clip*>
+Timeline::clips(const Time& time) const
+{
+    QList<Clip*> clips;
+    for (Track* track : tracks())
+        clips.append(track->clips(time));
+    return clips;
+}
+
+QList<Clip*>
+Timeline::clips(const TimeRange& range) const
+{
+    QList<Clip*> clips;
+    for (Track* track : tracks())
+        clips.append(track->clips(range));
+    return clips;
+}
+
 int
 Timeline::threadCount() const
 {
-    p->d.threadPool.maxThreadCount();
+    return p->d.threadPool.maxThreadCount();
+}
+
+Timeline::Stats
+Timeline::stats() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.stats;
+}
+
+void
+Timeline::resetStats()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.stats = Stats();
 }
 
 core::Error
@@ -142,6 +366,7 @@ Timeline::error() const
 void
 Timeline::insertTrack(Track* track)
 {
+    QMutexLocker locker(&p->d.mutex);
     p->d.tracks.append(track);
 }
 
@@ -149,6 +374,7 @@ void
 Timeline::removeTrack(Track* track)
 {
     Q_ASSERT("does not contain track" && hasTrack(track));
+    QMutexLocker locker(&p->d.mutex);
     p->d.tracks.remove(p->d.tracks.indexOf(track));
 }
 
@@ -164,8 +390,10 @@ Timeline::setLoop(bool loop)
 void
 Timeline::setTimeRange(const TimeRange& timeRange)
 {
+    QMutexLocker locker(&p->d.mutex);
     if (p->d.timeRange != timeRange) {
         p->d.timeRange = timeRange;
+        locker.unlock();
         Q_EMIT timerangeChanged(timeRange);
     }
 }
@@ -173,8 +401,10 @@ Timeline::setTimeRange(const TimeRange& timeRange)
 void
 Timeline::setIoRange(const TimeRange& ioRange)
 {
+    QMutexLocker locker(&p->d.mutex);
     if (p->d.ioRange != ioRange) {
         p->d.ioRange = ioRange;
+        locker.unlock();
         Q_EMIT ioRangeChanged(ioRange);
     }
 }
@@ -216,15 +446,57 @@ Timeline::setThreadCount(int threadCount)
 
 void
 Timeline::seek(const Time& time)
-{}
+{
+    const TimeRange range = p->playRange();
+    const Time start = range.start();
+    const Time target = p->frameTime(range, time.frames() - start.frames());
+    if (!target.isValid())
+        return;
+
+    {
+        QMutexLocker locker(&p->d.mutex);
+        p->d.time = target;
+    }
+
+    // a playing timeline picks the new time up on its next frame, a stopped
+    // one reads and presents the frame on the calling thread.
+    if (p->d.playing) {
+        p->d.seeking = true;
+        return;
+    }
+    p->publish(target, p->read(target));
+}
 
 void
 Timeline::play()
-{}
+{
+    if (p->d.playing.exchange(true))
+        return;
+
+    // wait for a previous run to finish, stop() moved it to a new generation
+    // so it exits even though playing is set again.
+    p->playback.waitForDone();
+    {
+        QMutexLocker locker(&p->d.mutex);
+        const TimeRange range = p->d.ioRange.isValid() ? p->d.ioRange : p->d.timeRange;
+        if (!range.isValid()) {
+            p->d.error = core::Error("timeline", "could not play, time range is not valid");
+            p->d.playing = false;
+            return;
+        }
+        if (!p->d.time.isValid() || p->d.time < range.start() || p->d.time >= range.end())
+            p->d.time = range.start();
+    }
+    Q_EMIT playChanged(true);
+    const quint64 generation = p->d.generation;
+    p->playback.start([this, generation]() { p->run(generation); });
+}
 
 void
 Timeline::stop()
 {
-    p->d.playing = false;
+    p->d.generation++;
+    if (p->d.playing.exchange(false))
+        Q_EMIT playChanged(false);
 }
 }  // namespace flipman::sdk::av
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/av/fps.h>
+#include <flipmansdk/av/timer.h>
+#include <QThread>
+#include <QtGlobal>
+
+#if defined(Q_OS_MACOS)
+#    include <mach/mach.h>
+#    include <mach/mach_time.h>
+#else
+#    include <cerrno>
+#    include <ctime>
+#endif
+
+namespace flipman::sdk::av {
+class TimerPrivate {
+public:
+    TimerPrivate();
+    quint64 now() const;
+    quint64 deadline() const;
+    void sleepUntil(quint64 time) const;
+    void rebase(const Fps& fps, quint64 base);
+    struct Data {
+        quint64 start = 0;
+        quint64 stop = 0;
+        quint64 lap = 0;
+        quint64 base = 0;
+        quint64 frames = 0;
+        quint64 quotient = 0;
+        quint64 remainder = 0;
+        quint64 numerator = 1;
+        Fps fps;
+        QList<quint64> laps;
+#if defined(Q_OS_MACOS)
+        mach_timebase_info_data_t timeBase;
+#endif
+    };
+    Data d;
+    // sleeps end this far ahead of the deadline, the rest is spun out so
+    // scheduler wake-up latency does not show up as frame jitter.
+    static constexpr quint64 spin = 500000;
+};
+
+TimerPrivate::TimerPrivate()
+{
+#if defined(Q_OS_MACOS)
+    mach_timebase_info(&d.timeBase);
+#endif
+}
+
+quint64
+TimerPrivate::now() const
+{
+#if defined(Q_OS_MACOS)
+    return mach_absolute_time() * d.timeBase.numer / d.timeBase.denom;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<quint64>(ts.tv_sec) * 1000000000ull + static_cast<quint64>(ts.tv_nsec);
+#endif
+}
+
+quint64
+TimerPrivate::deadline() const
+{
+    // frame n is due at base + n * 1e9 * den / num nanoseconds, kept as
+    // quotient and remainder so 23.976 and 29.97 never accumulate rounding.
+    return d.base + d.frames * d.quotient + (d.frames * d.remainder) / d.numerator;
+}
+
+void
+TimerPrivate::sleepUntil(quint64 time) const
+{
+#if defined(Q_OS_MACOS)
+    mach_wait_until(time * d.timeBase.denom / d.timeBase.numer);
+#else
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(time / 1000000000ull);
+    ts.tv_nsec = static_cast<long>(time % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#endif
+}
+
+void
+TimerPrivate::rebase(const Fps& fps, quint64 base)
+{
+    Q_ASSERT("fps is zero" && fps.numerator() > 0 && fps.denominator() > 0);
+    const quint64 numerator = static_cast<quint64>(fps.numerator());
+    const quint64 duration = 1000000000ull * static_cast<quint64>(fps.denominator());
+    d.fps = fps;
+    d.base = base;
+    d.frames = 0;
+    d.numerator = numerator;
+    d.quotient = duration / numerator;
+    d.remainder = duration % numerator;
+}
+
+Timer::Timer()
+    : p(new TimerPrivate())
+{}
+
+Timer::~Timer() {}
+
+bool
+Timer::isValid() const
+{
+    return p->d.start > 0;
+}
+
+void
+Timer::start()
+{
+    p->d.start = p->now();
+    p->d.lap = p->d.start;
+    p->d.stop = 0;
+}
+
+void
+Timer::start(const Fps& fps)
+{
+    p->rebase(fps, p->now());
+    p->d.frames = 1;
+    p->d.stop = 0;
+}
+
+void
+Timer::stop()
+{
+    p->d.stop = p->now();
+}
+
+void
+Timer::restart()
+{
+    p->d.laps.clear();
+    start();
+}
+
+void
+Timer::lap()
+{
+    const quint64 time = p->d.stop > 0 ? p->d.stop : p->now();
+    p->d.laps.append(time - p->d.lap);
+    p->d.lap = time;
+}
+
+bool
+Timer::next(const Fps& fps)
+{
+    if (p->d.fps != fps)
+        p->rebase(fps, p->deadline());
+
+    p->d.frames++;
+    return p->deadline() > p->now();
+}
+
+void
+Timer::wait()
+{
+    Q_ASSERT("timer not started with fps" && p->d.base > 0);
+
+    const quint64 deadline = p->deadline();
+    quint64 time = p->now();
+    if (time + TimerPrivate::spin < deadline) {
+        p->sleepUntil(deadline - TimerPrivate::spin);
+        time = p->now();
+    }
+    while (time < deadline) {
+        QThread::yieldCurrentThread();
+        time = p->now();
+    }
+    p->d.laps.append(time - deadline);
+}
+
+void
+Timer::sleep(quint64 msecs)
+{
+    p->sleepUntil(p->now() + msecs * 1000000ull);
+}
+
+quint64
+Timer::elapsed() const
+{
+    const quint64 end = p->d.stop > 0 ? p->d.stop : p->now();
+    return end - p->d.start;
+}
+
+QList<quint64>
+Timer::laps() const
+{
+    return p->d.laps;
+}
+
+void
+Timer::reset()
+{
+    p.reset(new TimerPrivate());
+}
+
+qreal
+Timer::convert(quint64 nano, Unit unit)
+{
+    switch (unit) {
+    case Unit::Seconds: return static_cast<qreal>(nano) / 1e9;
+    case Unit::Minutes: return static_cast<qreal>(nano) / (60 * 1e9);
+    case Unit::Hours: return static_cast<qreal>(nano) / (3600 * 1e9);
+    default: return static_cast<qreal>(nano);
+    }
+}
+}  // namespace flipman::sdk::av
@@ -6,55 +6,17 @@
 #include <flipmansdk/av/timerange.h>
 
 namespace flipman::sdk::av {
-class TimeRangePrivate : public QSharedData {
-public:
-    struct Data {
-        Time start;
-        Time duration;
-    };
-    Data d;
-};
-
-TimeRange::TimeRange()
-    : p(new TimeRangePrivate())
-{}
 
 TimeRange::TimeRange(Time start, Time duration)
-    : p(new TimeRangePrivate())
+    : d { start, duration }
 {
     Q_ASSERT(start.timeScale() == duration.timeScale());
-    p->d.start = start;
-    p->d.duration = duration;
-}
-
-TimeRange::TimeRange(const TimeRange& other)
-    : p(other.p)
-{}
-
-TimeRange::~TimeRange() {}
-
-bool
-TimeRange::isValid() const
-{
-    return p->d.start.isValid() && p->d.duration.isValid() && p->d.duration.ticks() > 0;
-}
-
-Time
-TimeRange::start() const
-{
-    return p->d.start;
-}
-
-Time
-TimeRange::duration() const
-{
-    return p->d.duration;
 }
 
 Time
 TimeRange::end() const
 {
-    return p->d.start + p->d.duration;
+    return d.start + d.duration;
 }
 
 Time
@@ -84,54 +46,19 @@ TimeRange::bound(const Time& time, bool loop)
 bool
 TimeRange::intersects(const TimeRange& other) const
 {
-    return (p->d.start < other.end()) && (other.start() < end());
+    return (d.start < other.end()) && (other.start() < end());
 }
 
 QString
 TimeRange::toString() const
 {
-    return QString("%1 / %2").arg(p->d.start.toString()).arg(p->d.duration.toString());
+    return QString("%1 / %2").arg(d.start.toString()).arg(d.duration.toString());
 }
 
 void
 TimeRange::reset()
 {
-    p.reset(new TimeRangePrivate());
-}
-
-void
-TimeRange::setStart(Time start)
-{
-    p.detach();
-    p->d.start = start;
-}
-
-void
-TimeRange::setDuration(Time duration)
-{
-    p.detach();
-    p->d.duration = duration;
-}
-
-TimeRange&
-TimeRange::operator=(const TimeRange& other)
-{
-    if (this != &other) {
-        p = other.p;
-    }
-    return *this;
-}
-
-bool
-TimeRange::operator==(const TimeRange& other) const
-{
-    return p->d.start == other.p->d.start && p->d.duration == other.p->d.duration;
-}
-
-bool
-TimeRange::operator!=(const TimeRange& other) const
-{
-    return !(*this == other);
+    d = Data();
 }
 
 TimeRange
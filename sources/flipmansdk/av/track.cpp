@@ -3,17 +3,34 @@
 
 #include <flipmansdk/av/track.h>
 #include <QColor>
+#include <QMutex>
+
+#include <algorithm>
 
 namespace flipman::sdk::av {
 class TrackPrivate {
 public:
     TrackPrivate();
     ~TrackPrivate();
+    struct Interval {
+        Time start;
+        Time end;
+        Clip* clip = nullptr;
+    };
+    void insert(Clip* clip, const TimeRange& range);
+    void remove(Clip* clip);
+    bool take(Clip* clip);
+    void rebuild();
+    Time build(qsizetype lo, qsizetype hi);
+    void find(qsizetype lo, qsizetype hi, const Time& start, const Time& end, bool point, QList<Clip*>& clips) const;
     struct Data {
         QString name = "Track";
         QColor color;
         TimeRange timeRange;
         QHash<Clip*, TimeRange> clips;
+        QList<Interval> intervals;
+        QList<Time> maxEnd;
+        mutable QMutex mutex;
     };
     Data d;
 };
@@ -22,6 +39,88 @@ TrackPrivate::TrackPrivate() {}
 
 TrackPrivate::~TrackPrivate() {}
 
+void
+TrackPrivate::insert(Clip* clip, const TimeRange& range)
+{
+    // intervals are kept sorted by start and read as an implicit balanced
+    // tree, the middle of each span is the node and maxEnd holds the largest
+    // end below it. Edits are O(n), lookups are O(log n + k). Times are
+    // compared exactly across timescales, clips that meet at a boundary
+    // never overlap.
+    take(clip);
+    const Interval interval { range.start(), range.end(), clip };
+    auto it = std::upper_bound(d.intervals.begin(), d.intervals.end(), interval,
+                               [](const Interval& a, const Interval& b) { return a.start < b.start; });
+    d.intervals.insert(it, interval);
+    d.clips.insert(clip, range);
+    rebuild();
+}
+
+void
+TrackPrivate::remove(Clip* clip)
+{
+    if (take(clip))
+        rebuild();
+}
+
+bool
+TrackPrivate::take(Clip* clip)
+{
+    if (!d.clips.remove(clip))
+        return false;
+
+    d.intervals.removeIf([clip](const Interval& interval) { return interval.clip == clip; });
+    return true;
+}
+
+void
+TrackPrivate::rebuild()
+{
+    d.maxEnd.resize(d.intervals.size());
+    build(0, d.intervals.size());
+}
+
+Time
+TrackPrivate::build(qsizetype lo, qsizetype hi)
+{
+    // an empty span has no end, an invalid time.
+    if (lo >= hi)
+        return Time();
+
+    const qsizetype mid = lo + (hi - lo) / 2;
+    Time end = d.intervals[mid].end;
+    for (const Time& child : { build(lo, mid), build(mid + 1, hi) }) {
+        if (child.isValid() && child > end)
+            end = child;
+    }
+    d.maxEnd[mid] = end;
+    return end;
+}
+
+void
+TrackPrivate::find(qsizetype lo, qsizetype hi, const Time& start, const Time& end, bool point,
+                   QList<Clip*>& clips) const
+{
+    // finds intervals overlapping [start, end), or containing start for a
+    // point, subtrees that end before start are skipped and nothing right
+    // of a node starting after the query can overlap. Clips are appended in
+    // start order.
+    while (lo < hi) {
+        const qsizetype mid = lo + (hi - lo) / 2;
+        if (d.maxEnd[mid] <= start)
+            return;
+
+        find(lo, mid, start, end, point, clips);
+        const Interval& interval = d.intervals[mid];
+        if (point ? interval.start > end : interval.start >= end)
+            return;
+
+        if (interval.end > start)
+            clips.append(interval.clip);
+        lo = mid + 1;
+    }
+}
+
 Track::Track(QObject* parent)
     : QObject(parent)
     , p(new TrackPrivate())
@@ -45,24 +144,52 @@ TimeRange
 Track::clipRange(Clip* clip) const
 {
     Q_ASSERT("clip not found on track" && containsClip(clip));
+    QMutexLocker locker(&p->d.mutex);
     return p->d.clips.value(clip);
 }
 
 QList<Clip*>
 Track::clips() const
 {
-    return p->d.clips.keys();
+    QMutexLocker locker(&p->d.mutex);
+    QList<Clip*> clips;
+    clips.reserve(p->d.intervals.size());
+    for (const TrackPrivate::Interval& interval : p->d.intervals)
+        clips.append(interval.clip);
+    return clips;
+}
+
+QList<Clip*>
+Track::clips(const Time& time) const
+{
+    // a clip is active at time t when it starts at or before t and ends
+    // after it.
+    QList<Clip*> clips;
+    QMutexLocker locker(&p->d.mutex);
+    p->find(0, p->d.intervals.size(), time, time, true, clips);
+    return clips;
+}
+
+QList<Clip*>
+Track::clips(const TimeRange& range) const
+{
+    QList<Clip*> clips;
+    QMutexLocker locker(&p->d.mutex);
+    p->find(0, p->d.intervals.size(), range.start(), range.end(), false, clips);
+    return clips;
 }
 
 bool
 Track::containsClip(Clip* clip) const
 {
+    QMutexLocker locker(&p->d.mutex);
     return p->d.clips.contains(clip);
 }
 
 core::Error
 Track::error() const
 {
+    QMutexLocker locker(&p->d.mutex);
     for (Clip* clip : p->d.clips.keys()) {
         if (clip->error().hasError()) {
             return clip->error();
@@ -98,24 +225,16 @@ Track::setColor(const QColor& color)
 void
 Track::insertClip(Clip* clip, const TimeRange& range)
 {
-    /*
-    for (const auto& existingClip : p->d.clips.keys()) {
-        AVTimeRange existingRange = p->d.clips.value(existingClip);
-        if (range.intersects(existingRange)) {
-            qint64 ticks = existingRange.end().ticks() + 1;
-            AVTimeRange adjusted(AVTime(range.start, ticks), range.duration());
-            p->d.clips[clip] = adjusted;
-            return;
-        }
-    }
-    p->d.clips[clip] = range;
-    */
+    Q_ASSERT("clip range is not valid" && range.isValid());
+    QMutexLocker locker(&p->d.mutex);
+    p->insert(clip, range);
 }
 
 void
 Track::removeClip(Clip* clip)
 {
     Q_ASSERT("clip not found on track" && containsClip(clip));
-    p->d.clips.remove(clip);
+    QMutexLocker locker(&p->d.mutex);
+    p->remove(clip);
 }
 }  // namespace flipman::sdk::av
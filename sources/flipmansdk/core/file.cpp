@@ -4,19 +4,13 @@
 
 #include <flipmansdk/core/file.h>
 #include <flipmansdk/core/filerange.h>
+#include <flipmansdk/core/filescanner.h>
 #include <QDir>
 #include <QRegularExpression>
 
 namespace flipman::sdk::core {
 class FilePrivate : public QSharedData {
 public:
-    struct FilePattern {
-        QString filename;
-        qint64 frame;
-        qsizetype pos;
-        qsizetype length;
-    };
-    static FilePattern pattern(const QString& filename);
     struct Data {
         QFileInfo fileInfo;
         FileRange fileRange;
@@ -25,30 +19,6 @@ public:
     Data d;
 };
 
-FilePrivate::FilePattern
-FilePrivate::pattern(const QString& filename)
-{
-    QRegularExpression regex("(\\d+)");
-    QRegularExpressionMatchIterator matchIterator = regex.globalMatch(filename);
-    QString cap;
-    qsizetype pos = -1;
-    qsizetype length = 0;
-    while (matchIterator.hasNext()) {
-        QRegularExpressionMatch match = matchIterator.next();
-        cap = match.captured(1);
-        pos = match.capturedStart(1);
-        length = cap.length();
-    }
-    if (pos != -1 && !cap.isEmpty()) {
-        qint64 frame = cap.toLongLong();
-        QString fill(length, '#');
-        QString modifiedFilename = filename;
-        modifiedFilename.replace(pos, length, fill);
-        return FilePattern { modifiedFilename, frame, pos, length };
-    }
-    return FilePattern { filename, 0, -1, 0 };
-}
-
 File::File()
     : p(new FilePrivate())
 {}
@@ -89,11 +59,11 @@ File::~File() {}
 QString
 File::displayName() const
 {
-    if (p->d.fileRange.size()) {
-        FilePrivate::FilePattern pattern = FilePrivate::pattern(fileName());
-        QString filename = pattern.filename;
+    if (p->d.fileRange.size() && p->d.fileRange.padding()) {
+        QString filename = QFileInfo(p->d.fileRange.pattern()).fileName();
+        const qsizetype pos = filename.lastIndexOf('#') + 1 - p->d.fileRange.padding();
         QString range = QString("[%1-%2]").arg(p->d.fileRange.start()).arg(p->d.fileRange.end());
-        return filename.replace(pattern.pos, pattern.length, range);
+        return filename.replace(pos, p->d.fileRange.padding(), range);
     }
     else {
         return fileName();
@@ -291,37 +261,9 @@ File::operator!=(const File& other) const
 QList<File>
 File::listDir(const QString& filepath, const QStringList& namefilters, bool ranges)
 {
-    QList<File> files;
-    qint64 frame = 0;
-    QString filename;
-    FileRange filerange;
-    QFileInfoList entries = QDir(filepath).entryInfoList(namefilters, QDir::Files,
-                                                         QDir::Type);  // alphabetic to match frames
-    for (const QFileInfo& entry : entries) {
-        if (ranges) {
-            FilePrivate::FilePattern pattern = FilePrivate::pattern(entry.fileName());
-            Q_ASSERT("range filename is invalid" && !pattern.filename.isEmpty());
-            if (pattern.filename != filename || pattern.frame != frame) {
-                if (files.size() && (filerange.size() > 1 || files.back().fileRange().size())) {
-                    Q_ASSERT("file range already set" && !files.back().fileRange().size());
-                    files.back().setFileRange(FileRange(filerange));
-                }
-                files.append(File(entry));
-                frame = pattern.frame;
-                filename = pattern.filename;
-                filerange = FileRange();
-            }
-            filerange.insertFrame(frame, entry);
-            if (entry == entries.back() && (filerange.size() > 1 || files.back().fileRange().size())) {
-                Q_ASSERT("file range already set" && !files.back().fileRange().size());
-                files.back().setFileRange(filerange);
-            }
-            frame++;
-        }
-        else {
-            files.append(entry);
-        }
-    }
-    return files;
+    FileScanner scanner;
+    scanner.setNameFilters(namefilters);
+    scanner.setRanges(ranges);
+    return scanner.scan(filepath);
 }
 }  // namespace flipman::sdk::core
@@ -3,22 +3,158 @@
 // https://github.com/mikaelsundell/flipman
 
 #include <flipmansdk/core/filerange.h>
-
-#include <QMap>
+#include <QBitArray>
+#include <QFileInfo>
 
 namespace flipman::sdk::core {
 class FileRangePrivate : public QSharedData {
 public:
+    bool isEmpty() const;
+    qint64 slots() const;
+    qint64 slot(qint64 frame) const;
+    bool isHole(qint64 slot) const;
+    void setHoles(qint64 from, qint64 to);
+    void trim();
+    bool setPattern(const QString& filePath, qint64 frame);
     struct Data {
-        QMap<qint64, File> ranges;
+        QString prefix;
+        QString suffix;
+        int padding = 0;
+        qint64 first = 0;
+        qint64 last = -1;
+        qint64 step = 1;
+        qint64 missing = 0;
+        QBitArray holes;
     };
     Data d;
 };
 
+bool
+FileRangePrivate::isEmpty() const
+{
+    return d.last < d.first;
+}
+
+qint64
+FileRangePrivate::slots() const
+{
+    return isEmpty() ? 0 : (d.last - d.first) / d.step + 1;
+}
+
+qint64
+FileRangePrivate::slot(qint64 frame) const
+{
+    if (isEmpty() || frame < d.first || frame > d.last || (frame - d.first) % d.step)
+        return -1;
+    return (frame - d.first) / d.step;
+}
+
+bool
+FileRangePrivate::isHole(qint64 slot) const
+{
+    // the bitmap is only allocated once a frame is missing, then it spans
+    // every slot between first and last.
+    return !d.holes.isEmpty() && d.holes.testBit(slot);
+}
+
+void
+FileRangePrivate::setHoles(qint64 from, qint64 to)
+{
+    if (from >= to)
+        return;
+    if (d.holes.isEmpty())
+        d.holes.resize(slots());
+    d.holes.fill(true, from, to);
+    d.missing += to - from;
+}
+
+void
+FileRangePrivate::trim()
+{
+    // missing frames never sit at either end, start() and end() are frames
+    // that exist.
+    const qint64 count = slots();
+    qint64 front = 0;
+    qint64 back = count;
+    while (front < back && isHole(front))
+        front++;
+    while (back > front && isHole(back - 1))
+        back--;
+
+    if (front == 0 && back == count)
+        return;
+
+    if (front == back) {
+        d.first = 0;
+        d.last = -1;
+        d.missing = 0;
+        d.holes.clear();
+        return;
+    }
+
+    QBitArray holes(back - front);
+    qint64 missing = 0;
+    for (qint64 i = front; i < back; ++i) {
+        if (isHole(i)) {
+            holes.setBit(i - front);
+            missing++;
+        }
+    }
+    d.last = d.first + (back - 1) * d.step;
+    d.first = d.first + front * d.step;
+    d.missing = missing;
+    d.holes = missing ? holes : QBitArray();
+}
+
+bool
+FileRangePrivate::setPattern(const QString& filePath, qint64 frame)
+{
+    // the frame number is the last run of digits in the file name that
+    // matches the frame, its length is the padding.
+    const qsizetype name = filePath.lastIndexOf('/') + 1;
+    qsizetype end = filePath.size();
+    while (end > name) {
+        while (end > name && !filePath[end - 1].isDigit())
+            end--;
+        qsizetype begin = end;
+        while (begin > name && filePath[begin - 1].isDigit())
+            begin--;
+        if (begin == end)
+            break;
+
+        bool ok = false;
+        if (QStringView(filePath).mid(begin, end - begin).toLongLong(&ok) == frame && ok) {
+            d.prefix = filePath.left(begin);
+            d.suffix = filePath.mid(end);
+            d.padding = int(end - begin);
+            return true;
+        }
+        end = begin;
+    }
+    return false;
+}
+
 FileRange::FileRange()
     : p(new FileRangePrivate())
 {}
 
+FileRange::FileRange(const QString& pattern, qint64 first, qint64 last, qint64 step)
+    : p(new FileRangePrivate())
+{
+    Q_ASSERT("step must be positive" && step > 0);
+    const qsizetype end = pattern.lastIndexOf('#') + 1;
+    qsizetype begin = end;
+    while (begin > 0 && pattern[begin - 1] == '#')
+        begin--;
+
+    p->d.prefix = pattern.left(begin);
+    p->d.suffix = pattern.mid(end);
+    p->d.padding = int(end - begin);
+    p->d.first = first;
+    p->d.last = first + ((last - first) / step) * step;
+    p->d.step = step;
+}
+
 FileRange::FileRange(const FileRange& other)
     : p(other.p)
 {}
@@ -28,32 +164,79 @@ FileRange::~FileRange() {}
 bool
 FileRange::hasFrame(qint64 frame) const
 {
-    return p->d.ranges.contains(frame);
+    const qint64 slot = p->slot(frame);
+    return slot >= 0 && !p->isHole(slot);
 }
 
 File
 FileRange::frame(qint64 frame) const
 {
     Q_ASSERT("Frame not found in range" && hasFrame(frame));
-    return (p->d.ranges.value(frame));
+    return File(QFileInfo(filePath(frame)));
+}
+
+QString
+FileRange::filePath(qint64 frame) const
+{
+    QString number = QString::number(qAbs(frame)).rightJustified(p->d.padding, '0');
+    if (frame < 0)
+        number.prepend('-');
+
+    QString path;
+    path.reserve(p->d.prefix.size() + number.size() + p->d.suffix.size());
+    path.append(p->d.prefix).append(number).append(p->d.suffix);
+    return path;
 }
 
 qint64
 FileRange::start() const
 {
-    return p->d.ranges.keys().front();
+    return p->d.first;
 }
 
 qint64
 FileRange::end() const
 {
-    return p->d.ranges.keys().back();
+    return p->d.last;
+}
+
+qint64
+FileRange::step() const
+{
+    return p->d.step;
 }
 
 qint64
 FileRange::size() const
 {
-    return p->d.ranges.size();
+    return p->slots() - p->d.missing;
+}
+
+QList<qint64>
+FileRange::holes() const
+{
+    QList<qint64> frames;
+    if (!p->d.missing)
+        return frames;
+
+    frames.reserve(p->d.missing);
+    for (qint64 i = 0; i < p->d.holes.size(); ++i) {
+        if (p->d.holes.testBit(i))
+            frames.append(p->d.first + i * p->d.step);
+    }
+    return frames;
+}
+
+QString
+FileRange::pattern() const
+{
+    return p->d.prefix + QString(p->d.padding, '#') + p->d.suffix;
+}
+
+int
+FileRange::padding() const
+{
+    return p->d.padding;
 }
 
 bool
@@ -65,15 +248,74 @@ FileRange::isValid() const
 void
 FileRange::reset()
 {
-    p.detach();
-    p->d.ranges.clear();
+    p.reset(new FileRangePrivate());
 }
 
 void
 FileRange::insertFrame(qint64 frame, const File& file)
 {
     p.detach();
-    p->d.ranges.insert(frame, file);
+    if (p->isEmpty() && !p->d.padding) {
+        const bool matched = p->setPattern(file.filePath(), frame);
+        Q_ASSERT("file name does not contain frame" && matched);
+        Q_UNUSED(matched);
+    }
+    Q_ASSERT("file does not follow range pattern" && filePath(frame) == file.filePath());
+    insertFrame(frame);
+}
+
+void
+FileRange::insertFrame(qint64 frame)
+{
+    p.detach();
+    if (p->isEmpty()) {
+        p->d.first = frame;
+        p->d.last = frame;
+        return;
+    }
+
+    Q_ASSERT("frame is not on range step" && (frame - p->d.first) % p->d.step == 0);
+    if ((frame - p->d.first) % p->d.step)
+        return;
+
+    if (frame > p->d.last) {
+        const qint64 count = p->slots();
+        p->d.last = frame;
+        if (!p->d.holes.isEmpty())
+            p->d.holes.resize(p->slots());
+        p->setHoles(count, p->slots() - 1);
+    }
+    else if (frame < p->d.first) {
+        const qint64 shift = (p->d.first - frame) / p->d.step;
+        if (!p->d.holes.isEmpty() || shift > 1) {
+            QBitArray holes(p->slots() + shift);
+            for (qint64 i = 0; i < p->d.holes.size(); ++i)
+                holes.setBit(i + shift, p->d.holes.testBit(i));
+            p->d.holes = holes;
+        }
+        p->d.first = frame;
+        p->setHoles(1, shift);
+    }
+    else {
+        const qint64 slot = p->slot(frame);
+        if (p->isHole(slot)) {
+            p->d.holes.clearBit(slot);
+            if (--p->d.missing == 0)
+                p->d.holes.clear();
+        }
+    }
+}
+
+void
+FileRange::removeFrame(qint64 frame)
+{
+    if (!hasFrame(frame))
+        return;
+
+    p.detach();
+    const qint64 slot = p->slot(frame);
+    p->setHoles(slot, slot + 1);
+    p->trim();
 }
 
 FileRange&
@@ -88,7 +330,10 @@ FileRange::operator=(const FileRange& other)
 bool
 FileRange::operator==(const FileRange& filerange) const
 {
-    return p->d.ranges == filerange.p->d.ranges;
+    const FileRangePrivate::Data& d = p->d;
+    const FileRangePrivate::Data& o = filerange.p->d;
+    return d.prefix == o.prefix && d.suffix == o.suffix && d.padding == o.padding && d.first == o.first
+           && d.last == o.last && d.step == o.step && d.holes == o.holes;
 }
 
 bool
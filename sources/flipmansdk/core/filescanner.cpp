@@ -0,0 +1,584 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/core/filerange.h>
+#include <flipmansdk/core/filescanner.h>
+#include <flipmansdk/core/threadpool.h>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(Q_OS_LINUX)
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    include <dirent.h>
+#elif defined(Q_OS_UNIX)
+#    include <sys/stat.h>
+#    include <dirent.h>
+#else
+#    include <QDirIterator>
+#endif
+
+namespace flipman::sdk::core {
+
+namespace {
+    // frame numbers wider than this do not fit a qint64, such names are
+    // treated as plain files.
+    constexpr size_t maxDigits = 18;
+
+    struct Filter {
+        QByteArray glob;
+        QRegularExpression regex;
+        bool any = false;
+    };
+
+    struct Group {
+        std::string key;
+        size_t begin = 0;
+        size_t padding = 0;
+        std::vector<qint64> frames;
+    };
+
+    struct Scan {
+        std::unordered_map<std::string, size_t> index;
+        std::vector<Group> groups;
+        std::vector<std::string> files;
+        std::string key;
+    };
+
+    inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c; }
+
+    bool globMatch(const char* glob, size_t globLength, const char* name, size_t nameLength)
+    {
+        // iterative wildcard match, a '*' remembers where to resume when the
+        // rest of the pattern fails.
+        size_t g = 0, n = 0;
+        size_t star = std::string::npos, resume = 0;
+        while (n < nameLength) {
+            if (g < globLength && (glob[g] == '?' || lower(glob[g]) == lower(name[n]))) {
+                g++;
+                n++;
+            }
+            else if (g < globLength && glob[g] == '*') {
+                star = g++;
+                resume = n;
+            }
+            else if (star != std::string::npos) {
+                g = star + 1;
+                n = ++resume;
+            }
+            else {
+                return false;
+            }
+        }
+        while (g < globLength && glob[g] == '*')
+            g++;
+        return g == globLength;
+    }
+
+    bool matches(const std::vector<Filter>& filters, const char* name, size_t length)
+    {
+        if (filters.empty())
+            return true;
+        for (const Filter& filter : filters) {
+            if (filter.any)
+                return true;
+            if (!filter.regex.pattern().isEmpty()) {
+                if (filter.regex.match(QFile::decodeName(QByteArray(name, qsizetype(length)))).hasMatch())
+                    return true;
+            }
+            else if (globMatch(filter.glob.constData(), size_t(filter.glob.size()), name, length)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool token(const char* name, size_t length, size_t& begin, size_t& end, qint64& frame)
+    {
+        // the frame number is the last run of digits in the name.
+        end = length;
+        while (end > 0 && (name[end - 1] < '0' || name[end - 1] > '9'))
+            end--;
+        if (!end)
+            return false;
+        begin = end;
+        while (begin > 0 && name[begin - 1] >= '0' && name[begin - 1] <= '9')
+            begin--;
+        if (end - begin > maxDigits)
+            return false;
+        frame = 0;
+        for (size_t i = begin; i < end; ++i)
+            frame = frame * 10 + (name[i] - '0');
+        return true;
+    }
+
+    void insert(Scan& scan, const char* name, size_t length, bool ranges)
+    {
+        size_t begin = 0, end = 0;
+        qint64 frame = 0;
+        if (!ranges || !token(name, length, begin, end, frame)) {
+            scan.files.emplace_back(name, length);
+            return;
+        }
+
+        // names with the digit run blanked out share a key, the buffer is
+        // reused so lookups of known sequences do not allocate.
+        scan.key.assign(name, length);
+        std::memset(scan.key.data() + begin, 0, end - begin);
+        auto it = scan.index.find(scan.key);
+        if (it == scan.index.end()) {
+            it = scan.index.emplace(scan.key, scan.groups.size()).first;
+            scan.groups.push_back(Group { scan.key, begin, end - begin, {} });
+        }
+        scan.groups[it->second].frames.push_back(frame);
+    }
+
+#if defined(Q_OS_UNIX)
+    template<typename Fn> void visit(int fd, const char* name, unsigned char type, Fn& fn)
+    {
+        if (name[0] == '.')
+            return;
+        struct stat st;
+        if (type == DT_UNKNOWN) {
+            // file systems without d_type need a stat.
+            if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+                return;
+            type = S_ISREG(st.st_mode) ? DT_REG : S_ISDIR(st.st_mode) ? DT_DIR : S_ISLNK(st.st_mode) ? DT_LNK : type;
+        }
+        if (type == DT_LNK) {
+            // links to files count as files, linked directories are not
+            // followed so walks cannot cycle.
+            if (fstatat(fd, name, &st, 0) != 0 || !S_ISREG(st.st_mode))
+                return;
+            type = DT_REG;
+        }
+        if (type == DT_REG || type == DT_DIR)
+            fn(name, std::strlen(name), type == DT_DIR);
+    }
+#endif
+
+#if defined(Q_OS_LINUX)
+    struct Dirent64 {
+        quint64 d_ino;
+        qint64 d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    template<typename Fn> bool readDir(const QString& path, Fn fn)
+    {
+        // getdents64 with a large buffer reads thousands of entries per
+        // system call, readdir() refills a 32 KiB buffer.
+        const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        std::vector<char> buffer(1024 * 1024);
+        long count = 0;
+        while ((count = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size())) > 0) {
+            for (long offset = 0; offset < count;) {
+                const char* data = buffer.data() + offset;
+                const Dirent64* entry = reinterpret_cast<const Dirent64*>(data);
+                visit(fd, data + offsetof(Dirent64, d_name), entry->d_type, fn);
+                offset += entry->d_reclen;
+            }
+        }
+        ::close(fd);
+        return count == 0;
+    }
+#elif defined(Q_OS_UNIX)
+    template<typename Fn> bool readDir(const QString& path, Fn fn)
+    {
+        DIR* dir = ::opendir(QFile::encodeName(path).constData());
+        if (!dir)
+            return false;
+
+        const int fd = ::dirfd(dir);
+        while (const dirent* entry = ::readdir(dir))
+            visit(fd, entry->d_name, entry->d_type, fn);
+        ::closedir(dir);
+        return true;
+    }
+#else
+    template<typename Fn> bool readDir(const QString& path, Fn fn)
+    {
+        if (!QFileInfo(path).isDir())
+            return false;
+
+        QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        while (it.hasNext()) {
+            it.next();
+            const QByteArray name = QFile::encodeName(it.fileName());
+            fn(name.constData(), size_t(name.size()), it.fileInfo().isDir());
+        }
+        return true;
+    }
+#endif
+
+    struct Options {
+        std::vector<Filter> filters;
+        bool ranges = true;
+        bool holes = false;
+    };
+
+    class Walk {
+    public:
+        struct Dir {
+            qsizetype root = 0;
+            QString path;
+        };
+
+        explicit Walk(qsizetype workers)
+            : queues(workers)
+        {}
+
+        void push(qsizetype worker, Dir dir)
+        {
+            pending++;
+            {
+                QMutexLocker locker(&queues[worker].mutex);
+                queues[worker].dirs.push_back(std::move(dir));
+            }
+            QMutexLocker locker(&mutex);
+            queued++;
+            ready.wakeOne();
+        }
+
+        template<typename Fn> void run(qsizetype worker, Fn& fn)
+        {
+            // each worker takes the newest directory from its own queue and
+            // steals the oldest from others, pending counts directories
+            // queued or being read so idle workers know when the walk ends.
+            Dir dir;
+            while (pending > 0) {
+                if (!pop(worker, dir)) {
+                    // queued is raised under the mutex before the wakeup, a
+                    // push between the failed pop and the wait is not lost.
+                    QMutexLocker locker(&mutex);
+                    while (queued <= 0 && pending > 0)
+                        ready.wait(&mutex);
+                    continue;
+                }
+                fn(dir);
+                if (--pending == 0) {
+                    QMutexLocker locker(&mutex);
+                    ready.wakeAll();
+                }
+            }
+        }
+
+    private:
+        bool pop(qsizetype worker, Dir& dir)
+        {
+            {
+                Queue& queue = queues[worker];
+                QMutexLocker locker(&queue.mutex);
+                if (!queue.dirs.empty()) {
+                    dir = std::move(queue.dirs.back());
+                    queue.dirs.pop_back();
+                    queued--;
+                    return true;
+                }
+            }
+            for (qsizetype i = 1; i < qsizetype(queues.size()); ++i) {
+                Queue& queue = queues[(worker + i) % queues.size()];
+                QMutexLocker locker(&queue.mutex);
+                if (!queue.dirs.empty()) {
+                    dir = std::move(queue.dirs.front());
+                    queue.dirs.pop_front();
+                    queued--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        struct Queue {
+            QMutex mutex;
+            std::deque<Dir> dirs;
+        };
+        std::vector<Queue> queues;
+        std::atomic<qint64> pending { 0 };
+        std::atomic<qint64> queued { 0 };
+        QMutex mutex;
+        QWaitCondition ready;
+    };
+}  // namespace
+
+class FileScannerPrivate {
+public:
+    static QList<File> scan(const QString& path, const Options& options, QStringList* dirs, Error& error);
+    Options options() const;
+    QList<File> walk(const QStringList& paths, const Options& options);
+    void setError(const Error& error);
+    struct Data {
+        QStringList nameFilters;
+        bool ranges = true;
+        bool holes = false;
+        bool recursive = false;
+        QMutex mutex;
+        Error error;
+    };
+    Data d;
+};
+
+QList<File>
+FileScannerPrivate::scan(const QString& path, const Options& options, QStringList* dirs, Error& error)
+{
+    // an empty path lists the current directory, as QDir("") does.
+    Scan scan;
+    const bool ok = readDir(path.isEmpty() ? QString(".") : path, [&](const char* name, size_t length, bool dir) {
+        if (dir) {
+            if (dirs)
+                dirs->append(QFile::decodeName(QByteArray(name, qsizetype(length))));
+        }
+        else if (matches(options.filters, name, length)) {
+            insert(scan, name, length, options.ranges);
+        }
+    });
+    if (!ok) {
+        error = Error("filescanner", QString("could not read directory: %1").arg(path));
+        return QList<File>();
+    }
+
+    const QString dir = path.isEmpty() ? QString("./") : path.endsWith('/') ? path : path + '/';
+    if (dirs) {
+        for (QString& name : *dirs)
+            name.prepend(dir);
+    }
+    struct Entry {
+        QString name;
+        File file;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(scan.files.size() + scan.groups.size());
+
+    auto append = [&](const QString& name) -> File& {
+        entries.push_back(Entry { name, File(QFileInfo(dir + name)) });
+        return entries.back().file;
+    };
+    for (const std::string& file : scan.files)
+        append(QFile::decodeName(QByteArray(file.data(), qsizetype(file.size()))));
+
+    for (Group& group : scan.groups) {
+        std::sort(group.frames.begin(), group.frames.end());
+
+        const QString prefix = QFile::decodeName(QByteArray(group.key.data(), qsizetype(group.begin)));
+        const size_t end = group.begin + group.padding;
+        const QString suffix = QFile::decodeName(
+            QByteArray(group.key.data() + end, qsizetype(group.key.size() - end)));
+        auto name = [&](qint64 frame) {
+            return prefix + QString::number(frame).rightJustified(qsizetype(group.padding), '0') + suffix;
+        };
+
+        // without holes every run of consecutive frames is a File of its
+        // own, single frames are plain files.
+        const std::vector<qint64>& frames = group.frames;
+        for (size_t first = 0; first < frames.size();) {
+            size_t last = first;
+            while (last + 1 < frames.size() && (options.holes || frames[last + 1] == frames[last] + 1))
+                last++;
+
+            File& file = append(name(frames[first]));
+            if (last > first) {
+                FileRange range;
+                range.insertFrame(frames[first], file);
+                for (size_t i = first + 1; i <= last; ++i)
+                    range.insertFrame(frames[i]);
+                file.setFileRange(range);
+            }
+            first = last + 1;
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+    QList<File> files;
+    files.reserve(qsizetype(entries.size()));
+    for (Entry& entry : entries)
+        files.append(std::move(entry.file));
+    return files;
+}
+
+Options
+FileScannerPrivate::options() const
+{
+    // filters are prepared once per scan, only character classes need a
+    // regular expression.
+    Options options;
+    options.ranges = d.ranges;
+    options.holes = d.holes;
+    for (const QString& nameFilter : d.nameFilters) {
+        Filter filter;
+        if (nameFilter == "*") {
+            filter.any = true;
+        }
+        else if (nameFilter.contains('[')) {
+            filter.regex = QRegularExpression(QRegularExpression::wildcardToRegularExpression(nameFilter),
+                                              QRegularExpression::CaseInsensitiveOption);
+        }
+        else {
+            filter.glob = QFile::encodeName(nameFilter);
+        }
+        options.filters.push_back(filter);
+    }
+    return options;
+}
+
+QList<File>
+FileScannerPrivate::walk(const QStringList& paths, const Options& options)
+{
+    struct Result {
+        qsizetype root;
+        QString path;
+        QList<File> files;
+    };
+    QMutex mutex;
+    std::vector<Result> results;
+
+    const qsizetype workers = qMax(1, threadPool()->maxThreadCount());
+    Walk walk(workers);
+    for (qsizetype i = 0; i < paths.size(); ++i)
+        walk.push(i % workers, Walk::Dir { i, paths[i] });
+
+    // directories carry the index of their root so results keep the order
+    // of the requested paths.
+    threadPool()->parallelFor(workers, [&](qint64 worker) {
+        auto read = [&](const Walk::Dir& dir) {
+            Error error;
+            QStringList dirs;
+            QList<File> files = FileScannerPrivate::scan(dir.path, options, &dirs, error);
+            if (error.hasError())
+                setError(error);
+            for (const QString& path : dirs)
+                walk.push(worker, Walk::Dir { dir.root, path });
+
+            QMutexLocker locker(&mutex);
+            results.push_back(Result { dir.root, dir.path, std::move(files) });
+        };
+        walk.run(worker, read);
+    });
+
+    std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
+        return a.root != b.root ? a.root < b.root : a.path < b.path;
+    });
+
+    QList<File> files;
+    for (const Result& result : results)
+        files.append(result.files);
+    return files;
+}
+
+void
+FileScannerPrivate::setError(const Error& error)
+{
+    QMutexLocker locker(&d.mutex);
+    if (!d.error.hasError())
+        d.error = error;
+}
+
+FileScanner::FileScanner()
+    : p(new FileScannerPrivate())
+{}
+
+FileScanner::~FileScanner() {}
+
+QStringList
+FileScanner::nameFilters() const
+{
+    return p->d.nameFilters;
+}
+
+void
+FileScanner::setNameFilters(const QStringList& nameFilters)
+{
+    p->d.nameFilters = nameFilters;
+}
+
+bool
+FileScanner::ranges() const
+{
+    return p->d.ranges;
+}
+
+void
+FileScanner::setRanges(bool ranges)
+{
+    p->d.ranges = ranges;
+}
+
+bool
+FileScanner::holes() const
+{
+    return p->d.holes;
+}
+
+void
+FileScanner::setHoles(bool holes)
+{
+    p->d.holes = holes;
+}
+
+bool
+FileScanner::recursive() const
+{
+    return p->d.recursive;
+}
+
+void
+FileScanner::setRecursive(bool recursive)
+{
+    p->d.recursive = recursive;
+}
+
+QList<File>
+FileScanner::scan(const QString& path)
+{
+    return scan(QStringList() << path);
+}
+
+QList<File>
+FileScanner::scan(const QStringList& paths)
+{
+    p->d.error = Error();
+    const Options options = p->options();
+    if (p->d.recursive)
+        return p->walk(paths, options);
+
+    QList<QList<File>> results(paths.size());
+    QList<File>* result = results.data();
+    threadPool()->parallelFor(paths.size(), [&](qint64 index) {
+        Error error;
+        result[index] = FileScannerPrivate::scan(paths[index], options, nullptr, error);
+        if (error.hasError())
+            p->setError(error);
+    });
+
+    QList<File> files;
+    for (const QList<File>& result : results)
+        files.append(result);
+    return files;
+}
+
+Error
+FileScanner::error() const
+{
+    return p->d.error;
+}
+
+}  // namespace flipman::sdk::core
@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/core/framecache.h>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+namespace flipman::sdk::core {
+
+namespace {
+    struct FrameKey {
+        QString key;
+        qint64 frame = 0;
+        bool operator==(const FrameKey& other) const { return frame == other.frame && key == other.key; }
+    };
+
+    size_t qHash(const FrameKey& key, size_t seed = 0) { return qHashMulti(seed, key.key, key.frame); }
+}  // namespace
+
+class FrameCachePrivate {
+public:
+    void evict();
+    void release(qsizetype slot);
+    struct Slot {
+        FrameKey key;
+        ImageBuffer image;
+        qint64 bytes = 0;
+        bool referenced = false;
+        bool used = false;
+    };
+    struct Data {
+        mutable QMutex mutex;
+        QHash<FrameKey, qsizetype> index;
+        QList<Slot> slots;
+        QList<qsizetype> free;
+        qsizetype hand = 0;
+        qint64 bytes = 0;
+        qint64 budget = qint64(2) << 30;  // 2 GiB
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+    };
+    Data d;
+};
+
+void
+FrameCachePrivate::evict()
+{
+    // clock sweep, a referenced frame gets a second chance and is skipped
+    // once, frames not read since the previous sweep are released.
+    while (d.bytes > d.budget && !d.index.isEmpty()) {
+        if (d.hand >= d.slots.size())
+            d.hand = 0;
+
+        Slot& slot = d.slots[d.hand];
+        if (slot.used) {
+            if (slot.referenced) {
+                slot.referenced = false;
+            }
+            else {
+                release(d.hand);
+                d.evictions++;
+            }
+        }
+        d.hand++;
+    }
+}
+
+void
+FrameCachePrivate::release(qsizetype index)
+{
+    Slot& slot = d.slots[index];
+    d.index.remove(slot.key);
+    d.bytes -= slot.bytes;
+    slot = Slot();
+    d.free.append(index);
+}
+
+FrameCache::FrameCache()
+    : p(new FrameCachePrivate())
+{}
+
+FrameCache::~FrameCache() {}
+
+bool
+FrameCache::find(const QString& key, qint64 frame, ImageBuffer& image)
+{
+    QMutexLocker locker(&p->d.mutex);
+    auto it = p->d.index.constFind({ key, frame });
+    if (it == p->d.index.constEnd()) {
+        p->d.misses++;
+        return false;
+    }
+    FrameCachePrivate::Slot& slot = p->d.slots[it.value()];
+    slot.referenced = true;
+    image = slot.image;
+    p->d.hits++;
+    return true;
+}
+
+bool
+FrameCache::contains(const QString& key, qint64 frame) const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.index.contains({ key, frame });
+}
+
+void
+FrameCache::insert(const QString& key, qint64 frame, const ImageBuffer& image)
+{
+    const qint64 bytes = qint64(image.byteSize());
+    QMutexLocker locker(&p->d.mutex);
+    if (!image.isValid() || bytes > p->d.budget)
+        return;
+
+    const FrameKey frameKey { key, frame };
+    auto it = p->d.index.constFind(frameKey);
+    if (it != p->d.index.constEnd())
+        p->release(it.value());
+
+    qsizetype index;
+    if (!p->d.free.isEmpty()) {
+        index = p->d.free.takeLast();
+    }
+    else {
+        index = p->d.slots.size();
+        p->d.slots.append(FrameCachePrivate::Slot());
+    }
+
+    FrameCachePrivate::Slot& slot = p->d.slots[index];
+    slot.key = frameKey;
+    slot.image = image;
+    slot.bytes = bytes;
+    slot.referenced = true;
+    slot.used = true;
+    p->d.index.insert(frameKey, index);
+    p->d.bytes += bytes;
+    p->evict();
+}
+
+void
+FrameCache::remove(const QString& key)
+{
+    QMutexLocker locker(&p->d.mutex);
+    for (qsizetype i = 0; i < p->d.slots.size(); ++i) {
+        if (p->d.slots[i].used && p->d.slots[i].key.key == key)
+            p->release(i);
+    }
+}
+
+void
+FrameCache::clear()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.index.clear();
+    p->d.slots.clear();
+    p->d.free.clear();
+    p->d.hand = 0;
+    p->d.bytes = 0;
+}
+
+qint64
+FrameCache::budget() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.budget;
+}
+
+void
+FrameCache::setBudget(qint64 bytes)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.budget = qMax<qint64>(0, bytes);
+    p->evict();
+}
+
+FrameCache::Stats
+FrameCache::stats() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    Stats stats;
+    stats.hits = p->d.hits;
+    stats.misses = p->d.misses;
+    stats.evictions = p->d.evictions;
+    stats.frames = p->d.index.size();
+    stats.residentBytes = p->d.bytes;
+    stats.budgetBytes = p->d.budget;
+    return stats;
+}
+
+void
+FrameCache::resetStats()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.hits = 0;
+    p->d.misses = 0;
+    p->d.evictions = 0;
+}
+
+FrameCache*
+FrameCache::instance()
+{
+    static FrameCache cache;
+    return &cache;
+}
+
+}  // namespace flipman::sdk::core
@@ -3,14 +3,31 @@
 // https://github.com/mikaelsundell/flipman
 
 #include <flipmansdk/core/imagebuffer.h>
+#include <flipmansdk/core/imagebufferpool.h>
+#include <flipmansdk/core/threadpool.h>
 #include <OpenImageIO/half.h>
+#include <QtEndian>
 
 #if defined(__ARM_NEON)
 #    include <arm_neon.h>
 #endif
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#    define IMAGEBUFFER_X86
+#    define IMAGEBUFFER_TARGET_SSSE3 __attribute__((target("ssse3")))
+#    define IMAGEBUFFER_TARGET_SSE41 __attribute__((target("sse4.1")))
+#    define IMAGEBUFFER_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
+#include <array>
+#include <atomic>
 #include <cstring>
+#include <functional>
 #include <limits>
+#include <utility>
+#include <vector>
 
 namespace flipman::sdk::core {
 
@@ -85,6 +102,42 @@ convertBuffer(const S* src, D* dst, size_t count)
         dst[i] = convertScalar<S, D>(src[i]);
 }
 
+// component types per ImageFormat::Type, checked against the trait table so
+// dispatch, kernel tables and byte sizes cannot disagree.
+
+template<ImageFormat::Type T> struct FormatType {};
+template<> struct FormatType<ImageFormat::UInt8> { using type = uint8_t; };
+template<> struct FormatType<ImageFormat::Int8> { using type = int8_t; };
+template<> struct FormatType<ImageFormat::UInt16> { using type = uint16_t; };
+template<> struct FormatType<ImageFormat::Int16> { using type = int16_t; };
+template<> struct FormatType<ImageFormat::UInt32> { using type = uint32_t; };
+template<> struct FormatType<ImageFormat::Int32> { using type = int32_t; };
+template<> struct FormatType<ImageFormat::UInt64> { using type = uint64_t; };
+template<> struct FormatType<ImageFormat::Int64> { using type = int64_t; };
+template<> struct FormatType<ImageFormat::Half> { using type = half; };
+template<> struct FormatType<ImageFormat::Float> { using type = float; };
+template<> struct FormatType<ImageFormat::Double> { using type = double; };
+
+template<ImageFormat::Type T>
+constexpr bool
+matchesTraits()
+{
+    using C = typename FormatType<T>::type;
+    constexpr ImageFormat::Traits traits = ImageFormat::traits(T);
+    return sizeof(C) == traits.size && std::numeric_limits<C>::is_integer == traits.isInteger
+           && std::numeric_limits<C>::is_signed == traits.isSigned;
+}
+
+template<int... I>
+constexpr bool
+matchesTraits(std::integer_sequence<int, I...>)
+{
+    return (matchesTraits<ImageFormat::Type(I + 1)>() && ...);
+}
+
+static_assert(matchesTraits(std::make_integer_sequence<int, ImageFormat::Double>()),
+              "component types must match image format traits");
+
 template<typename F>
 inline void
 dispatchByFormat(ImageFormat::Type t, F&& fn)
@@ -92,33 +145,988 @@ dispatchByFormat(ImageFormat::Type t, F&& fn)
     using T = ImageFormat::Type;
 
     switch (t) {
-    case T::UInt8: fn(uint8_t {}); break;
-    case T::Int8: fn(int8_t {}); break;
-    case T::UInt16: fn(uint16_t {}); break;
-    case T::Int16: fn(int16_t {}); break;
-    case T::UInt32: fn(uint32_t {}); break;
-    case T::Int32: fn(int32_t {}); break;
-    case T::UInt64: fn(uint64_t {}); break;
-    case T::Int64: fn(int64_t {}); break;
-    case T::Half: fn(half {}); break;
-    case T::Float: fn(float {}); break;
-    case T::Double: fn(double {}); break;
+    case T::UInt8: fn(FormatType<T::UInt8>::type {}); break;
+    case T::Int8: fn(FormatType<T::Int8>::type {}); break;
+    case T::UInt16: fn(FormatType<T::UInt16>::type {}); break;
+    case T::Int16: fn(FormatType<T::Int16>::type {}); break;
+    case T::UInt32: fn(FormatType<T::UInt32>::type {}); break;
+    case T::Int32: fn(FormatType<T::Int32>::type {}); break;
+    case T::UInt64: fn(FormatType<T::UInt64>::type {}); break;
+    case T::Int64: fn(FormatType<T::Int64>::type {}); break;
+    case T::Half: fn(FormatType<T::Half>::type {}); break;
+    case T::Float: fn(FormatType<T::Float>::type {}); break;
+    case T::Double: fn(FormatType<T::Double>::type {}); break;
     default: Q_ASSERT(false && "Unsupported ImageFormat::Type");
     }
 }
 
+// conversion kernels operate on contiguous runs of scalar components. The
+// vectorised kernels process the bulk of a run and finish the tail with the
+// scalar templates above, results are bit-exact with the scalar path: the
+// same float scale factors are applied with separate multiply and add, half
+// conversion rounds to nearest even like Imath and integer results truncate
+// after clamping.
+
+using ConvertKernel = void (*)(const quint8* from, quint8* to, size_t count);
+
+template<typename S, typename D>
+void
+convertKernel(const quint8* from, quint8* to, size_t count)
+{
+    convertBuffer<S, D>(reinterpret_cast<const S*>(from), reinterpret_cast<D*>(to), count);
+}
+
+#if defined(IMAGEBUFFER_X86)
+
+IMAGEBUFFER_TARGET_SSE41 void
+convertUInt8FloatSse41(const quint8* from, quint8* to, size_t count)
+{
+    const uint8_t* s = from;
+    float* d = reinterpret_cast<float*>(to);
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int32_t bytes;
+        std::memcpy(&bytes, s + i, sizeof(bytes));
+        const __m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+        _mm_storeu_ps(d + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    convertBuffer<uint8_t, float>(s + i, d + i, count - i);
+}
+
+IMAGEBUFFER_TARGET_SSE41 void
+convertFloatUInt8Sse41(const quint8* from, quint8* to, size_t count)
+{
+    const float* s = reinterpret_cast<const float*>(from);
+    uint8_t* d = to;
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 bias = _mm_set1_ps(0.5f);
+    const __m128 min = _mm_setzero_ps();
+    const __m128 max = _mm_set1_ps(255.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // negative values clamp to zero either way, so the sign dependent
+        // rounding bias of the scalar path reduces to a plain +0.5.
+        __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(s + i), scale), bias);
+        v = _mm_min_ps(_mm_max_ps(v, min), max);
+        const __m128i w = _mm_packus_epi32(_mm_cvttps_epi32(v), _mm_setzero_si128());
+        const int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+        std::memcpy(d + i, &bytes, sizeof(bytes));
+    }
+    convertBuffer<float, uint8_t>(s + i, d + i, count - i);
+}
+
+IMAGEBUFFER_TARGET_AVX2 void
+convertUInt8HalfAvx2(const quint8* from, quint8* to, size_t count)
+{
+    const uint8_t* s = from;
+    uint16_t* d = reinterpret_cast<uint16_t*>(to);
+    const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + i)));
+        const __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    convertBuffer<uint8_t, half>(s + i, reinterpret_cast<half*>(d + i), count - i);
+}
+
+IMAGEBUFFER_TARGET_AVX2 void
+convertUInt16HalfAvx2(const quint8* from, quint8* to, size_t count)
+{
+    const uint16_t* s = reinterpret_cast<const uint16_t*>(from);
+    uint16_t* d = reinterpret_cast<uint16_t*>(to);
+    const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+        const __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    convertBuffer<uint16_t, half>(s + i, reinterpret_cast<half*>(d + i), count - i);
+}
+
+IMAGEBUFFER_TARGET_AVX2 void
+convertUInt8FloatAvx2(const quint8* from, quint8* to, size_t count)
+{
+    const uint8_t* s = from;
+    float* d = reinterpret_cast<float*>(to);
+    const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + i)));
+        _mm256_storeu_ps(d + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    convertBuffer<uint8_t, float>(s + i, d + i, count - i);
+}
+
+IMAGEBUFFER_TARGET_AVX2 inline __m128i
+packUInt8Avx2(__m256 v)
+{
+    const __m256 bias = _mm256_set1_ps(0.5f);
+    const __m256 max = _mm256_set1_ps(255.0f);
+    v = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(v, bias), _mm256_setzero_ps()), max);
+    const __m256i i = _mm256_cvttps_epi32(v);
+    const __m128i w = _mm_packus_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+    return _mm_packus_epi16(w, w);
+}
+
+IMAGEBUFFER_TARGET_AVX2 void
+convertHalfUInt8Avx2(const quint8* from, quint8* to, size_t count)
+{
+    const uint16_t* s = reinterpret_cast<const uint16_t*>(from);
+    uint8_t* d = to;
+    const __m256 scale = _mm256_set1_ps(255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 f = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + i), packUInt8Avx2(_mm256_mul_ps(f, scale)));
+    }
+    convertBuffer<half, uint8_t>(reinterpret_cast<const half*>(s + i), d + i, count - i);
+}
+
+IMAGEBUFFER_TARGET_AVX2 void
+convertFloatUInt8Avx2(const quint8* from, quint8* to, size_t count)
+{
+    const float* s = reinterpret_cast<const float*>(from);
+    uint8_t* d = to;
+    const __m256 scale = _mm256_set1_ps(255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 f = _mm256_loadu_ps(s + i);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + i), packUInt8Avx2(_mm256_mul_ps(f, scale)));
+    }
+    convertBuffer<float, uint8_t>(s + i, d + i, count - i);
+}
+
+IMAGEBUFFER_TARGET_AVX2 void
+convertHalfFloatAvx2(const quint8* from, quint8* to, size_t count)
+{
+    const uint16_t* s = reinterpret_cast<const uint16_t*>(from);
+    float* d = reinterpret_cast<float*>(to);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(d + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))));
+
+    convertBuffer<half, float>(reinterpret_cast<const half*>(s + i), d + i, count - i);
+}
+
+IMAGEBUFFER_TARGET_AVX2 void
+convertFloatHalfAvx2(const quint8* from, quint8* to, size_t count)
+{
+    const float* s = reinterpret_cast<const float*>(from);
+    uint16_t* d = reinterpret_cast<uint16_t*>(to);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 f = _mm256_loadu_ps(s + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    convertBuffer<float, half>(s + i, reinterpret_cast<half*>(d + i), count - i);
+}
+
+#endif
+
+#if defined(__ARM_NEON)
+
+inline uint8x8_t
+packUInt8Neon(float32x4_t lo, float32x4_t hi)
+{
+    const float32x4_t bias = vdupq_n_f32(0.5f);
+    const float32x4_t min = vdupq_n_f32(0.0f);
+    const float32x4_t max = vdupq_n_f32(255.0f);
+    lo = vminq_f32(vmaxq_f32(vaddq_f32(lo, bias), min), max);
+    hi = vminq_f32(vmaxq_f32(vaddq_f32(hi, bias), min), max);
+    const uint16x8_t w = vcombine_u16(vmovn_u32(vcvtq_u32_f32(lo)), vmovn_u32(vcvtq_u32_f32(hi)));
+    return vmovn_u16(w);
+}
+
+void
+convertUInt8FloatNeon(const quint8* from, quint8* to, size_t count)
+{
+    const uint8_t* s = from;
+    float* d = reinterpret_cast<float*>(to);
+    const float32x4_t scale = vdupq_n_f32(1.0f / 255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t w = vmovl_u8(vld1_u8(s + i));
+        vst1q_f32(d + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(w))), scale));
+        vst1q_f32(d + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(w))), scale));
+    }
+    convertBuffer<uint8_t, float>(s + i, d + i, count - i);
+}
+
+void
+convertFloatUInt8Neon(const quint8* from, quint8* to, size_t count)
+{
+    const float* s = reinterpret_cast<const float*>(from);
+    uint8_t* d = to;
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const float32x4_t lo = vmulq_f32(vld1q_f32(s + i), scale);
+        const float32x4_t hi = vmulq_f32(vld1q_f32(s + i + 4), scale);
+        vst1_u8(d + i, packUInt8Neon(lo, hi));
+    }
+    convertBuffer<float, uint8_t>(s + i, d + i, count - i);
+}
+
+#    if defined(__aarch64__)
+
+void
+convertUInt8HalfNeon(const quint8* from, quint8* to, size_t count)
+{
+    const uint8_t* s = from;
+    uint16_t* d = reinterpret_cast<uint16_t*>(to);
+    const float32x4_t scale = vdupq_n_f32(1.0f / 255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t w = vmovl_u8(vld1_u8(s + i));
+        const float32x4_t lo = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(w))), scale);
+        const float32x4_t hi = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(w))), scale);
+        vst1_u16(d + i, vreinterpret_u16_f16(vcvt_f16_f32(lo)));
+        vst1_u16(d + i + 4, vreinterpret_u16_f16(vcvt_f16_f32(hi)));
+    }
+    convertBuffer<uint8_t, half>(s + i, reinterpret_cast<half*>(d + i), count - i);
+}
+
+void
+convertUInt16HalfNeon(const quint8* from, quint8* to, size_t count)
+{
+    const uint16_t* s = reinterpret_cast<const uint16_t*>(from);
+    uint16_t* d = reinterpret_cast<uint16_t*>(to);
+    const float32x4_t scale = vdupq_n_f32(1.0f / 65535.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t w = vld1q_u16(s + i);
+        const float32x4_t lo = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(w))), scale);
+        const float32x4_t hi = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(w))), scale);
+        vst1_u16(d + i, vreinterpret_u16_f16(vcvt_f16_f32(lo)));
+        vst1_u16(d + i + 4, vreinterpret_u16_f16(vcvt_f16_f32(hi)));
+    }
+    convertBuffer<uint16_t, half>(s + i, reinterpret_cast<half*>(d + i), count - i);
+}
+
+void
+convertHalfUInt8Neon(const quint8* from, quint8* to, size_t count)
+{
+    const uint16_t* s = reinterpret_cast<const uint16_t*>(from);
+    uint8_t* d = to;
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const float32x4_t lo = vmulq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(s + i))), scale);
+        const float32x4_t hi = vmulq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(s + i + 4))), scale);
+        vst1_u8(d + i, packUInt8Neon(lo, hi));
+    }
+    convertBuffer<half, uint8_t>(reinterpret_cast<const half*>(s + i), d + i, count - i);
+}
+
+void
+convertHalfFloatNeon(const quint8* from, quint8* to, size_t count)
+{
+    const uint16_t* s = reinterpret_cast<const uint16_t*>(from);
+    float* d = reinterpret_cast<float*>(to);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(d + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(s + i))));
+
+    convertBuffer<half, float>(reinterpret_cast<const half*>(s + i), d + i, count - i);
+}
+
+void
+convertFloatHalfNeon(const quint8* from, quint8* to, size_t count)
+{
+    const float* s = reinterpret_cast<const float*>(from);
+    uint16_t* d = reinterpret_cast<uint16_t*>(to);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1_u16(d + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(s + i))));
+
+    convertBuffer<float, half>(s + i, reinterpret_cast<half*>(d + i), count - i);
+}
+
+#    endif
+#endif
+
+struct ConvertKernels {
+    ConvertKernel uint8Half = &convertKernel<uint8_t, half>;
+    ConvertKernel uint16Half = &convertKernel<uint16_t, half>;
+    ConvertKernel uint8Float = &convertKernel<uint8_t, float>;
+    ConvertKernel halfUInt8 = &convertKernel<half, uint8_t>;
+    ConvertKernel floatUInt8 = &convertKernel<float, uint8_t>;
+    ConvertKernel halfFloat = &convertKernel<half, float>;
+    ConvertKernel floatHalf = &convertKernel<float, half>;
+    bool ssse3 = false;
+};
+
+const ConvertKernels&
+convertKernels()
+{
+    static const ConvertKernels kernels = []() {
+        ConvertKernels k;
+#if defined(IMAGEBUFFER_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("ssse3"))
+            k.ssse3 = true;
+
+        if (__builtin_cpu_supports("sse4.1")) {
+            k.uint8Float = &convertUInt8FloatSse41;
+            k.floatUInt8 = &convertFloatUInt8Sse41;
+        }
+
+        // f16c has no __builtin_cpu_supports name on all compilers, cpuid
+        // leaf 1 reports it in ecx bit 29.
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        const bool f16c = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 29));
+        if (__builtin_cpu_supports("avx2") && f16c) {
+            k.uint8Half = &convertUInt8HalfAvx2;
+            k.uint16Half = &convertUInt16HalfAvx2;
+            k.uint8Float = &convertUInt8FloatAvx2;
+            k.halfUInt8 = &convertHalfUInt8Avx2;
+            k.floatUInt8 = &convertFloatUInt8Avx2;
+            k.halfFloat = &convertHalfFloatAvx2;
+            k.floatHalf = &convertFloatHalfAvx2;
+        }
+#elif defined(__ARM_NEON)
+        k.uint8Float = &convertUInt8FloatNeon;
+        k.floatUInt8 = &convertFloatUInt8Neon;
+#    if defined(__aarch64__)
+        k.uint8Half = &convertUInt8HalfNeon;
+        k.uint16Half = &convertUInt16HalfNeon;
+        k.halfUInt8 = &convertHalfUInt8Neon;
+        k.halfFloat = &convertHalfFloatNeon;
+        k.floatHalf = &convertFloatHalfNeon;
+#    endif
+#endif
+        return k;
+    }();
+    return kernels;
+}
+
+// scalar kernels for every pair of component types, built at compile time
+// and indexed by ImageFormat::Type, the Unknown row and column stay empty.
+
+template<int S, int... D>
+constexpr std::array<ConvertKernel, ImageFormat::Double + 1>
+scalarKernelRow(std::integer_sequence<int, D...>)
+{
+    return { nullptr, &convertKernel<typename FormatType<ImageFormat::Type(S)>::type,
+                                     typename FormatType<ImageFormat::Type(D + 1)>::type>... };
+}
+
+template<int... S>
+constexpr std::array<std::array<ConvertKernel, ImageFormat::Double + 1>, ImageFormat::Double + 1>
+scalarKernelTable(std::integer_sequence<int, S...>)
+{
+    return { std::array<ConvertKernel, ImageFormat::Double + 1> {},
+             scalarKernelRow<S + 1>(std::make_integer_sequence<int, ImageFormat::Double>())... };
+}
+
+constexpr auto scalarKernels = scalarKernelTable(std::make_integer_sequence<int, ImageFormat::Double>());
+
+ConvertKernel
+findConvertKernel(ImageFormat::Type from, ImageFormat::Type to)
+{
+    using T = ImageFormat::Type;
+    const ConvertKernels& kernels = convertKernels();
+
+    if (from == T::UInt8 && to == T::Half)
+        return kernels.uint8Half;
+    if (from == T::UInt16 && to == T::Half)
+        return kernels.uint16Half;
+    if (from == T::UInt8 && to == T::Float)
+        return kernels.uint8Float;
+    if (from == T::Half && to == T::UInt8)
+        return kernels.halfUInt8;
+    if (from == T::Float && to == T::UInt8)
+        return kernels.floatUInt8;
+    if (from == T::Half && to == T::Float)
+        return kernels.halfFloat;
+    if (from == T::Float && to == T::Half)
+        return kernels.floatHalf;
+
+    if (!ImageFormat(from).isValid() || !ImageFormat(to).isValid())
+        return nullptr;
+
+    return scalarKernels[from][to];
+}
+
+// channel kernels reorder or expand interleaved pixels of one scalar type,
+// they only move bits so they are exact by construction.
+
+template<typename T>
+void
+expandKernel(const quint8* from, int fromChannels, quint8* to, int toChannels, const quint8* order, T alpha,
+             size_t count)
+{
+    const T* s = reinterpret_cast<const T*>(from);
+    T* d = reinterpret_cast<T*>(to);
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < toChannels; ++c)
+            d[c] = order[c] < fromChannels ? s[order[c]] : alpha;
+        s += fromChannels;
+        d += toChannels;
+    }
+}
+
+#if defined(IMAGEBUFFER_X86)
+
+IMAGEBUFFER_TARGET_SSSE3 size_t
+shuffleSsse3(const quint8* from, int fromChannels, quint8* to, const quint8* order, const quint8* alpha,
+             size_t size, size_t count)
+{
+    // one 16 byte store holds 16 / (4 * size) output pixels, rgb sources use
+    // 12 of the 16 bytes loaded so the loop stops before reading past the row.
+    const size_t pixels = 16 / (4 * size);
+    alignas(16) quint8 mask[16];
+    alignas(16) quint8 fill[16];
+    for (size_t p = 0; p < pixels; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            for (size_t b = 0; b < size; ++b) {
+                const size_t i = (p * 4 + size_t(c)) * size + b;
+                const bool copy = order[c] < fromChannels;
+                mask[i] = copy ? quint8((p * size_t(fromChannels) + order[c]) * size + b) : 0x80;
+                fill[i] = copy ? 0 : alpha[b];
+            }
+        }
+    }
+    const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+    const __m128i constant = _mm_load_si128(reinterpret_cast<const __m128i*>(fill));
+    const size_t stride = size_t(fromChannels) * size;
+
+    size_t i = 0;
+    for (; (i + pixels) <= count && i * stride + 16 <= count * stride; i += pixels) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i * stride));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i * 4 * size),
+                         _mm_or_si128(_mm_shuffle_epi8(v, shuffle), constant));
+    }
+    return i;
+}
+
+#endif
+
+#if defined(__ARM_NEON)
+
+template<typename T, typename V3, typename V4, typename Q, typename Load3, typename Load4, typename Store4>
+size_t
+shuffleNeon(const quint8* from, int fromChannels, quint8* to, const quint8* order, Q alpha, size_t lanes,
+            size_t count, Load3 load3, Load4 load4, Store4 store4)
+{
+    const T* s = reinterpret_cast<const T*>(from);
+    T* d = reinterpret_cast<T*>(to);
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        V4 rgba;
+        if (fromChannels == 3) {
+            const V3 rgb = load3(s + i * 3);
+            rgba.val[0] = rgb.val[order[0]];
+            rgba.val[1] = rgb.val[order[1]];
+            rgba.val[2] = rgb.val[order[2]];
+            rgba.val[3] = alpha;
+        }
+        else {
+            const V4 src = load4(s + i * 4);
+            rgba.val[0] = src.val[order[0]];
+            rgba.val[1] = src.val[order[1]];
+            rgba.val[2] = src.val[order[2]];
+            rgba.val[3] = src.val[3];
+        }
+        store4(d + i * 4, rgba);
+    }
+    return i;
+}
+
+#endif
+
+void
+expandChannels(ImageFormat::Type type, const quint8* from, int fromChannels, quint8* to, int toChannels,
+               const quint8* order, size_t count)
+{
+    dispatchByFormat(type, [&](auto tag) {
+        using T = decltype(tag);
+        const T alpha = std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::max() : T(1);
+
+        // rgb to rgba expansion and rgba reordering are the hot layouts, other
+        // channel counts fall through to the scalar kernel.
+        size_t done = 0;
+        if (toChannels == 4 && (fromChannels == 3 || fromChannels == 4) && order[3] == 3) {
+#if defined(__ARM_NEON)
+            if constexpr (sizeof(T) == 1) {
+                done = shuffleNeon<uint8_t, uint8x16x3_t, uint8x16x4_t>(
+                    from, fromChannels, to, order, vdupq_n_u8(255), 16, count,
+                    [](const uint8_t* p) { return vld3q_u8(p); }, [](const uint8_t* p) { return vld4q_u8(p); },
+                    [](uint8_t* p, uint8x16x4_t v) { vst4q_u8(p, v); });
+            }
+            else if constexpr (sizeof(T) == 2) {
+                uint16_t bits;
+                std::memcpy(&bits, &alpha, sizeof(bits));
+                done = shuffleNeon<uint16_t, uint16x8x3_t, uint16x8x4_t>(
+                    from, fromChannels, to, order, vdupq_n_u16(bits), 8, count,
+                    [](const uint16_t* p) { return vld3q_u16(p); }, [](const uint16_t* p) { return vld4q_u16(p); },
+                    [](uint16_t* p, uint16x8x4_t v) { vst4q_u16(p, v); });
+            }
+            else if constexpr (sizeof(T) == 4) {
+                uint32_t bits;
+                std::memcpy(&bits, &alpha, sizeof(bits));
+                done = shuffleNeon<uint32_t, uint32x4x3_t, uint32x4x4_t>(
+                    from, fromChannels, to, order, vdupq_n_u32(bits), 4, count,
+                    [](const uint32_t* p) { return vld3q_u32(p); }, [](const uint32_t* p) { return vld4q_u32(p); },
+                    [](uint32_t* p, uint32x4x4_t v) { vst4q_u32(p, v); });
+            }
+#elif defined(IMAGEBUFFER_X86)
+            if constexpr (sizeof(T) <= 4) {
+                if (convertKernels().ssse3) {
+                    quint8 bits[sizeof(T)];
+                    std::memcpy(bits, &alpha, sizeof(T));
+                    done = shuffleSsse3(from, fromChannels, to, order, bits, sizeof(T), count);
+                }
+            }
+#endif
+        }
+        expandKernel<T>(from + done * size_t(fromChannels) * sizeof(T), fromChannels,
+                        to + done * size_t(toChannels) * sizeof(T), toChannels, order, alpha, count - done);
+    });
+}
+
+// ycbcr decode runs in two passes per row: the layout specific unpack widens
+// code values to float runs of y, cb and cr with chroma replicated to every
+// pixel, the matrix kernel turns those runs into interleaved rgba float. The
+// vector kernels evaluate the same expressions in the same order as the
+// scalar kernel, chroma is sampled nearest like the decode shaders.
+
+struct YCbCrMatrix {
+    float yOffset = 0.0f;
+    float yScale = 1.0f;
+    float cOffset = 0.0f;
+    float cScale = 1.0f;
+    float crR = 0.0f;
+    float cbG = 0.0f;
+    float crG = 0.0f;
+    float cbB = 0.0f;
+};
+
+void
+lumaCoefficients(render::ColorSpace colorSpace, float& kr, float& kb)
+{
+    // unknown and wide gamut rgb spaces use rec709, same as the shaders.
+    kr = 0.2126f;
+    kb = 0.0722f;
+    if (colorSpace == render::ColorSpace::Rec601) {
+        kr = 0.299f;
+        kb = 0.114f;
+    }
+    else if (colorSpace == render::ColorSpace::Rec2020) {
+        kr = 0.2627f;
+        kb = 0.0593f;
+    }
+}
+
+YCbCrMatrix
+ycbcrMatrix(render::ColorSpace colorSpace, ImageBuffer::PixelRange pixelRange, int bits)
+{
+    float kr;
+    float kb;
+    lumaCoefficients(colorSpace, kr, kb);
+    const float kg = 1.0f - kr - kb;
+    const float scale = float(1 << (bits - 8));
+
+    YCbCrMatrix m;
+    m.cOffset = 128.0f * scale;
+    if (pixelRange == ImageBuffer::PixelRange::Full) {
+        m.yScale = 1.0f / float((1 << bits) - 1);
+        m.cScale = m.yScale;
+    }
+    else {
+        m.yOffset = 16.0f * scale;
+        m.yScale = 1.0f / (219.0f * scale);
+        m.cScale = 1.0f / (224.0f * scale);
+    }
+    m.crR = 2.0f * (1.0f - kr);
+    m.cbG = -2.0f * kb * (1.0f - kb) / kg;
+    m.crG = -2.0f * kr * (1.0f - kr) / kg;
+    m.cbB = 2.0f * (1.0f - kb);
+    return m;
+}
+
+void
+ycbcrScalar(const float* y, const float* cb, const float* cr, float* rgba, size_t count, const YCbCrMatrix& m)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float l = (y[i] - m.yOffset) * m.yScale;
+        const float u = (cb[i] - m.cOffset) * m.cScale;
+        const float v = (cr[i] - m.cOffset) * m.cScale;
+        float* d = rgba + i * 4;
+        d[0] = l + m.crR * v;
+        d[1] = l + m.cbG * u + m.crG * v;
+        d[2] = l + m.cbB * u;
+        d[3] = 1.0f;
+    }
+}
+
+#if defined(IMAGEBUFFER_X86) && defined(__SSE2__)
+
+size_t
+ycbcrSse2(const float* y, const float* cb, const float* cr, float* rgba, size_t count, const YCbCrMatrix& m)
+{
+    const __m128 yOffset = _mm_set1_ps(m.yOffset);
+    const __m128 yScale = _mm_set1_ps(m.yScale);
+    const __m128 cOffset = _mm_set1_ps(m.cOffset);
+    const __m128 cScale = _mm_set1_ps(m.cScale);
+    const __m128 crR = _mm_set1_ps(m.crR);
+    const __m128 cbG = _mm_set1_ps(m.cbG);
+    const __m128 crG = _mm_set1_ps(m.crG);
+    const __m128 cbB = _mm_set1_ps(m.cbB);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 l = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(y + i), yOffset), yScale);
+        const __m128 u = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(cb + i), cOffset), cScale);
+        const __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(cr + i), cOffset), cScale);
+        __m128 r = _mm_add_ps(l, _mm_mul_ps(crR, v));
+        __m128 g = _mm_add_ps(_mm_add_ps(l, _mm_mul_ps(cbG, u)), _mm_mul_ps(crG, v));
+        __m128 b = _mm_add_ps(l, _mm_mul_ps(cbB, u));
+        __m128 a = _mm_set1_ps(1.0f);
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        _mm_storeu_ps(rgba + i * 4, r);
+        _mm_storeu_ps(rgba + i * 4 + 4, g);
+        _mm_storeu_ps(rgba + i * 4 + 8, b);
+        _mm_storeu_ps(rgba + i * 4 + 12, a);
+    }
+    return i;
+}
+
+#endif
+
+#if defined(__ARM_NEON)
+
+size_t
+ycbcrNeon(const float* y, const float* cb, const float* cr, float* rgba, size_t count, const YCbCrMatrix& m)
+{
+    const float32x4_t yOffset = vdupq_n_f32(m.yOffset);
+    const float32x4_t yScale = vdupq_n_f32(m.yScale);
+    const float32x4_t cOffset = vdupq_n_f32(m.cOffset);
+    const float32x4_t cScale = vdupq_n_f32(m.cScale);
+    const float32x4_t crR = vdupq_n_f32(m.crR);
+    const float32x4_t cbG = vdupq_n_f32(m.cbG);
+    const float32x4_t crG = vdupq_n_f32(m.crG);
+    const float32x4_t cbB = vdupq_n_f32(m.cbB);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t l = vmulq_f32(vsubq_f32(vld1q_f32(y + i), yOffset), yScale);
+        const float32x4_t u = vmulq_f32(vsubq_f32(vld1q_f32(cb + i), cOffset), cScale);
+        const float32x4_t v = vmulq_f32(vsubq_f32(vld1q_f32(cr + i), cOffset), cScale);
+        float32x4x4_t px;
+        px.val[0] = vaddq_f32(l, vmulq_f32(crR, v));
+        px.val[1] = vaddq_f32(vaddq_f32(l, vmulq_f32(cbG, u)), vmulq_f32(crG, v));
+        px.val[2] = vaddq_f32(l, vmulq_f32(cbB, u));
+        px.val[3] = vdupq_n_f32(1.0f);
+        vst4q_f32(rgba + i * 4, px);
+    }
+    return i;
+}
+
+#endif
+
+void
+ycbcrToRgba(const float* y, const float* cb, const float* cr, float* rgba, size_t count, const YCbCrMatrix& m)
+{
+    size_t done = 0;
+#if defined(__ARM_NEON)
+    done = ycbcrNeon(y, cb, cr, rgba, count, m);
+#elif defined(IMAGEBUFFER_X86) && defined(__SSE2__)
+    done = ycbcrSse2(y, cb, cr, rgba, count, m);
+#endif
+    ycbcrScalar(y + done, cb + done, cr + done, rgba + done * 4, count - done, m);
+}
+
+void
+unpackBiPlanar(const quint8* luma, const quint8* chroma, int chromaWidth, bool swapped, float* y, float* cb,
+               float* cr, int width)
+{
+    const int u = swapped ? 1 : 0;
+    const int v = 1 - u;
+    for (int x = 0; x < width; ++x) {
+        const int c = qMin(x / 2, chromaWidth - 1) * 2;
+        y[x] = luma[x];
+        cb[x] = chroma[c + u];
+        cr[x] = chroma[c + v];
+    }
+}
+
+void
+unpackPacked(const quint8* from, const quint8* offsets, float* y, float* cb, float* cr, int width)
+{
+    // offsets of y0, y1, cb and cr within each four byte pixel pair.
+    for (int x = 0; x < width; ++x) {
+        const quint8* pair = from + size_t(x / 2) * 4;
+        y[x] = pair[offsets[x & 1]];
+        cb[x] = pair[offsets[2]];
+        cr[x] = pair[offsets[3]];
+    }
+}
+
+void
+unpackV210(const quint8* from, float* y, float* cb, float* cr, int width)
+{
+    // six pixels in four little endian words of three 10-bit components:
+    // cb0 y0 cr0, y1 cb2 y2, cr2 y3 cb4, y4 cr4 y5.
+    for (int x = 0; x < width; x += 6) {
+        const quint8* block = from + size_t(x / 6) * 16;
+        const quint32 w0 = qFromLittleEndian<quint32>(block);
+        const quint32 w1 = qFromLittleEndian<quint32>(block + 4);
+        const quint32 w2 = qFromLittleEndian<quint32>(block + 8);
+        const quint32 w3 = qFromLittleEndian<quint32>(block + 12);
+        const quint32 luma[6] = { (w0 >> 10) & 0x3ff, w1 & 0x3ff, (w1 >> 20) & 0x3ff,
+                                  (w2 >> 10) & 0x3ff, w3 & 0x3ff, (w3 >> 20) & 0x3ff };
+        const quint32 blue[3] = { w0 & 0x3ff, (w1 >> 10) & 0x3ff, (w2 >> 20) & 0x3ff };
+        const quint32 red[3] = { (w0 >> 20) & 0x3ff, w2 & 0x3ff, (w3 >> 10) & 0x3ff };
+
+        const int count = qMin(6, width - x);
+        for (int i = 0; i < count; ++i) {
+            y[x + i] = float(luma[i]);
+            cb[x + i] = float(blue[i / 2]);
+            cr[x + i] = float(red[i / 2]);
+        }
+    }
+}
+
+// ycbcr encode mirrors decode: the matrix kernel turns interleaved rgba
+// float into clamped y, cb and cr runs, the layout specific pack filters
+// chroma per pixel pair and quantizes to legal range code values like the
+// uyvy8 compute shader.
+
+struct RgbMatrix {
+    float kr = 0.0f;
+    float kg = 0.0f;
+    float kb = 0.0f;
+    float cbDivisor = 1.0f;
+    float crDivisor = 1.0f;
+};
+
+RgbMatrix
+rgbMatrix(render::ColorSpace colorSpace)
+{
+    RgbMatrix m;
+    lumaCoefficients(colorSpace, m.kr, m.kb);
+    m.kg = 1.0f - m.kr - m.kb;
+    m.cbDivisor = 2.0f * (1.0f - m.kb);
+    m.crDivisor = 2.0f * (1.0f - m.kr);
+    return m;
+}
+
+void
+rgbaToYCbCrScalar(const float* rgba, float* y, float* cb, float* cr, size_t count, const RgbMatrix& m)
+{
+    // comparisons are ordered so nan clamps to zero like the vector max.
+    auto saturate = [](float v) {
+        v = v > 0.0f ? v : 0.0f;
+        return v < 1.0f ? v : 1.0f;
+    };
+    for (size_t i = 0; i < count; ++i) {
+        const float* s = rgba + i * 4;
+        const float r = saturate(s[0]);
+        const float g = saturate(s[1]);
+        const float b = saturate(s[2]);
+        const float l = m.kr * r + m.kg * g + m.kb * b;
+        y[i] = l;
+        cb[i] = (b - l) / m.cbDivisor;
+        cr[i] = (r - l) / m.crDivisor;
+    }
+}
+
+#if defined(IMAGEBUFFER_X86) && defined(__SSE2__)
+
+size_t
+rgbaToYCbCrSse2(const float* rgba, float* y, float* cb, float* cr, size_t count, const RgbMatrix& m)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 kr = _mm_set1_ps(m.kr);
+    const __m128 kg = _mm_set1_ps(m.kg);
+    const __m128 kb = _mm_set1_ps(m.kb);
+    const __m128 cbDivisor = _mm_set1_ps(m.cbDivisor);
+    const __m128 crDivisor = _mm_set1_ps(m.crDivisor);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 r = _mm_loadu_ps(rgba + i * 4);
+        __m128 g = _mm_loadu_ps(rgba + i * 4 + 4);
+        __m128 b = _mm_loadu_ps(rgba + i * 4 + 8);
+        __m128 a = _mm_loadu_ps(rgba + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        r = _mm_min_ps(_mm_max_ps(r, zero), one);
+        g = _mm_min_ps(_mm_max_ps(g, zero), one);
+        b = _mm_min_ps(_mm_max_ps(b, zero), one);
+        const __m128 l = _mm_add_ps(_mm_add_ps(_mm_mul_ps(kr, r), _mm_mul_ps(kg, g)), _mm_mul_ps(kb, b));
+        _mm_storeu_ps(y + i, l);
+        _mm_storeu_ps(cb + i, _mm_div_ps(_mm_sub_ps(b, l), cbDivisor));
+        _mm_storeu_ps(cr + i, _mm_div_ps(_mm_sub_ps(r, l), crDivisor));
+    }
+    return i;
+}
+
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+
+size_t
+rgbaToYCbCrNeon(const float* rgba, float* y, float* cb, float* cr, size_t count, const RgbMatrix& m)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t kr = vdupq_n_f32(m.kr);
+    const float32x4_t kg = vdupq_n_f32(m.kg);
+    const float32x4_t kb = vdupq_n_f32(m.kb);
+    const float32x4_t cbDivisor = vdupq_n_f32(m.cbDivisor);
+    const float32x4_t crDivisor = vdupq_n_f32(m.crDivisor);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4x4_t px = vld4q_f32(rgba + i * 4);
+        const float32x4_t r = vminnmq_f32(vmaxnmq_f32(px.val[0], zero), one);
+        const float32x4_t g = vminnmq_f32(vmaxnmq_f32(px.val[1], zero), one);
+        const float32x4_t b = vminnmq_f32(vmaxnmq_f32(px.val[2], zero), one);
+        const float32x4_t l = vaddq_f32(vaddq_f32(vmulq_f32(kr, r), vmulq_f32(kg, g)), vmulq_f32(kb, b));
+        vst1q_f32(y + i, l);
+        vst1q_f32(cb + i, vdivq_f32(vsubq_f32(b, l), cbDivisor));
+        vst1q_f32(cr + i, vdivq_f32(vsubq_f32(r, l), crDivisor));
+    }
+    return i;
+}
+
+#endif
+
+void
+rgbaToYCbCr(const float* rgba, float* y, float* cb, float* cr, size_t count, const RgbMatrix& m)
+{
+    size_t done = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    done = rgbaToYCbCrNeon(rgba, y, cb, cr, count, m);
+#elif defined(IMAGEBUFFER_X86) && defined(__SSE2__)
+    done = rgbaToYCbCrSse2(rgba, y, cb, cr, count, m);
+#endif
+    rgbaToYCbCrScalar(rgba + done * 4, y + done, cb + done, cr + done, count - done, m);
+}
+
+struct LegalRange {
+    float yOffset;
+    float yScale;
+    float cOffset;
+    float cScale;
+    float min;
+    float max;
+};
+
+// 8-bit clamps to the full code range like the shader, 10-bit keeps the
+// sdi timing reference codes 0-3 and 1020-1023 free.
+constexpr LegalRange legalRange8 { 16.0f, 219.0f, 128.0f, 224.0f, 0.0f, 255.0f };
+constexpr LegalRange legalRange10 { 64.0f, 876.0f, 512.0f, 896.0f, 4.0f, 1019.0f };
+
+inline quint32
+quantize(float value, float offset, float scale, const LegalRange& range)
+{
+    return quint32(std::clamp(offset + scale * value + 0.5f, range.min, range.max));
+}
+
+inline float
+filterChroma(const float* c, int x, int width, ImageBuffer::ChromaFilter chromaFilter)
+{
+    // x is the first pixel of a pair, pixels past the edge repeat the last.
+    const int next = qMin(x + 1, width - 1);
+    if (chromaFilter == ImageBuffer::ChromaFilter::Average)
+        return (c[x] + c[next]) * 0.5f;
+
+    const int prev = qMax(x - 1, 0);
+    return (c[prev] + 2.0f * c[x] + c[next]) * 0.25f;
+}
+
+void
+packUYVY(const float* y, const float* cb, const float* cr, int width, ImageBuffer::ChromaFilter chromaFilter,
+         quint8* to, size_t stride)
+{
+    const LegalRange& range = legalRange8;
+    for (int x = 0; x < width; x += 2) {
+        const int next = qMin(x + 1, width - 1);
+        const quint8 pair[4] = {
+            quint8(quantize(filterChroma(cb, x, width, chromaFilter), range.cOffset, range.cScale, range)),
+            quint8(quantize(y[x], range.yOffset, range.yScale, range)),
+            quint8(quantize(filterChroma(cr, x, width, chromaFilter), range.cOffset, range.cScale, range)),
+            quint8(quantize(y[next], range.yOffset, range.yScale, range)),
+        };
+        // odd widths keep the last pair inside the row.
+        const size_t offset = size_t(x) * 2;
+        std::memcpy(to + offset, pair, qMin<size_t>(4, stride - offset));
+    }
+}
+
+void
+packV210(const float* y, const float* cb, const float* cr, int width, ImageBuffer::ChromaFilter chromaFilter,
+         quint8* to, size_t stride)
+{
+    const LegalRange& range = legalRange10;
+    size_t offset = 0;
+    for (int x = 0; x < width; x += 6, offset += 16) {
+        quint32 luma[6];
+        quint32 blue[3];
+        quint32 red[3];
+        for (int i = 0; i < 6; ++i)
+            luma[i] = quantize(y[qMin(x + i, width - 1)], range.yOffset, range.yScale, range);
+        for (int i = 0; i < 3; ++i) {
+            const int c = qMin(x + i * 2, width - 1);
+            blue[i] = quantize(filterChroma(cb, c, width, chromaFilter), range.cOffset, range.cScale, range);
+            red[i] = quantize(filterChroma(cr, c, width, chromaFilter), range.cOffset, range.cScale, range);
+        }
+        qToLittleEndian<quint32>(blue[0] | luma[0] << 10 | red[0] << 20, to + offset);
+        qToLittleEndian<quint32>(luma[1] | blue[1] << 10 | luma[2] << 20, to + offset + 4);
+        qToLittleEndian<quint32>(red[1] | luma[3] << 10 | blue[2] << 20, to + offset + 8);
+        qToLittleEndian<quint32>(luma[4] | red[2] << 10 | luma[5] << 20, to + offset + 12);
+    }
+    if (offset < stride)
+        std::memset(to + offset, 0, stride - offset);
+}
+
 class ImageBufferPrivate : public QSharedData {
 public:
     ImageBufferPrivate();
     ~ImageBufferPrivate();
-    void alloc();
+    void alloc(ImageBufferPool* pool);
+    void detachData();
+    size_t planeOffset(int plane) const;
     size_t byteSize() const;
     size_t pixelSize() const;
     size_t strideSize() const;
     size_t size() const;
     static ImageBuffer::PixelLayout pixelLayout(ImageBuffer::PixelLayout layout, int channels);
+    static void channelOrder(ImageBuffer::PixelLayout from, ImageBuffer::PixelLayout to, quint8* order);
     static void convert(const ImageFormat& fromformat, const quint8* from, const ImageFormat& toformat, quint8* to,
                         int count);
+    static void convert(const ImageBuffer& from, ImageBuffer& to, const quint8* order);
+    static void convertRows(const ImageBuffer& from, ImageBuffer& to, const quint8* order, int begin, int end);
+    static void decode(const ImageBuffer& from, ImageBuffer& to);
+    static void decodeRows(const ImageBuffer& from, ImageBuffer& to, int begin, int end);
+    static void encode(const ImageBuffer& from, ImageBuffer& to, ImageBuffer::ChromaFilter chromaFilter);
+    static void encodeRows(const ImageBuffer& from, ImageBuffer& to, ImageBuffer::ChromaFilter chromaFilter,
+                           int begin, int end);
+    static void forEachTile(int height, size_t stride, const std::function<void(int begin, int end)>& fn);
+    static std::atomic<qint64> tileSize;
     struct Data {
         ImageFormat format;
         QRect dataWindow;
@@ -130,17 +1138,20 @@ public:
         ImageBuffer::PixelRange pixelRange = ImageBuffer::PixelRange::Unknown;
         render::ColorSpace colorSpace = render::ColorSpace::Unknown;
         render::TransferFunction transferFunction = render::TransferFunction::Unknown;
-        QByteArray data;
+        std::shared_ptr<quint8> data;
+        size_t dataSize = 0;
     };
     Data d;
 };
 
+std::atomic<qint64> ImageBufferPrivate::tileSize { 256 * 1024 };
+
 ImageBufferPrivate::ImageBufferPrivate() {}
 
 ImageBufferPrivate::~ImageBufferPrivate() {}
 
 void
-ImageBufferPrivate::alloc()
+ImageBufferPrivate::alloc(ImageBufferPool* pool)
 {
     const int w = d.dataWindow.width();
     const int h = d.dataWindow.height();
@@ -175,14 +1186,56 @@ ImageBufferPrivate::alloc()
     default: total = 0; break;
     }
 
-    d.data.resize(qsizetype(total));
+    // keep an unshared block of the same size class, otherwise the old block
+    // returns to its pool and a recycled one is handed out.
+    const bool reuse = d.data && d.data.use_count() == 1
+                       && ImageBufferPool::sizeClass(total) == ImageBufferPool::sizeClass(d.dataSize);
+    if (!reuse)
+        d.data = total > 0 ? pool->allocate(total) : std::shared_ptr<quint8>();
+
+    d.dataSize = d.data ? total : 0;
+}
+
+void
+ImageBufferPrivate::detachData()
+{
+    // pixels stay shared after a detach and are copied on the first write.
+    if (d.data && d.data.use_count() > 1) {
+        std::shared_ptr<quint8> data = ImageBufferPool::instance()->allocate(d.dataSize);
+        std::memcpy(data.get(), d.data.get(), d.dataSize);
+        d.data = data;
+    }
+}
+
+size_t
+ImageBufferPrivate::planeOffset(int plane) const
+{
+    switch (d.packing) {
+    case ImageBuffer::Packing::Interleaved:
+    case ImageBuffer::Packing::Packed: return 0;
+
+    case ImageBuffer::Packing::Planar: {
+        size_t planeSize = size_t(d.dataWindow.width()) * size_t(d.dataWindow.height()) * d.format.size();
+        return size_t(plane) * planeSize;
+    }
+
+    case ImageBuffer::Packing::BiPlanar: {
+        if (plane == 0)
+            return 0;
+
+        size_t yPlaneSize = size_t(d.dataWindow.width()) * size_t(d.dataWindow.height()) * d.format.size();
+        return yPlaneSize;
+    }
+    }
+
+    return 0;
 }
 
 size_t
 ImageBufferPrivate::byteSize() const
 {
-    if (!d.data.isEmpty())
-        return size_t(d.data.size());
+    if (d.data)
+        return d.dataSize;
 
     switch (d.packing) {
     case ImageBuffer::Packing::Interleaved:
@@ -265,16 +1318,218 @@ ImageBufferPrivate::convert(const ImageFormat& fromformat, const quint8* from, c
         return;
     }
 
-    dispatchByFormat(fromformat.type(), [&](auto sTag) {
-        using S = decltype(sTag);
-        const S* src = reinterpret_cast<const S*>(from);
+    findConvertKernel(fromformat.type(), toformat.type())(from, to, size_t(count));
+}
+
+void
+ImageBufferPrivate::channelOrder(ImageBuffer::PixelLayout from, ImageBuffer::PixelLayout to, quint8* order)
+{
+    using L = ImageBuffer::PixelLayout;
+    const bool fromBgr = from == L::BGR || from == L::BGRA;
+    const bool toBgr = to == L::BGR || to == L::BGRA;
+
+    for (int c = 0; c < 4; ++c)
+        order[c] = quint8(c);
+
+    if (fromBgr != toBgr)
+        std::swap(order[0], order[2]);
+}
+
+void
+ImageBufferPrivate::convert(const ImageBuffer& from, ImageBuffer& to, const quint8* order)
+{
+    Q_ASSERT(to.channels() <= 4 && "imagebuffer::convert supports at most four destination channels.");
+
+    forEachTile(from.dataWindow().height(), qMax(from.strideSize(), to.strideSize()),
+                [&](int begin, int end) { convertRows(from, to, order, begin, end); });
+}
+
+void
+ImageBufferPrivate::convertRows(const ImageBuffer& from, ImageBuffer& to, const quint8* order, int begin, int end)
+{
+    const int width = from.dataWindow().width();
+    const int fromChannels = from.channels();
+    const int toChannels = to.channels();
+    const ImageFormat::Type fromType = from.imageFormat().type();
+    const ImageFormat::Type toType = to.imageFormat().type();
+
+    bool identity = fromChannels == toChannels;
+    for (int c = 0; c < toChannels; ++c)
+        identity = identity && order[c] == c;
+
+    // rows are converted to the target type first and reordered after, when
+    // channels change the converted row goes through a per-thread scratch row.
+    const ConvertKernel kernel = fromType != toType ? findConvertKernel(fromType, toType) : nullptr;
+    const size_t count = size_t(width) * size_t(fromChannels);
+
+    thread_local std::vector<quint8> scratch;
+    if (kernel && !identity && scratch.size() < count * to.imageFormat().size())
+        scratch.resize(count * to.imageFormat().size());
+
+    const quint8* src = from.constData();
+    quint8* dst = to.data();
+
+    for (int y = begin; y < end; ++y) {
+        const quint8* s = src + size_t(y) * from.strideSize();
+        quint8* d = dst + size_t(y) * to.strideSize();
+
+        if (identity) {
+            if (kernel)
+                kernel(s, d, count);
+            else
+                std::memcpy(d, s, to.strideSize());
+            continue;
+        }
+
+        if (kernel) {
+            kernel(s, scratch.data(), count);
+            s = scratch.data();
+        }
+        expandChannels(toType, s, fromChannels, d, toChannels, order, size_t(width));
+    }
+}
+
+void
+ImageBufferPrivate::decode(const ImageBuffer& from, ImageBuffer& to)
+{
+    forEachTile(to.dataWindow().height(), qMax(from.strideSize(), to.strideSize()),
+                [&](int begin, int end) { decodeRows(from, to, begin, end); });
+}
 
-        dispatchByFormat(toformat.type(), [&](auto dTag) {
-            using D = decltype(dTag);
-            D* dst = reinterpret_cast<D*>(to);
+void
+ImageBufferPrivate::decodeRows(const ImageBuffer& from, ImageBuffer& to, int begin, int end)
+{
+    using L = ImageBuffer::PixelLayout;
+    const L layout = from.pixelLayout();
+    const int width = to.dataWindow().width();
+    const YCbCrMatrix matrix = ycbcrMatrix(from.colorSpace(), from.pixelRange(), layout == L::V210 ? 10 : 8);
+
+    // byte offsets of y0, y1, cb and cr in a packed 4:2:2 pixel pair.
+    static const quint8 packed[4][4] = { { 1, 3, 0, 2 }, { 0, 2, 1, 3 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+    const quint8* offsets = packed[0];
+    switch (layout) {
+    case L::YUYV: offsets = packed[1]; break;
+    case L::YVYU: offsets = packed[2]; break;
+    case L::VYUY: offsets = packed[3]; break;
+    default: break;
+    }
+
+    // float output is written in place, other types convert from a float
+    // row with the regular conversion kernels.
+    const ImageFormat::Type type = to.imageFormat().type();
+    const ConvertKernel kernel = type != ImageFormat::Float ? findConvertKernel(ImageFormat::Float, type) : nullptr;
+    const size_t count = size_t(width);
+
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < count * 7)
+        scratch.resize(count * 7);
+
+    float* y = scratch.data();
+    float* cb = y + count;
+    float* cr = cb + count;
+    float* rgba = cr + count;
+
+    for (int row = begin; row < end; ++row) {
+        switch (layout) {
+        case L::NV12:
+        case L::NV21: {
+            const QSize chroma = from.planeSize(1);
+            const int chromaRow = qMin(row / 2, chroma.height() - 1);
+            unpackBiPlanar(from.constPlaneData(0) + size_t(row) * from.planeStride(0),
+                           from.constPlaneData(1) + size_t(chromaRow) * from.planeStride(1), chroma.width(),
+                           layout == L::NV21, y, cb, cr, width);
+            break;
+        }
+        case L::V210: unpackV210(from.constData() + size_t(row) * from.strideSize(), y, cb, cr, width); break;
+        default: unpackPacked(from.constData() + size_t(row) * from.strideSize(), offsets, y, cb, cr, width); break;
+        }
+
+        quint8* d = to.data() + size_t(row) * to.strideSize();
+        if (kernel) {
+            ycbcrToRgba(y, cb, cr, rgba, count, matrix);
+            kernel(reinterpret_cast<const quint8*>(rgba), d, count * 4);
+        }
+        else {
+            ycbcrToRgba(y, cb, cr, reinterpret_cast<float*>(d), count, matrix);
+        }
+    }
+}
+
+void
+ImageBufferPrivate::encode(const ImageBuffer& from, ImageBuffer& to, ImageBuffer::ChromaFilter chromaFilter)
+{
+    forEachTile(from.dataWindow().height(), qMax(from.strideSize(), to.strideSize()),
+                [&](int begin, int end) { encodeRows(from, to, chromaFilter, begin, end); });
+}
+
+void
+ImageBufferPrivate::encodeRows(const ImageBuffer& from, ImageBuffer& to, ImageBuffer::ChromaFilter chromaFilter,
+                               int begin, int end)
+{
+    const int width = from.dataWindow().width();
+    const int channels = from.channels();
+    const ImageFormat::Type type = from.imageFormat().type();
+    const RgbMatrix matrix = rgbMatrix(from.colorSpace());
+
+    quint8 order[4];
+    channelOrder(from.pixelLayout(), ImageBuffer::PixelLayout::RGBA, order);
+
+    bool identity = channels == 4;
+    for (int c = 0; c < 4; ++c)
+        identity = identity && order[c] == c;
+
+    // rows go to rgba float first, float rgba sources are read in place.
+    const ConvertKernel kernel = type != ImageFormat::Float ? findConvertKernel(type, ImageFormat::Float) : nullptr;
+    const size_t count = size_t(width);
+
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < count * 11)
+        scratch.resize(count * 11);
+
+    float* converted = scratch.data();
+    float* rgba = converted + count * 4;
+    float* y = rgba + count * 4;
+    float* cb = y + count;
+    float* cr = cb + count;
+
+    for (int row = begin; row < end; ++row) {
+        const quint8* s = from.constData() + size_t(row) * from.strideSize();
+        if (kernel) {
+            kernel(s, reinterpret_cast<quint8*>(converted), count * size_t(channels));
+            s = reinterpret_cast<const quint8*>(converted);
+        }
+
+        const float* pixels = reinterpret_cast<const float*>(s);
+        if (!identity) {
+            expandChannels(ImageFormat::Float, s, channels, reinterpret_cast<quint8*>(rgba), 4, order, count);
+            pixels = rgba;
+        }
+        rgbaToYCbCr(pixels, y, cb, cr, count, matrix);
 
-            convertBuffer<S, D>(src, dst, size_t(count));
-        });
+        quint8* d = to.data() + size_t(row) * to.strideSize();
+        if (to.pixelLayout() == ImageBuffer::PixelLayout::V210)
+            packV210(y, cb, cr, width, chromaFilter, d, to.strideSize());
+        else
+            packUYVY(y, cb, cr, width, chromaFilter, d, to.strideSize());
+    }
+}
+
+void
+ImageBufferPrivate::forEachTile(int height, size_t stride, const std::function<void(int begin, int end)>& fn)
+{
+    // rows are independent, tiles of whole rows sized to stay in cache run on
+    // the core thread pool, small images stay on the calling thread.
+    const int rows = int(qBound<qint64>(1, tileSize.load() / qint64(stride), height));
+    const qint64 tiles = (height + rows - 1) / rows;
+
+    if (tiles <= 1) {
+        fn(0, height);
+        return;
+    }
+
+    threadPool()->parallelFor(tiles, [&](qint64 tile) {
+        const int begin = int(tile) * rows;
+        fn(begin, qMin(height, begin + rows));
     });
 }
 
@@ -298,10 +1553,15 @@ ImageBuffer::ImageBuffer(const ImageBuffer& other)
 ImageBuffer::~ImageBuffer() {}
 
 void
-ImageBuffer::allocate()
+ImageBuffer::allocate(ImageBufferPool* pool)
 {
-    detach();
-    p->alloc();
+    // contents are replaced, detach without copying the shared pixels.
+    if (p->ref.loadRelaxed() > 1) {
+        p.detach();
+        p->d.data.reset();
+        p->d.dataSize = 0;
+    }
+    p->alloc(pool ? pool : ImageBufferPool::instance());
 }
 
 ImageFormat
@@ -377,7 +1637,8 @@ ImageBuffer::setPacking(Packing packing)
             p->d.subsampling = Subsampling::None;
         }
 
-        p->d.data.clear();
+        p->d.data.reset();
+        p->d.dataSize = 0;
     }
 }
 
@@ -396,7 +1657,8 @@ ImageBuffer::setSubsampling(Subsampling subsampling)
     if (p->d.subsampling != subsampling) {
         detach();
         p->d.subsampling = subsampling;
-        p->d.data.clear();
+        p->d.data.reset();
+        p->d.dataSize = 0;
     }
 }
 
@@ -503,23 +1765,34 @@ ImageBuffer::setTransferFunction(render::TransferFunction transferFunction)
 }
 
 quint8*
-ImageBuffer::data() const
+ImageBuffer::data()
 {
-    Q_ASSERT(!p->d.data.isEmpty() && "imagebuffer not allocated. Call allocate() before accessing data.");
-    return reinterpret_cast<quint8*>(p->d.data.data());
+    Q_ASSERT(p->d.data && "imagebuffer not allocated. Call allocate() before accessing data.");
+    detach();
+    p->detachData();
+    return p->d.data.get();
 }
 
 quint8*
-ImageBuffer::data(const QPoint& pos) const
+ImageBuffer::data(const QPoint& pos)
 {
-    Q_ASSERT(!p->d.data.isEmpty() && "imagebuffer not allocated. Call allocate() before accessing data.");
+    Q_ASSERT(p->d.data && "imagebuffer not allocated. Call allocate() before accessing data.");
     Q_ASSERT(p->d.packing == Packing::Interleaved);
+    detach();
+    p->detachData();
 
     QPoint pixel = pos - p->d.dataWindow.topLeft();
     size_t offset = size_t(pixel.y()) * strideSize() + size_t(pixel.x()) * pixelSize();
 
-    Q_ASSERT(offset < static_cast<size_t>(p->d.data.size()));
-    return reinterpret_cast<quint8*>(p->d.data.data()) + offset;
+    Q_ASSERT(offset < p->d.dataSize);
+    return p->d.data.get() + offset;
+}
+
+const quint8*
+ImageBuffer::constData() const
+{
+    Q_ASSERT(p->d.data && "imagebuffer not allocated. Call allocate() before accessing data.");
+    return p->d.data.get();
 }
 
 int
@@ -620,43 +1893,34 @@ ImageBuffer::planeByteSize(int plane) const
 }
 
 quint8*
-ImageBuffer::planeData(int plane) const
+ImageBuffer::planeData(int plane)
 {
-    Q_ASSERT(!p->d.data.isEmpty() && "imagebuffer not allocated. Call allocate() before accessing data.");
+    Q_ASSERT(p->d.data && "imagebuffer not allocated. Call allocate() before accessing data.");
 
     Q_ASSERT(plane >= 0 && plane < planeCount()
              && "planeData/planeStride: plane index out of range. Valid range is [0, planeCount()).");
 
-    quint8* base = reinterpret_cast<quint8*>(p->d.data.data());
-
-    switch (p->d.packing) {
-    case Packing::Interleaved:
-    case Packing::Packed: return base;
-
-    case Packing::Planar: {
-        size_t planeSize = size_t(p->d.dataWindow.width()) * size_t(p->d.dataWindow.height()) * p->d.format.size();
-        return base + size_t(plane) * planeSize;
-    }
+    detach();
+    p->detachData();
+    return p->d.data.get() + p->planeOffset(plane);
+}
 
-    case Packing::BiPlanar: {
-        if (plane == 0)
-            return base;
+const quint8*
+ImageBuffer::constPlaneData(int plane) const
+{
+    Q_ASSERT(p->d.data && "imagebuffer not allocated. Call allocate() before accessing data.");
 
-        size_t yPlaneSize = size_t(p->d.dataWindow.width()) * size_t(p->d.dataWindow.height()) * p->d.format.size();
-        return base + yPlaneSize;
-    }
-    }
+    Q_ASSERT(plane >= 0 && plane < planeCount()
+             && "planeData/planeStride: plane index out of range. Valid range is [0, planeCount()).");
 
-    return nullptr;
+    return p->d.data.get() + p->planeOffset(plane);
 }
 
 ImageBuffer
 ImageBuffer::detach()
 {
-    if (p->ref.loadRelaxed() > 1) {
+    if (p->ref.loadRelaxed() > 1)
         p.detach();
-        p->d.data = QByteArray(p->d.data);
-    }
 
     return *this;
 }
@@ -664,7 +1928,7 @@ ImageBuffer::detach()
 bool
 ImageBuffer::isAllocated() const
 {
-    return !p->d.data.isEmpty();
+    return p->d.data != nullptr;
 }
 
 bool
@@ -730,33 +1994,9 @@ ImageBuffer::convert(const ImageBuffer& imagebuffer, ImageFormat::Type type, int
     copy.setTransferFunction(imagebuffer.transferFunction());
     copy.allocate();
 
-    const quint8* src = imagebuffer.data();
-    quint8* dst = copy.data();
-
-    for (int y = 0; y < imagebuffer.dataWindow().height(); ++y) {
-        const quint8* from = src + size_t(y) * imagebuffer.strideSize();
-        quint8* to = dst + size_t(y) * copy.strideSize();
-
-        for (int x = 0; x < imagebuffer.dataWindow().width(); ++x) {
-            const int copyChannels = std::min(imagebuffer.channels(), copy.channels());
-
-            ImageBufferPrivate::convert(imagebuffer.imageFormat(), from, copy.imageFormat(), to, copyChannels);
-
-            if (copy.channels() > imagebuffer.channels()) {
-                dispatchByFormat(copy.imageFormat().type(), [&](auto tag) {
-                    using D = decltype(tag);
-                    D* dstPixel = reinterpret_cast<D*>(to);
-
-                    for (int c = copyChannels; c < copy.channels(); ++c)
-                        dstPixel[c] = std::numeric_limits<D>::is_integer ? std::numeric_limits<D>::max() : D(1);
-                });
-            }
-
-            from += imagebuffer.pixelSize();
-            to += copy.pixelSize();
-        }
-    }
-
+    quint8 order[4];
+    ImageBufferPrivate::channelOrder(imagebuffer.pixelLayout(), copy.pixelLayout(), order);
+    ImageBufferPrivate::convert(imagebuffer, copy, order);
     return copy;
 }
 
@@ -778,9 +2018,6 @@ ImageBuffer::convert(const ImageBuffer& imageBuffer, int channels)
     if (imageBuffer.channels() == channels)
         return imageBuffer;
 
-    const int width = imageBuffer.dataWindow().width();
-    const int height = imageBuffer.dataWindow().height();
-
     ImageBuffer dst(imageBuffer.dataWindow(), imageBuffer.displayWindow(), imageBuffer.imageFormat(), channels);
     dst.setPacking(imageBuffer.packing());
     dst.setSubsampling(imageBuffer.subsampling());
@@ -790,227 +2027,114 @@ ImageBuffer::convert(const ImageBuffer& imageBuffer, int channels)
     dst.setTransferFunction(imageBuffer.transferFunction());
     dst.allocate();
 
-    const int srcChannels = imageBuffer.channels();
-    const auto type = imageBuffer.imageFormat().type();
-
-    const quint8* srcBase = imageBuffer.data();
-    quint8* dstBase = dst.data();
-
-    if (srcChannels == 3 && channels == 4) {
-        if (type == ImageFormat::UInt8) {
-#if defined(__ARM_NEON)
-            for (int y = 0; y < height; ++y) {
-                const uint8_t* s = reinterpret_cast<const uint8_t*>(srcBase + y * imageBuffer.strideSize());
-                uint8_t* d = reinterpret_cast<uint8_t*>(dstBase + y * dst.strideSize());
-
-                int x = 0;
-                const uint8x16_t alpha = vdupq_n_u8(255);
-
-                for (; x + 16 <= width; x += 16) {
-                    uint8x16x3_t rgb = vld3q_u8(s);
-                    uint8x16x4_t rgba;
-                    rgba.val[0] = rgb.val[0];
-                    rgba.val[1] = rgb.val[1];
-                    rgba.val[2] = rgb.val[2];
-                    rgba.val[3] = alpha;
-                    vst4q_u8(d, rgba);
-
-                    s += 16 * 3;
-                    d += 16 * 4;
-                }
-
-                for (; x < width; ++x) {
-                    d[0] = s[0];
-                    d[1] = s[1];
-                    d[2] = s[2];
-                    d[3] = 255;
-                    s += 3;
-                    d += 4;
-                }
-            }
-#else
-            for (int y = 0; y < height; ++y) {
-                const uint8_t* s = reinterpret_cast<const uint8_t*>(srcBase + y * imageBuffer.strideSize());
-                uint8_t* d = reinterpret_cast<uint8_t*>(dstBase + y * dst.strideSize());
-
-                for (int x = 0; x < width; ++x) {
-                    d[0] = s[0];
-                    d[1] = s[1];
-                    d[2] = s[2];
-                    d[3] = 255;
-                    s += 3;
-                    d += 4;
-                }
-            }
-#endif
-            return dst;
-        }
+    quint8 order[4];
+    ImageBufferPrivate::channelOrder(imageBuffer.pixelLayout(), dst.pixelLayout(), order);
+    ImageBufferPrivate::convert(imageBuffer, dst, order);
+    return dst;
+}
 
-        if (type == ImageFormat::Half) {
-            static_assert(sizeof(half) == sizeof(uint16_t), "OIIO::half must be 16-bit");
+ImageBuffer
+ImageBuffer::convert(const ImageBuffer& imageBuffer, PixelLayout pixelLayout)
+{
+    Q_ASSERT(!imageBuffer.requiresDecode()
+             && "imagebuffer::convert only supports native RGB-like interleaved images. "
+                "YCbCr, planar, biplanar, and packed formats must be decoded first.");
 
-            const half alphaHalf = half(1.0f);
-            uint16_t alphaBits = 0;
-            std::memcpy(&alphaBits, &alphaHalf, sizeof(alphaBits));
+    Q_ASSERT(imageBuffer.isRgb() && "ImageBuffer::convert only supports RGB-like image layouts.");
 
-#if defined(__ARM_NEON)
-            for (int y = 0; y < height; ++y) {
-                const uint16_t* s = reinterpret_cast<const uint16_t*>(srcBase + y * imageBuffer.strideSize());
-                uint16_t* d = reinterpret_cast<uint16_t*>(dstBase + y * dst.strideSize());
-
-                int x = 0;
-                const uint16x8_t alpha = vdupq_n_u16(alphaBits);
-
-                for (; x + 8 <= width; x += 8) {
-                    uint16x8x3_t rgb = vld3q_u16(s);
-                    uint16x8x4_t rgba;
-                    rgba.val[0] = rgb.val[0];
-                    rgba.val[1] = rgb.val[1];
-                    rgba.val[2] = rgb.val[2];
-                    rgba.val[3] = alpha;
-                    vst4q_u16(d, rgba);
-
-                    s += 8 * 3;
-                    d += 8 * 4;
-                }
+    Q_ASSERT((pixelLayout == PixelLayout::RGB || pixelLayout == PixelLayout::BGR || pixelLayout == PixelLayout::RGBA
+              || pixelLayout == PixelLayout::BGRA)
+             && "imagebuffer::convert only supports RGB-like target layouts.");
 
-                for (; x < width; ++x) {
-                    d[0] = s[0];
-                    d[1] = s[1];
-                    d[2] = s[2];
-                    d[3] = alphaBits;
-                    s += 3;
-                    d += 4;
-                }
-            }
-#else
-            for (int y = 0; y < height; ++y) {
-                const half* s = reinterpret_cast<const half*>(srcBase + y * imageBuffer.strideSize());
-                half* d = reinterpret_cast<half*>(dstBase + y * dst.strideSize());
-
-                for (int x = 0; x < width; ++x) {
-                    d[0] = s[0];
-                    d[1] = s[1];
-                    d[2] = s[2];
-                    d[3] = alphaHalf;
-                    s += 3;
-                    d += 4;
-                }
-            }
-#endif
-            return dst;
-        }
+    if (imageBuffer.pixelLayout() == pixelLayout)
+        return imageBuffer;
 
-        if (type == ImageFormat::Float) {
-#if defined(__ARM_NEON)
-            for (int y = 0; y < height; ++y) {
-                const float* s = reinterpret_cast<const float*>(srcBase + y * imageBuffer.strideSize());
-                float* d = reinterpret_cast<float*>(dstBase + y * dst.strideSize());
-
-                int x = 0;
-                const float32x4_t alpha = vdupq_n_f32(1.0f);
-
-                for (; x + 4 <= width; x += 4) {
-                    float32x4x3_t rgb = vld3q_f32(s);
-                    float32x4x4_t rgba;
-                    rgba.val[0] = rgb.val[0];
-                    rgba.val[1] = rgb.val[1];
-                    rgba.val[2] = rgb.val[2];
-                    rgba.val[3] = alpha;
-                    vst4q_f32(d, rgba);
-
-                    s += 4 * 3;
-                    d += 4 * 4;
-                }
+    const int channels = (pixelLayout == PixelLayout::RGBA || pixelLayout == PixelLayout::BGRA) ? 4 : 3;
 
-                for (; x < width; ++x) {
-                    d[0] = s[0];
-                    d[1] = s[1];
-                    d[2] = s[2];
-                    d[3] = 1.0f;
-                    s += 3;
-                    d += 4;
-                }
-            }
-#else
-            for (int y = 0; y < height; ++y) {
-                const float* s = reinterpret_cast<const float*>(srcBase + y * imageBuffer.strideSize());
-                float* d = reinterpret_cast<float*>(dstBase + y * dst.strideSize());
-
-                for (int x = 0; x < width; ++x) {
-                    d[0] = s[0];
-                    d[1] = s[1];
-                    d[2] = s[2];
-                    d[3] = 1.0f;
-                    s += 3;
-                    d += 4;
-                }
-            }
-#endif
-            return dst;
-        }
-    }
+    ImageBuffer dst(imageBuffer.dataWindow(), imageBuffer.displayWindow(), imageBuffer.imageFormat(), channels);
+    dst.setPacking(imageBuffer.packing());
+    dst.setSubsampling(imageBuffer.subsampling());
+    dst.setPixelLayout(pixelLayout);
+    dst.setPixelRange(imageBuffer.pixelRange());
+    dst.setColorSpace(imageBuffer.colorSpace());
+    dst.setTransferFunction(imageBuffer.transferFunction());
+    dst.allocate();
 
-    if (type == ImageFormat::UInt8) {
-        for (int y = 0; y < height; ++y) {
-            const uint8_t* s = reinterpret_cast<const uint8_t*>(srcBase + y * imageBuffer.strideSize());
-            uint8_t* d = reinterpret_cast<uint8_t*>(dstBase + y * dst.strideSize());
+    quint8 order[4];
+    ImageBufferPrivate::channelOrder(imageBuffer.pixelLayout(), pixelLayout, order);
+    ImageBufferPrivate::convert(imageBuffer, dst, order);
+    return dst;
+}
 
-            for (int x = 0; x < width; ++x) {
-                for (int c = 0; c < std::min(srcChannels, channels); ++c)
-                    d[c] = s[c];
+ImageBuffer
+ImageBuffer::decode(const ImageBuffer& imageBuffer, ImageFormat::Type type)
+{
+    Q_ASSERT(imageBuffer.isYCbCr() && "imagebuffer::decode only supports YCbCr pixel layouts.");
 
-                for (int c = srcChannels; c < channels; ++c)
-                    d[c] = 255;
+    Q_ASSERT(!imageBuffer.dataWindow().isEmpty() && "imagebuffer::decode requires a non-empty data window.");
 
-                s += srcChannels;
-                d += channels;
-            }
-        }
-        return dst;
+    // v210 rows are described in bytes, the pixel width comes from the
+    // display window and is limited to what the row can hold.
+    QRect dataWindow = imageBuffer.dataWindow();
+    if (imageBuffer.pixelLayout() == PixelLayout::V210) {
+        const int width = qMin(imageBuffer.displayWindow().width(), dataWindow.width() / 16 * 6);
+        dataWindow.setWidth(width);
     }
 
-    if (type == ImageFormat::Half) {
-        const half alpha = half(1.0f);
-        for (int y = 0; y < height; ++y) {
-            const half* s = reinterpret_cast<const half*>(srcBase + y * imageBuffer.strideSize());
-            half* d = reinterpret_cast<half*>(dstBase + y * dst.strideSize());
-
-            for (int x = 0; x < width; ++x) {
-                for (int c = 0; c < std::min(srcChannels, channels); ++c)
-                    d[c] = s[c];
+    ImageBuffer dst(dataWindow, imageBuffer.displayWindow(), type, 4);
+    dst.setPixelLayout(PixelLayout::RGBA);
+    dst.setPixelRange(PixelRange::Full);
+    dst.setColorSpace(imageBuffer.colorSpace());
+    dst.setTransferFunction(imageBuffer.transferFunction());
+    dst.allocate();
 
-                for (int c = srcChannels; c < channels; ++c)
-                    d[c] = alpha;
+    ImageBufferPrivate::decode(imageBuffer, dst);
+    return dst;
+}
 
-                s += srcChannels;
-                d += channels;
-            }
-        }
-        return dst;
+ImageBuffer
+ImageBuffer::encode(const ImageBuffer& imageBuffer, PixelLayout pixelLayout, ChromaFilter chromaFilter)
+{
+    Q_ASSERT(imageBuffer.isRgb() && imageBuffer.p->d.packing == Packing::Interleaved
+             && "imagebuffer::encode only supports interleaved RGB-like images.");
+
+    Q_ASSERT((pixelLayout == PixelLayout::UYVY || pixelLayout == PixelLayout::V210)
+             && "imagebuffer::encode only supports UYVY and V210 target layouts.");
+
+    // v210 rows hold groups of six pixels in 16 bytes padded to 128 bytes,
+    // the data window width is the row size in bytes like the readers use.
+    const QRect dataWindow = imageBuffer.dataWindow();
+    ImageBuffer dst;
+    if (pixelLayout == PixelLayout::V210) {
+        QRect rowWindow = dataWindow;
+        rowWindow.setWidth((dataWindow.width() + 47) / 48 * 128);
+        dst = ImageBuffer(rowWindow, imageBuffer.displayWindow(), ImageFormat::UInt8, 1);
     }
+    else {
+        dst = ImageBuffer(dataWindow, imageBuffer.displayWindow(), ImageFormat::UInt8, 2);
+    }
+    dst.setPacking(Packing::Packed);
+    dst.setSubsampling(Subsampling::CS422);
+    dst.setPixelLayout(pixelLayout);
+    dst.setPixelRange(PixelRange::Video);
+    dst.setColorSpace(imageBuffer.colorSpace());
+    dst.setTransferFunction(imageBuffer.transferFunction());
+    dst.allocate();
 
-    if (type == ImageFormat::Float) {
-        const float alpha = 1.0f;
-        for (int y = 0; y < height; ++y) {
-            const float* s = reinterpret_cast<const float*>(srcBase + y * imageBuffer.strideSize());
-            float* d = reinterpret_cast<float*>(dstBase + y * dst.strideSize());
-
-            for (int x = 0; x < width; ++x) {
-                for (int c = 0; c < std::min(srcChannels, channels); ++c)
-                    d[c] = s[c];
+    ImageBufferPrivate::encode(imageBuffer, dst, chromaFilter);
+    return dst;
+}
 
-                for (int c = srcChannels; c < channels; ++c)
-                    d[c] = alpha;
+qint64
+ImageBuffer::convertTileSize()
+{
+    return ImageBufferPrivate::tileSize.load();
+}
 
-                s += srcChannels;
-                d += channels;
-            }
-        }
-        return dst;
-    }
-    Q_ASSERT(false && "ImageBuffer::convert unsupported image format");
-    return {};
+void
+ImageBuffer::setConvertTileSize(qint64 bytes)
+{
+    ImageBufferPrivate::tileSize.store(qMax<qint64>(1, bytes));
 }
 
 }  // namespace flipman::sdk::core
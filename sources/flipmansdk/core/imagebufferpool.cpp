@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/core/imagebufferpool.h>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+#include <cstdlib>
+
+#if defined(Q_OS_LINUX)
+#    include <sys/mman.h>
+#endif
+#if defined(Q_OS_WIN)
+#    include <malloc.h>
+#endif
+
+namespace flipman::sdk::core {
+
+namespace {
+    constexpr size_t cacheLine = 64;
+    constexpr size_t pageSize = 4096;
+    constexpr size_t pageThreshold = 64 * 1024;
+    constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    quint8* alignedAlloc(size_t alignment, size_t size)
+    {
+#if defined(Q_OS_WIN)
+        return static_cast<quint8*>(_aligned_malloc(size, alignment));
+#else
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, alignment, size) != 0)
+            return nullptr;
+        return static_cast<quint8*>(ptr);
+#endif
+    }
+
+    void alignedFree(quint8* ptr)
+    {
+#if defined(Q_OS_WIN)
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}  // namespace
+
+class ImageBufferPoolPrivate {
+public:
+    ~ImageBufferPoolPrivate();
+    quint8* acquire(size_t size);
+    void release(quint8* block, size_t size);
+    void trim();
+    struct Data {
+        mutable QMutex mutex;
+        QHash<size_t, QList<quint8*>> blocks;
+        qint64 capacity = qint64(1) << 30;  // 1 GiB
+        bool hugePages = false;
+        ImageBufferPool::Stats stats;
+    };
+    Data d;
+};
+
+ImageBufferPoolPrivate::~ImageBufferPoolPrivate() { trim(); }
+
+quint8*
+ImageBufferPoolPrivate::acquire(size_t size)
+{
+    {
+        QMutexLocker locker(&d.mutex);
+        auto it = d.blocks.find(size);
+        if (it != d.blocks.end() && !it->isEmpty()) {
+            quint8* block = it->takeLast();
+            d.stats.reuses++;
+            d.stats.pooledBlocks--;
+            d.stats.pooledBytes -= qint64(size);
+            d.stats.usedBlocks++;
+            d.stats.usedBytes += qint64(size);
+            return block;
+        }
+    }
+
+    bool hugePages = false;
+    {
+        QMutexLocker locker(&d.mutex);
+        hugePages = d.hugePages;
+    }
+
+    // heap allocation happens outside the lock, large frames take long
+    // enough to fault in that other threads should not wait on it.
+    size_t alignment = size >= pageThreshold ? pageSize : cacheLine;
+#if defined(Q_OS_LINUX)
+    if (hugePages && size >= hugePageSize)
+        alignment = hugePageSize;
+#endif
+    quint8* block = alignedAlloc(alignment, size);
+    if (!block)
+        return nullptr;
+
+#if defined(Q_OS_LINUX) && defined(MADV_HUGEPAGE)
+    if (alignment == hugePageSize)
+        madvise(block, size, MADV_HUGEPAGE);
+#else
+    Q_UNUSED(hugePages);
+#endif
+
+    QMutexLocker locker(&d.mutex);
+    d.stats.allocations++;
+    d.stats.usedBlocks++;
+    d.stats.usedBytes += qint64(size);
+    d.stats.peakBytes = qMax(d.stats.peakBytes, d.stats.usedBytes + d.stats.pooledBytes);
+    return block;
+}
+
+void
+ImageBufferPoolPrivate::release(quint8* block, size_t size)
+{
+    QMutexLocker locker(&d.mutex);
+    d.stats.usedBlocks--;
+    d.stats.usedBytes -= qint64(size);
+    if (d.stats.pooledBytes + qint64(size) <= d.capacity) {
+        d.blocks[size].append(block);
+        d.stats.pooledBlocks++;
+        d.stats.pooledBytes += qint64(size);
+        return;
+    }
+    d.stats.frees++;
+    locker.unlock();
+    alignedFree(block);
+}
+
+void
+ImageBufferPoolPrivate::trim()
+{
+    QHash<size_t, QList<quint8*>> blocks;
+    {
+        QMutexLocker locker(&d.mutex);
+        blocks.swap(d.blocks);
+        for (auto it = blocks.cbegin(); it != blocks.cend(); ++it)
+            d.stats.frees += it->size();
+        d.stats.pooledBlocks = 0;
+        d.stats.pooledBytes = 0;
+    }
+    for (const QList<quint8*>& list : blocks) {
+        for (quint8* block : list)
+            alignedFree(block);
+    }
+}
+
+ImageBufferPool::ImageBufferPool()
+    : p(new ImageBufferPoolPrivate())
+{}
+
+ImageBufferPool::~ImageBufferPool() {}
+
+std::shared_ptr<quint8>
+ImageBufferPool::allocate(size_t size)
+{
+    const size_t blockSize = sizeClass(size);
+    quint8* block = p->acquire(blockSize);
+    if (!block)
+        return std::shared_ptr<quint8>();
+
+    ImageBufferPoolPrivate* pool = p.data();
+    return std::shared_ptr<quint8>(block, [pool, blockSize](quint8* ptr) { pool->release(ptr, blockSize); });
+}
+
+void
+ImageBufferPool::trim()
+{
+    p->trim();
+}
+
+qint64
+ImageBufferPool::capacity() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.capacity;
+}
+
+void
+ImageBufferPool::setCapacity(qint64 bytes)
+{
+    {
+        QMutexLocker locker(&p->d.mutex);
+        p->d.capacity = qMax<qint64>(0, bytes);
+        if (p->d.stats.pooledBytes <= p->d.capacity)
+            return;
+    }
+    p->trim();
+}
+
+bool
+ImageBufferPool::hugePages() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.hugePages;
+}
+
+void
+ImageBufferPool::setHugePages(bool hugePages)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.hugePages = hugePages;
+}
+
+ImageBufferPool::Stats
+ImageBufferPool::stats() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.stats;
+}
+
+void
+ImageBufferPool::resetStats()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.stats.allocations = 0;
+    p->d.stats.reuses = 0;
+    p->d.stats.frees = 0;
+    p->d.stats.peakBytes = p->d.stats.usedBytes + p->d.stats.pooledBytes;
+}
+
+size_t
+ImageBufferPool::sizeClass(size_t size)
+{
+    // eight classes per power of two, rounding wastes at most 12.5% while
+    // frames of the same dimensions always land in the same class.
+    if (size <= cacheLine)
+        return cacheLine;
+
+    size_t power = cacheLine;
+    while (power < size)
+        power <<= 1;
+
+    const size_t step = qMax(cacheLine, power / 8);
+    return (size + step - 1) / step * step;
+}
+
+ImageBufferPool*
+ImageBufferPool::instance()
+{
+    // never destroyed, static caches holding buffers may be torn down after
+    // the pool and still need to hand their blocks back.
+    static ImageBufferPool* pool = new ImageBufferPool();
+    return pool;
+}
+
+}  // namespace flipman::sdk::core
@@ -4,110 +4,23 @@
 
 #include <flipmansdk/core/imageformat.h>
 
-namespace flipman::sdk::core {
-class ImageFormatPrivate : public QSharedData {
-public:
-    ImageFormatPrivate();
-    ~ImageFormatPrivate();
-    struct Data {
-        int typesize[ImageFormat::Double + 1];
-        ImageFormat::Type type;
-        Data()
-            : typesize {
-                0,
-                sizeof(quint8),
-                sizeof(qint8),
-                sizeof(quint16),
-                sizeof(qint16),
-                sizeof(quint32),
-                sizeof(qint32),
-                sizeof(quint64),
-                sizeof(qint64),
-                sizeof(float) / 2,
-                sizeof(float),
-                sizeof(double),
-            }
-        {}
-    };
-    Data d;
-};
-
-ImageFormatPrivate::ImageFormatPrivate() {}
-
-ImageFormatPrivate::~ImageFormatPrivate() {}
-
-ImageFormat::ImageFormat()
-    : p(new ImageFormatPrivate())
-{}
-
-ImageFormat::ImageFormat(ImageFormat::Type type)
-    : p(new ImageFormatPrivate())
-{
-    p->d.type = type;
-}
-
-ImageFormat::ImageFormat(const ImageFormat& other)
-    : p(other.p)
-{}
-
-ImageFormat::~ImageFormat() {}
+#include <type_traits>
 
-size_t
-ImageFormat::size() const
-{
-    Q_ASSERT("type index is out of bounds" && p->d.type >= 0 && p->d.type < ImageFormat::Double + 1);
-    return p->d.typesize[p->d.type];
-}
-
-ImageFormat::Type
-ImageFormat::type() const
-{
-    return p->d.type;
-}
-
-bool
-ImageFormat::isValid() const
-{
-    return p->d.type > 0;
-}
-
-void
-ImageFormat::reset()
-{
-    p.detach();
-    p->d.type = ImageFormat::Unknown;
-}
+namespace flipman::sdk::core {
 
-ImageFormat&
-ImageFormat::operator=(const ImageFormat& other)
-{
-    if (this != &other) {
-        p = other.p;
+namespace {
+    constexpr bool checkTraits()
+    {
+        for (int type = ImageFormat::Unknown; type <= ImageFormat::Double; ++type) {
+            if (ImageFormat::traits(ImageFormat::Type(type)).type != type)
+                return false;
+        }
+        return true;
     }
-    return *this;
-}
-
-bool
-ImageFormat::operator==(const ImageFormat& other) const
-{
-    return p->d.type == other.p->d.type;
-}
-
-bool
-ImageFormat::operator!=(const ImageFormat& other) const
-{
-    return !(*this == other);
-}
+}  // namespace
 
-bool
-ImageFormat::operator<(const ImageFormat& other) const
-{
-    return (p->d.type < other.p->d.type);
-}
+static_assert(checkTraits(), "image format traits must be indexed by type");
+static_assert(std::is_trivially_copyable_v<ImageFormat>, "image format must not allocate");
+static_assert(ImageFormat(ImageFormat::Half).size() == 2 && ImageFormat(ImageFormat::Double).size() == sizeof(double));
 
-bool
-ImageFormat::operator>(const ImageFormat& other) const
-{
-    return (p->d.type > other.p->d.type);
-}
 }  // namespace flipman::sdk::core
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/core/threadpool.h>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+
+namespace flipman::sdk::core {
+
+class ThreadPoolPrivate {
+public:
+    struct Work {
+        const std::function<void(qint64)>* fn = nullptr;
+        qint64 count = 0;
+        std::atomic<qint64> next { 0 };
+        qint64 done = 0;
+        QMutex mutex;
+        QWaitCondition finished;
+        void run();
+    };
+    struct Data {
+        QThreadPool threadPool;
+    };
+    Data d;
+};
+
+void
+ThreadPoolPrivate::Work::run()
+{
+    // indices are claimed one at a time, a worker that starts after all
+    // indices are claimed returns without touching the callable.
+    qint64 completed = 0;
+    for (qint64 index = next++; index < count; index = next++) {
+        (*fn)(index);
+        completed++;
+    }
+    if (completed > 0) {
+        QMutexLocker locker(&mutex);
+        done += completed;
+        if (done == count)
+            finished.wakeAll();
+    }
+}
+
+ThreadPool::ThreadPool()
+    : p(new ThreadPoolPrivate())
+{
+    p->d.threadPool.setMaxThreadCount(QThread::idealThreadCount());
+    p->d.threadPool.setObjectName("flipmansdk");
+}
+
+ThreadPool::~ThreadPool() { p->d.threadPool.waitForDone(); }
+
+int
+ThreadPool::maxThreadCount() const
+{
+    return p->d.threadPool.maxThreadCount();
+}
+
+void
+ThreadPool::setMaxThreadCount(int count)
+{
+    p->d.threadPool.setMaxThreadCount(qMax(1, count));
+}
+
+void
+ThreadPool::start(std::function<void()> task)
+{
+    p->d.threadPool.start(std::move(task));
+}
+
+void
+ThreadPool::parallelFor(qint64 count, const std::function<void(qint64 index)>& fn)
+{
+    if (count <= 0)
+        return;
+
+    const qint64 threads = qMin<qint64>(count, p->d.threadPool.maxThreadCount());
+    if (threads <= 1) {
+        for (qint64 index = 0; index < count; ++index)
+            fn(index);
+        return;
+    }
+
+    auto work = std::make_shared<ThreadPoolPrivate::Work>();
+    work->fn = &fn;
+    work->count = count;
+
+    for (qint64 i = 1; i < threads; ++i)
+        p->d.threadPool.start([work]() { work->run(); });
+
+    work->run();
+
+    QMutexLocker locker(&work->mutex);
+    while (work->done < work->count)
+        work->finished.wait(&work->mutex);
+}
+
+QThreadPool*
+ThreadPool::threadPool() const
+{
+    return &p->d.threadPool;
+}
+
+ThreadPool*
+ThreadPool::instance()
+{
+    static ThreadPool threadPool;
+    return &threadPool;
+}
+
+}  // namespace flipman::sdk::core
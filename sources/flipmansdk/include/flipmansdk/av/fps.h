@@ -5,38 +5,39 @@
 #pragma once
 
 #include <flipmansdk/flipmansdk.h>
-#include <QExplicitlySharedDataPointer>
 #include <QMetaType>
 
 namespace flipman::sdk::av {
 
-class FpsPrivate;
-
 /**
  * @class Fps
  * @brief Rational frame rate descriptor.
+ *
+ * A trivially copyable value type, copies never allocate.
  */
 class FLIPMANSDK_EXPORT Fps {
 public:
     /**
      * @brief Constructs an invalid Fps.
      */
-    Fps();
+    constexpr Fps() = default;
 
     /**
      * @brief Constructs an Fps from numerator and denominator.
      */
-    explicit Fps(qint32 numerator, qint32 denominator, bool drop_frame = false);
+    constexpr explicit Fps(qint32 numerator, qint32 denominator, bool drop_frame = false)
+        : d { numerator, denominator, drop_frame }
+    {}
 
     /**
      * @brief Copy constructor.
      */
-    Fps(const Fps& other);
+    constexpr Fps(const Fps& other) = default;
 
     /**
      * @brief Destroys the Fps.
      */
-    ~Fps();
+    ~Fps() = default;
 
     /** @name Status and Properties */
     ///@{
@@ -44,22 +45,22 @@ public:
     /**
      * @brief Returns true if drop-frame is enabled.
      */
-    bool dropFrame() const;
+    constexpr bool dropFrame() const { return d.dropFrame; }
 
     /**
      * @brief Returns the numerator.
      */
-    qint64 numerator() const;
+    constexpr qint64 numerator() const { return d.numerator; }
 
     /**
      * @brief Returns the denominator.
      */
-    qint32 denominator() const;
+    constexpr qint32 denominator() const { return d.denominator; }
 
     /**
      * @brief Returns true if valid.
      */
-    bool isValid() const;
+    constexpr bool isValid() const { return d.denominator > 0; }
 
     /**
      * @brief Resets to invalid state.
@@ -127,19 +128,23 @@ public:
     ///@{
 
     /**
-     * @brief Assignment operator. Performs a shallow copy.
+     * @brief Assignment operator.
      */
-    Fps& operator=(const Fps& other);
+    constexpr Fps& operator=(const Fps& other) = default;
 
     /**
      * @brief Equality operator.
      */
-    bool operator==(const Fps& other) const;
+    constexpr bool operator==(const Fps& other) const
+    {
+        return d.numerator == other.d.numerator && d.denominator == other.d.denominator
+               && d.dropFrame == other.d.dropFrame;
+    }
 
     /**
      * @brief Inequality operator.
      */
-    bool operator!=(const Fps& other) const;
+    constexpr bool operator!=(const Fps& other) const { return !(*this == other); }
 
     /**
      * @brief Strict ordering operator.
@@ -176,16 +181,16 @@ public:
      */
     static Fps guess(qreal fps);
 
-    static Fps fps23_976();
-    static Fps fps24();
-    static Fps fps25();
-    static Fps fps29_97();
-    static Fps fps30();
-    static Fps fps47_952();
-    static Fps fps48();
-    static Fps fps50();
-    static Fps fps59_94();
-    static Fps fps60();
+    static constexpr Fps fps23_976() { return Fps(24000, 1001, true); }
+    static constexpr Fps fps24() { return Fps(24, 1); }
+    static constexpr Fps fps25() { return Fps(25, 1); }
+    static constexpr Fps fps29_97() { return Fps(30000, 1001, true); }
+    static constexpr Fps fps30() { return Fps(30, 1); }
+    static constexpr Fps fps47_952() { return Fps(48000, 1001, true); }
+    static constexpr Fps fps48() { return Fps(48, 1); }
+    static constexpr Fps fps50() { return Fps(50, 1); }
+    static constexpr Fps fps59_94() { return Fps(60000, 1001, true); }
+    static constexpr Fps fps60() { return Fps(60, 1); }
 
     ///@}
 
@@ -195,7 +200,12 @@ public:
     static qint64 convert(quint64 value, const Fps& from, const Fps& to);
 
 private:
-    QExplicitlySharedDataPointer<FpsPrivate> p;
+    struct Data {
+        qint32 numerator = 0;
+        qint32 denominator = 0;
+        bool dropFrame = false;
+    };
+    Data d;
 };
 
 }  // namespace flipman::sdk::av
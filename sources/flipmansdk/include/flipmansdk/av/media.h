@@ -74,6 +74,9 @@ public:
 
     /**
      * @brief Reads the next frame.
+     *
+     * Frames are served from the global core::FrameCache when available,
+     * decoded frames are inserted into it.
      */
     Time read();
 
@@ -84,6 +87,8 @@ public:
 
     /**
      * @brief Seeks to a time range.
+     *
+     * Repositioning the reader is deferred while the frames read are cached.
      */
     Time seek(const TimeRange& range) const;
 
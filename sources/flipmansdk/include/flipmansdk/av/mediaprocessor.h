@@ -38,6 +38,12 @@ public:
 
     /**
      * @brief Writes a time range to a file.
+     *
+     * Frames are read on a reader thread, converted on the core::ThreadPool
+     * and committed in order on the calling thread, stages are connected by
+     * bounded queues. Writers that support concurrent writing also encode
+     * on the pool. progressChanged() is emitted on the calling thread for
+     * every committed frame.
      */
     bool write(Media& media, const TimeRange& timerange, const core::File& file);
 
@@ -7,23 +7,22 @@
 #include <flipmansdk/flipmansdk.h>
 #include <flipmansdk/av/fps.h>
 #include <flipmansdk/av/time.h>
-#include <QExplicitlySharedDataPointer>
 #include <QMetaType>
 
 namespace flipman::sdk::av {
 
-class SmpteTimePrivate;
-
 /**
  * @class SmpteTime
  * @brief SMPTE timecode descriptor.
+ *
+ * A trivially copyable value type, copies never allocate.
  */
 class FLIPMANSDK_EXPORT SmpteTime {
 public:
     /**
      * @brief Constructs an invalid SmpteTime.
      */
-    SmpteTime();
+    constexpr SmpteTime() = default;
 
     /**
      * @brief Constructs SmpteTime from Time.
@@ -33,12 +32,12 @@ public:
     /**
      * @brief Copy constructor.
      */
-    SmpteTime(const SmpteTime& other);
+    constexpr SmpteTime(const SmpteTime& other) = default;
 
     /**
      * @brief Destroys the SmpteTime.
      */
-    ~SmpteTime();
+    ~SmpteTime() = default;
 
     /** @name Timecode Components */
     ///@{
@@ -154,9 +153,9 @@ public:
     ///@{
 
     /**
-     * @brief Assignment operator. Performs a shallow copy.
+     * @brief Assignment operator.
      */
-    SmpteTime& operator=(const SmpteTime& other);
+    constexpr SmpteTime& operator=(const SmpteTime& other) = default;
 
     /**
      * @brief Equality operator.
@@ -216,7 +215,20 @@ public:
     ///@}
 
 private:
-    QExplicitlySharedDataPointer<SmpteTimePrivate> p;
+    void update();
+    struct Data {
+        Time time;
+        quint32 counter = 0;
+        qint16 hours = 0;
+        qint16 minutes = 0;
+        qint16 seconds = 0;
+        qint16 frames = 0;
+        qint16 subFrames = 1;
+        qint16 subFrameDivisor = 0;
+        bool negatives = true;
+        bool fullHours = true;
+    };
+    Data d;
 };
 
 }  // namespace flipman::sdk::av
@@ -6,16 +6,17 @@
 
 #include <flipmansdk/flipmansdk.h>
 #include <flipmansdk/av/fps.h>
-#include <QExplicitlySharedDataPointer>
 #include <QMetaType>
 
 namespace flipman::sdk::av {
 
-class TimePrivate;
-
 /**
  * @class Time
  * @brief Rational time descriptor.
+ *
+ * A trivially copyable value type, copies and arithmetic never allocate.
+ * Conversions between ticks and frames use exact integer rationals of the
+ * timescale and Fps.
  */
 class FLIPMANSDK_EXPORT Time {
 public:
@@ -25,34 +26,40 @@ public:
     /**
      * @brief Constructs an invalid Time.
      */
-    Time();
+    constexpr Time() = default;
 
     /**
      * @brief Constructs Time from ticks and timescale.
      */
-    explicit Time(qint64 ticks, qint32 timeScale, const Fps& fps);
+    constexpr explicit Time(qint64 ticks, qint32 timeScale, const Fps& fps)
+        : d { fps, ticks, timeScale }
+    {}
 
     /**
      * @brief Constructs Time from other with new ticks.
      */
-    Time(const Time& other, qint64 ticks);
+    constexpr Time(const Time& other, qint64 ticks)
+        : d { other.d.fps, ticks, other.d.timeScale }
+    {}
 
     /**
      * @brief Constructs Time from other with new Fps.
      */
-    Time(const Time& other, const Fps& fps);
+    constexpr Time(const Time& other, const Fps& fps)
+        : d { fps, other.d.ticks, other.d.timeScale }
+    {}
 
     /**
      * @brief Copy constructor.
      */
-    Time(const Time& other);
+    constexpr Time(const Time& other) = default;
 
     ///@}
 
     /**
      * @brief Destroys the Time.
      */
-    ~Time();
+    ~Time() = default;
 
     /** @name Status */
     ///@{
@@ -60,7 +67,7 @@ public:
     /**
      * @brief Returns true if valid.
      */
-    bool isValid() const;
+    constexpr bool isValid() const { return d.timeScale > 0; }
 
     /**
      * @brief Resets to invalid state.
@@ -75,20 +82,23 @@ public:
     /**
      * @brief Returns the associated Fps.
      */
-    Fps fps() const;
+    constexpr Fps fps() const { return d.fps; }
 
     /**
      * @brief Returns the tick count.
      */
-    qint64 ticks() const;
+    constexpr qint64 ticks() const { return d.ticks; }
 
     /**
      * @brief Returns the timescale.
      */
-    qint32 timeScale() const;
+    constexpr qint32 timeScale() const { return d.timeScale; }
 
     /**
      * @brief Returns ticks per frame.
+     *
+     * The step is rounded for rates that do not divide the timescale, such
+     * as 1001 rates, use ticks(frame) to convert frame offsets.
      */
     qint64 tpf() const;
 
@@ -150,17 +160,17 @@ public:
     /**
      * @brief Sets ticks.
      */
-    void setTicks(qint64 ticks);
+    constexpr void setTicks(qint64 ticks) { d.ticks = ticks; }
 
     /**
      * @brief Sets timescale.
      */
-    void setTimeScale(qint32 timeScale);
+    constexpr void setTimeScale(qint32 timeScale) { d.timeScale = timeScale; }
 
     /**
      * @brief Sets Fps.
      */
-    void setFps(const Fps& fps);
+    constexpr void setFps(const Fps& fps) { d.fps = fps; }
 
     ///@}
 
@@ -168,19 +178,22 @@ public:
     ///@{
 
     /**
-     * @brief Assignment operator. Performs a shallow copy.
+     * @brief Assignment operator.
      */
-    Time& operator=(const Time& other);
+    constexpr Time& operator=(const Time& other) = default;
 
     /**
      * @brief Equality operator.
      */
-    bool operator==(const Time& other) const;
+    constexpr bool operator==(const Time& other) const
+    {
+        return d.ticks == other.d.ticks && d.timeScale == other.d.timeScale && d.fps == other.d.fps;
+    }
 
     /**
      * @brief Inequality operator.
      */
-    bool operator!=(const Time& other) const;
+    constexpr bool operator!=(const Time& other) const { return !(*this == other); }
 
     /**
      * @brief Strict ordering operator.
@@ -254,7 +267,12 @@ public:
     ///@}
 
 private:
-    QExplicitlySharedDataPointer<TimePrivate> p;
+    struct Data {
+        Fps fps = Fps::fps24();
+        qint64 ticks = 0;
+        qint32 timeScale = 0;
+    };
+    Data d;
 };
 
 }  // namespace flipman::sdk::av
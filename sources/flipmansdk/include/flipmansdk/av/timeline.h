@@ -29,6 +29,20 @@ class FLIPMANSDK_EXPORT Timeline : public QObject {
     Q_PROPERTY(int height READ height WRITE setHeight NOTIFY heightChanged)
 
 public:
+    /**
+     * @struct Stats
+     * @brief Playback statistics.
+     *
+     * Presented frames are either on time or late, dropped frames were
+     * skipped because their presentation time had already passed.
+     */
+    struct Stats {
+        qint64 presented = 0;
+        qint64 onTime = 0;
+        qint64 late = 0;
+        qint64 dropped = 0;
+    };
+
     /**
      * @brief Constructs a Timeline.
      */
@@ -52,6 +66,11 @@ public:
      */
     bool loop() const;
 
+    /**
+     * @brief Returns true if every-frame mode is enabled.
+     */
+    bool everyFrame() const;
+
     /**
      * @brief Returns the width.
      */
@@ -112,6 +131,18 @@ public:
      */
     QList<Track*> tracks() const;
 
+    /**
+     * @brief Returns clips active at time across all tracks.
+     *
+     * Clips are returned in track order, then by start time.
+     */
+    QList<Clip*> clips(const Time& time) const;
+
+    /**
+     * @brief Returns clips intersecting range across all tracks.
+     */
+    QList<Clip*> clips(const TimeRange& range) const;
+
     ///@}
 
     /** @name Configuration */
@@ -127,6 +158,16 @@ public:
      */
     core::Error error() const;
 
+    /**
+     * @brief Returns playback statistics.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Resets playback statistics.
+     */
+    void resetStats();
+
     /**
      * @brief Resets to default state.
      */
@@ -175,6 +216,10 @@ public Q_SLOTS:
 
     /**
      * @brief Enables or disables every-frame mode.
+     *
+     * By default frames that are late for their presentation time are
+     * dropped to keep playback in sync. In every-frame mode each frame is
+     * read and presented in order, playback slows down instead.
      */
     void setEveryFrame(bool everyFrame);
 
@@ -184,17 +229,24 @@ public Q_SLOTS:
     void setLoop(bool loop);
 
     /**
-     * @brief Sets the thread count.
+     * @brief Sets the number of threads used to read clips.
      */
     void setThreadCount(int threadCount);
 
     /**
      * @brief Seeks to time.
+     *
+     * While playing, playback continues from @p time on the next frame.
+     * Otherwise the frame is read and presented on the calling thread.
      */
     void seek(const Time& time);
 
     /**
      * @brief Starts playback.
+     *
+     * Playback runs on a timeline thread, paced by av::Timer against the
+     * timeline Fps, with clips read in parallel on the timeline thread pool.
+     * Signals are emitted from the playback thread.
      */
     void play();
 
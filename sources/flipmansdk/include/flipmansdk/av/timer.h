@@ -16,6 +16,10 @@ class TimerPrivate;
 /**
  * @class Timer
  * @brief High-precision playback timer.
+ *
+ * Uses the monotonic system clock, mach absolute time on macOS and
+ * CLOCK_MONOTONIC elsewhere. Frame deadlines are kept as exact rationals
+ * of the Fps so fractional rates such as 23.976 do not drift.
  */
 class FLIPMANSDK_EXPORT Timer {
 public:
@@ -43,7 +47,7 @@ public:
     void start();
 
     /**
-     * @brief Starts the timer with Fps.
+     * @brief Starts frame pacing with Fps, the first deadline is one frame from now.
      */
     void start(const Fps& fps);
 
@@ -58,17 +62,23 @@ public:
     void restart();
 
     /**
-     * @brief Records a lap.
+     * @brief Records a lap, the time since the previous lap or start.
      */
     void lap();
 
     /**
-     * @brief Returns true if next frame interval reached.
+     * @brief Advances the deadline by one frame.
+     *
+     * Returns true if the new deadline is still ahead, false if the frame
+     * is already late. A change of Fps continues from the current deadline.
      */
     bool next(const Fps& fps);
 
     /**
-     * @brief Waits until next interval.
+     * @brief Waits until the current deadline.
+     *
+     * Sleeps on the absolute deadline and spins out the last half
+     * millisecond. The wake-up jitter in nanoseconds is recorded as a lap.
      */
     void wait();
 
@@ -88,7 +98,7 @@ public:
     quint64 elapsed() const;
 
     /**
-     * @brief Returns recorded laps.
+     * @brief Returns recorded laps and wait() jitter in nanoseconds.
      */
     QList<quint64> laps() const;
 
@@ -6,23 +6,22 @@
 
 #include <flipmansdk/flipmansdk.h>
 #include <flipmansdk/av/time.h>
-#include <QExplicitlySharedDataPointer>
 #include <QMetaType>
 
 namespace flipman::sdk::av {
 
-class TimeRangePrivate;
-
 /**
  * @class TimeRange
  * @brief Continuous time segment descriptor.
+ *
+ * A trivially copyable value type, copies never allocate.
  */
 class FLIPMANSDK_EXPORT TimeRange {
 public:
     /**
      * @brief Constructs an invalid TimeRange.
      */
-    TimeRange();
+    constexpr TimeRange() = default;
 
     /**
      * @brief Constructs TimeRange from start and duration.
@@ -32,12 +31,12 @@ public:
     /**
      * @brief Copy constructor.
      */
-    TimeRange(const TimeRange& other);
+    constexpr TimeRange(const TimeRange& other) = default;
 
     /**
      * @brief Destroys the TimeRange.
      */
-    ~TimeRange();
+    ~TimeRange() = default;
 
     /** @name Attributes */
     ///@{
@@ -45,22 +44,22 @@ public:
     /**
      * @brief Returns the start time.
      */
-    Time start() const;
+    constexpr Time start() const { return d.start; }
 
     /**
      * @brief Sets the start time.
      */
-    void setStart(Time start);
+    constexpr void setStart(Time start) { d.start = start; }
 
     /**
      * @brief Returns the duration.
      */
-    Time duration() const;
+    constexpr Time duration() const { return d.duration; }
 
     /**
      * @brief Sets the duration.
      */
-    void setDuration(Time duration);
+    constexpr void setDuration(Time duration) { d.duration = duration; }
 
     /**
      * @brief Returns the end time.
@@ -100,7 +99,10 @@ public:
     /**
      * @brief Returns true if valid.
      */
-    bool isValid() const;
+    constexpr bool isValid() const
+    {
+        return d.start.isValid() && d.duration.isValid() && d.duration.ticks() > 0;
+    }
 
     /**
      * @brief Resets to invalid state.
@@ -113,19 +115,22 @@ public:
     ///@{
 
     /**
-     * @brief Assignment operator. Performs a shallow copy.
+     * @brief Assignment operator.
      */
-    TimeRange& operator=(const TimeRange& other);
+    constexpr TimeRange& operator=(const TimeRange& other) = default;
 
     /**
      * @brief Equality operator.
      */
-    bool operator==(const TimeRange& other) const;
+    constexpr bool operator==(const TimeRange& other) const
+    {
+        return d.start == other.d.start && d.duration == other.d.duration;
+    }
 
     /**
      * @brief Inequality operator.
      */
-    bool operator!=(const TimeRange& other) const;
+    constexpr bool operator!=(const TimeRange& other) const { return !(*this == other); }
 
     ///@}
 
@@ -149,7 +154,11 @@ public:
     ///@}
 
 private:
-    QExplicitlySharedDataPointer<TimeRangePrivate> p;
+    struct Data {
+        Time start;
+        Time duration;
+    };
+    Data d;
 };
 
 }  // namespace flipman::sdk::av
@@ -59,10 +59,22 @@ public:
     TimeRange clipRange(Clip* clip) const;
 
     /**
-     * @brief Returns all clips.
+     * @brief Returns all clips ordered by start time.
      */
     QList<Clip*> clips() const;
 
+    /**
+     * @brief Returns clips active at time, ordered by start time.
+     *
+     * Lookups use an interval index and run in O(log n + k).
+     */
+    QList<Clip*> clips(const Time& time) const;
+
+    /**
+     * @brief Returns clips intersecting range, ordered by start time.
+     */
+    QList<Clip*> clips(const TimeRange& range) const;
+
     /**
      * @brief Returns true if clip exists.
      */
@@ -100,7 +112,7 @@ public Q_SLOTS:
     void setColor(const QColor& color);
 
     /**
-     * @brief Inserts a clip.
+     * @brief Inserts a clip, or moves it if already on the track.
      */
     void insertClip(Clip* clip, const TimeRange& range);
 
@@ -7,6 +7,7 @@
 #include <flipmansdk/core/file.h>
 #include <flipmansdk/flipmansdk.h>
 #include <QExplicitlySharedDataPointer>
+#include <QList>
 #include <QMetaType>
 
 namespace flipman::sdk::core {
@@ -16,6 +17,10 @@ class FileRangePrivate;
 /**
  * @class FileRange
  * @brief Explicitly shared frame-to-file mapping.
+ *
+ * Stores a numbered file sequence as a pattern, padding, first and last
+ * frame, a step and a bitmap of missing frames. Frame paths are formatted
+ * on request, no per-frame file information is kept.
  */
 class FLIPMANSDK_EXPORT FileRange {
 public:
@@ -24,6 +29,14 @@ public:
      */
     FileRange();
 
+    /**
+     * @brief Constructs a FileRange from a pattern and frames.
+     *
+     * The pattern marks the frame number with '#', one per padded digit,
+     * for example "/shots/plate.####.exr".
+     */
+    FileRange(const QString& pattern, qint64 first, qint64 last, qint64 step = 1);
+
     /**
      * @brief Copy constructor.
      */
@@ -47,6 +60,11 @@ public:
      */
     File frame(qint64 frame) const;
 
+    /**
+     * @brief Returns the file path of a frame without touching the file system.
+     */
+    QString filePath(qint64 frame) const;
+
     /**
      * @brief Returns the first frame index.
      */
@@ -57,11 +75,31 @@ public:
      */
     qint64 end() const;
 
+    /**
+     * @brief Returns the frame step.
+     */
+    qint64 step() const;
+
     /**
      * @brief Returns the number of mapped frames.
      */
     qint64 size() const;
 
+    /**
+     * @brief Returns frames missing between start and end.
+     */
+    QList<qint64> holes() const;
+
+    /**
+     * @brief Returns the pattern with '#' for the frame number.
+     */
+    QString pattern() const;
+
+    /**
+     * @brief Returns the frame number padding.
+     */
+    int padding() const;
+
     ///@}
 
     /** @name Management */
@@ -79,9 +117,24 @@ public:
 
     /**
      * @brief Inserts a frame-to-file mapping.
+     *
+     * The first insert sets the pattern from the file name, later files
+     * are expected to follow it.
      */
     void insertFrame(qint64 frame, const File& file);
 
+    /**
+     * @brief Inserts a frame following the pattern.
+     *
+     * Frames between the current range and @p frame are marked missing.
+     */
+    void insertFrame(qint64 frame);
+
+    /**
+     * @brief Marks a frame as missing.
+     */
+    void removeFrame(qint64 frame);
+
     ///@}
 
     /** @name Operators */
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#pragma once
+
+#include <flipmansdk/core/error.h>
+#include <flipmansdk/core/file.h>
+#include <flipmansdk/flipmansdk.h>
+#include <QList>
+#include <QScopedPointer>
+#include <QStringList>
+
+namespace flipman::sdk::core {
+
+class FileScannerPrivate;
+
+/**
+ * @class FileScanner
+ * @brief Directory scanner that groups frame sequences in one pass.
+ *
+ * Reads directory entries straight from the file system and splits each
+ * name at its last run of digits, the frame number. Names that share
+ * prefix, padding and suffix are grouped into a FileRange without creating
+ * a QFileInfo per entry.
+ *
+ * Hidden files are skipped and results are sorted by file name.
+ */
+class FLIPMANSDK_EXPORT FileScanner {
+public:
+    /**
+     * @brief Constructs a FileScanner with ranges enabled.
+     */
+    FileScanner();
+
+    /**
+     * @brief Destroys the FileScanner.
+     */
+    ~FileScanner();
+
+    /**
+     * @brief Returns the name filters.
+     */
+    QStringList nameFilters() const;
+
+    /**
+     * @brief Sets wildcard name filters, matched case-insensitively.
+     *
+     * An empty list or "*" matches every file.
+     */
+    void setNameFilters(const QStringList& nameFilters);
+
+    /**
+     * @brief Returns true if sequences are grouped into ranges.
+     */
+    bool ranges() const;
+
+    /**
+     * @brief Enables grouping of sequences into ranges.
+     */
+    void setRanges(bool ranges);
+
+    /**
+     * @brief Returns true if missing frames are kept inside one range.
+     */
+    bool holes() const;
+
+    /**
+     * @brief Keeps missing frames as holes instead of splitting ranges.
+     *
+     * When disabled, each run of consecutive frames becomes its own File.
+     */
+    void setHoles(bool holes);
+
+    /**
+     * @brief Returns true if subdirectories are scanned.
+     */
+    bool recursive() const;
+
+    /**
+     * @brief Scans subdirectories, hidden and linked directories are skipped.
+     *
+     * Directories are read by a bounded set of workers on the core thread
+     * pool, idle workers steal queued directories from busy ones.
+     */
+    void setRecursive(bool recursive);
+
+    /**
+     * @brief Scans a directory.
+     *
+     * @return Files and sequences in the directory.
+     */
+    QList<File> scan(const QString& path);
+
+    /**
+     * @brief Scans directories in parallel on the core thread pool.
+     *
+     * @return Files and sequences, in the order of @p paths, subdirectories
+     *         sorted by path.
+     */
+    QList<File> scan(const QStringList& paths);
+
+    /**
+     * @brief Returns the first error of the last scan.
+     */
+    Error error() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(FileScanner)
+    QScopedPointer<FileScannerPrivate> p;
+};
+
+}  // namespace flipman::sdk::core
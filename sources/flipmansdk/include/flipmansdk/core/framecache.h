@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#pragma once
+
+#include <flipmansdk/flipmansdk.h>
+#include <flipmansdk/core/imagebuffer.h>
+#include <QScopedPointer>
+#include <QString>
+
+namespace flipman::sdk::core {
+
+class FrameCachePrivate;
+
+/**
+ * @class FrameCache
+ * @brief Process-wide, memory-budgeted cache of decoded frames.
+ *
+ * Stores ImageBuffer payloads keyed by media identity and frame index.
+ * When resident bytes exceed the budget, frames are evicted using a clock
+ * (second chance) policy, frames read since the last sweep are kept.
+ *
+ * All methods are thread-safe.
+ */
+class FLIPMANSDK_EXPORT FrameCache {
+public:
+    /**
+     * @struct Stats
+     * @brief Cache counters.
+     */
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+        qint64 frames = 0;
+        qint64 residentBytes = 0;
+        qint64 budgetBytes = 0;
+    };
+
+    /**
+     * @brief Constructs an empty FrameCache.
+     */
+    FrameCache();
+
+    /**
+     * @brief Destroys the FrameCache.
+     */
+    ~FrameCache();
+
+    /**
+     * @brief Looks up a frame.
+     *
+     * @param key Media identity, typically the media file path.
+     * @param frame Frame index.
+     * @param image Receives the cached image on a hit.
+     *
+     * @return True if the frame was cached.
+     */
+    bool find(const QString& key, qint64 frame, ImageBuffer& image);
+
+    /**
+     * @brief Returns true if a frame is cached, does not count as an access.
+     */
+    bool contains(const QString& key, qint64 frame) const;
+
+    /**
+     * @brief Inserts or replaces a frame.
+     *
+     * Images larger than the budget are not cached.
+     */
+    void insert(const QString& key, qint64 frame, const ImageBuffer& image);
+
+    /**
+     * @brief Removes all frames for a media identity.
+     */
+    void remove(const QString& key);
+
+    /**
+     * @brief Removes all frames.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the budget in bytes.
+     */
+    qint64 budget() const;
+
+    /**
+     * @brief Sets the budget in bytes, evicts frames if needed.
+     */
+    void setBudget(qint64 bytes);
+
+    /**
+     * @brief Returns a snapshot of the cache counters.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Resets hit, miss and eviction counters.
+     */
+    void resetStats();
+
+    /**
+     * @brief Returns the global FrameCache instance.
+     */
+    static FrameCache* instance();
+
+private:
+    Q_DISABLE_COPY_MOVE(FrameCache)
+    QScopedPointer<FrameCachePrivate> p;
+};
+
+/**
+ * @brief Returns the global FrameCache instance.
+ */
+inline FrameCache*
+frameCache()
+{
+    return FrameCache::instance();
+}
+
+}  // namespace flipman::sdk::core
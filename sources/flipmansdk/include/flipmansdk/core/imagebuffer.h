@@ -14,6 +14,7 @@
 
 namespace flipman::sdk::core {
 
+class ImageBufferPool;
 class ImageBufferPrivate;
 
 /**
@@ -56,6 +57,16 @@ public:
     enum class PixelRange { Unknown, Full, Video };
     Q_ENUM(PixelRange)
 
+    /**
+     * @brief Horizontal chroma filter used when encoding to 4:2:2.
+     *
+     * Average takes the mean of each pixel pair, centred between the two
+     * pixels. Cosited applies a 1-2-1 filter centred on the first pixel of
+     * each pair, as expected by SDI and most broadcast formats.
+     */
+    enum class ChromaFilter { Average, Cosited };
+    Q_ENUM(ChromaFilter)
+
     /**
      * @brief Constructs an empty ImageBuffer.
      */
@@ -84,8 +95,12 @@ public:
      *
      * Must be called after setting format, packing, and subsampling,
      * and before accessing pixel data. Reallocates if already allocated.
+     * Storage is recycled through @p pool, the global ImageBufferPool if
+     * null, and is not zero-initialized.
+     *
+     * @param pool Optional allocator, must outlive the buffer storage.
      */
-    void allocate();
+    void allocate(ImageBufferPool* pool = nullptr);
 
     /** @name Windows */
     ///@{
@@ -239,14 +254,25 @@ public:
     ///@{
 
     /**
-     * @brief Returns pointer to raw data.
+     * @brief Returns pointer to raw data for writing.
+     *
+     * Detaches this buffer from its copies, pixels still shared with
+     * another buffer are copied first. Use constData() for reading.
      */
-    quint8* data() const;
+    quint8* data();
 
     /**
-     * @brief Returns pointer to pixel at position.
+     * @brief Returns pointer to pixel at position for writing.
+     *
+     * Detaches this buffer from its copies, pixels still shared with
+     * another buffer are copied first. Use constData() for reading.
      */
-    quint8* data(const QPoint& pos) const;
+    quint8* data(const QPoint& pos);
+
+    /**
+     * @brief Returns read-only pointer to raw data, never copies.
+     */
+    const quint8* constData() const;
 
     /**
      * @brief Returns number of planes.
@@ -269,12 +295,23 @@ public:
     size_t planeByteSize(int plane) const;
 
     /**
-     * @brief Returns pointer to a plane.
+     * @brief Returns pointer to a plane for writing.
+     *
+     * Detaches this buffer from its copies, pixels still shared with
+     * another buffer are copied first. Use constPlaneData() for reading.
+     */
+    quint8* planeData(int plane);
+
+    /**
+     * @brief Returns read-only pointer to a plane, never copies.
      */
-    quint8* planeData(int plane) const;
+    const quint8* constPlaneData(int plane) const;
 
     /**
      * @brief Detaches shared data.
+     *
+     * Pixels stay shared with the other buffer until either one is
+     * written through data() or planeData().
      */
     ImageBuffer detach();
 
@@ -321,7 +358,10 @@ public:
      * @brief Converts an image buffer to a different pixel format and channel count.
      *
      * Returns a new ImageBuffer where the pixel data is converted to the
-     * specified type and number of channels.
+     * specified type and number of channels. Common conversions use vector
+     * kernels selected at runtime (AVX2/F16C, SSE4.1, NEON), results match
+     * the scalar conversion bit for bit. Rows are converted in parallel, see
+     * setConvertTileSize().
      */
     static ImageBuffer convert(const ImageBuffer& imagebuffer, ImageFormat::Type type, int channels);
 
@@ -333,6 +373,54 @@ public:
      */
     static ImageBuffer convert(const ImageBuffer& imageBuffer, int channels);
 
+    /**
+     * @brief Converts an image buffer to a different RGB-like pixel layout.
+     *
+     * Reorders and expands channels, for example BGRA to RGBA or RGB to
+     * RGBA, keeping the pixel format.
+     */
+    static ImageBuffer convert(const ImageBuffer& imageBuffer, PixelLayout pixelLayout);
+
+    /**
+     * @brief Decodes a YCbCr image buffer to interleaved RGBA.
+     *
+     * Supports NV12, NV21, UYVY, YUYV, YVYU, VYUY and V210 input. The pixel
+     * range selects video or full range scaling, the color space selects the
+     * Rec.601, Rec.709 or Rec.2020 matrix, other color spaces decode as
+     * Rec.709 like the render shaders. Chroma is sampled nearest. The result
+     * is full range RGBA of @p type, rows are decoded in parallel with vector
+     * kernels where available, see setConvertTileSize().
+     */
+    static ImageBuffer decode(const ImageBuffer& imageBuffer, ImageFormat::Type type = ImageFormat::UInt8);
+
+    /**
+     * @brief Encodes an RGB-like image buffer to packed 4:2:2 YCbCr.
+     *
+     * Supports UYVY (8-bit) and V210 (10-bit) output in legal video range.
+     * Input is expected to be display-referred RGB in the color space of
+     * the image, Rec.601 and Rec.2020 select their own matrix and everything
+     * else uses Rec.709, matching the uyvy8 compute shader. V210 rows are
+     * padded to 128 bytes and the data window width is the row size in
+     * bytes. Rows are encoded in parallel with vector kernels where
+     * available, see setConvertTileSize().
+     */
+    static ImageBuffer encode(const ImageBuffer& imageBuffer, PixelLayout pixelLayout,
+                              ChromaFilter chromaFilter = ChromaFilter::Average);
+
+    /**
+     * @brief Returns the minimum number of bytes per conversion tile.
+     */
+    static qint64 convertTileSize();
+
+    /**
+     * @brief Sets the minimum number of bytes per conversion tile.
+     *
+     * Conversions split the data window into tiles of whole rows of at least
+     * this size and run them on the core::ThreadPool, images that fit in one
+     * tile are converted on the calling thread. Defaults to 256 KiB.
+     */
+    static void setConvertTileSize(qint64 bytes);
+
 private:
     QExplicitlySharedDataPointer<ImageBufferPrivate> p;
 };
@@ -347,3 +435,4 @@ Q_DECLARE_METATYPE(flipman::sdk::core::ImageBuffer::Packing)
 Q_DECLARE_METATYPE(flipman::sdk::core::ImageBuffer::Subsampling)
 Q_DECLARE_METATYPE(flipman::sdk::core::ImageBuffer::PixelLayout)
 Q_DECLARE_METATYPE(flipman::sdk::core::ImageBuffer::PixelRange)
+Q_DECLARE_METATYPE(flipman::sdk::core::ImageBuffer::ChromaFilter)
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#pragma once
+
+#include <flipmansdk/flipmansdk.h>
+#include <QScopedPointer>
+#include <memory>
+
+namespace flipman::sdk::core {
+
+class ImageBufferPoolPrivate;
+
+/**
+ * @class ImageBufferPool
+ * @brief Recycling allocator for ImageBuffer pixel storage.
+ *
+ * Hands out aligned memory blocks rounded up to size classes and keeps
+ * released blocks for reuse, so frames of the same size are served without
+ * heap allocations once the pool is warm. Blocks are 64-byte aligned, blocks
+ * of 64 KiB and larger are page aligned. Memory is not zero-initialized.
+ *
+ * Blocks return to the pool when the last reference drops, a pool must
+ * outlive every block it hands out. All methods are thread-safe.
+ */
+class FLIPMANSDK_EXPORT ImageBufferPool {
+public:
+    /**
+     * @struct Stats
+     * @brief Allocation counters.
+     */
+    struct Stats {
+        qint64 allocations = 0;  ///< Blocks allocated from the heap.
+        qint64 reuses = 0;       ///< Blocks served from the pool.
+        qint64 frees = 0;        ///< Blocks returned to the heap.
+        qint64 usedBlocks = 0;
+        qint64 usedBytes = 0;
+        qint64 pooledBlocks = 0;
+        qint64 pooledBytes = 0;
+        qint64 peakBytes = 0;  ///< Peak of used and pooled bytes.
+    };
+
+    /**
+     * @brief Constructs an empty ImageBufferPool.
+     */
+    ImageBufferPool();
+
+    /**
+     * @brief Destroys the ImageBufferPool and frees pooled blocks.
+     */
+    ~ImageBufferPool();
+
+    /**
+     * @brief Returns a block of at least @p size bytes.
+     *
+     * The block is returned to the pool when the last reference drops.
+     */
+    std::shared_ptr<quint8> allocate(size_t size);
+
+    /**
+     * @brief Frees all pooled blocks.
+     */
+    void trim();
+
+    /**
+     * @brief Returns the maximum number of bytes kept for reuse.
+     */
+    qint64 capacity() const;
+
+    /**
+     * @brief Sets the maximum number of bytes kept for reuse.
+     *
+     * Blocks released beyond the capacity are freed.
+     */
+    void setCapacity(qint64 bytes);
+
+    /**
+     * @brief Returns true if huge pages are requested for large blocks.
+     */
+    bool hugePages() const;
+
+    /**
+     * @brief Requests transparent huge pages for blocks of 2 MiB and larger.
+     *
+     * Only supported on Linux, ignored elsewhere.
+     */
+    void setHugePages(bool hugePages);
+
+    /**
+     * @brief Returns a snapshot of the allocation counters.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Resets allocation counters, peak bytes restarts at current usage.
+     */
+    void resetStats();
+
+    /**
+     * @brief Returns the size class a request of @p size bytes rounds up to.
+     */
+    static size_t sizeClass(size_t size);
+
+    /**
+     * @brief Returns the global ImageBufferPool instance.
+     */
+    static ImageBufferPool* instance();
+
+private:
+    Q_DISABLE_COPY_MOVE(ImageBufferPool)
+    QScopedPointer<ImageBufferPoolPrivate> p;
+};
+
+/**
+ * @brief Returns the global ImageBufferPool instance.
+ */
+inline ImageBufferPool*
+imageBufferPool()
+{
+    return ImageBufferPool::instance();
+}
+
+}  // namespace flipman::sdk::core
@@ -5,17 +5,17 @@
 #pragma once
 
 #include <flipmansdk/flipmansdk.h>
-#include <QExplicitlySharedDataPointer>
 #include <QMetaType>
 #include <QObject>
 
 namespace flipman::sdk::core {
 
-class ImageFormatPrivate;
-
 /**
  * @class ImageFormat
- * @brief Explicitly shared pixel format descriptor.
+ * @brief Pixel format descriptor.
+ *
+ * A trivially copyable value type backed by a constexpr trait table, copies
+ * and comparisons never allocate.
  */
 class FLIPMANSDK_EXPORT ImageFormat {
     Q_GADGET
@@ -26,78 +26,135 @@ public:
     enum Type { Unknown, UInt8, Int8, UInt16, Int16, UInt32, Int32, UInt64, Int64, Half, Float, Double };
     Q_ENUM(Type)
 
+    /**
+     * @struct Traits
+     * @brief Component properties of a pixel type.
+     */
+    struct Traits {
+        Type type;
+        size_t size;
+        bool isInteger;
+        bool isSigned;
+        bool isFloat;
+        const char* name;
+    };
+
     /**
      * @brief Constructs an invalid ImageFormat.
      */
-    ImageFormat();
+    constexpr ImageFormat() = default;
 
     /**
      * @brief Constructs an ImageFormat from a Type.
      */
-    ImageFormat(Type type);
+    constexpr ImageFormat(Type type)
+        : d { type }
+    {}
 
     /**
      * @brief Copy constructor.
      */
-    ImageFormat(const ImageFormat& other);
+    constexpr ImageFormat(const ImageFormat& other) = default;
 
     /**
      * @brief Destroys the ImageFormat.
      */
-    ~ImageFormat();
+    ~ImageFormat() = default;
 
     /**
      * @brief Returns the byte size of a single component.
      */
-    size_t size() const;
+    constexpr size_t size() const { return traits(d.type).size; }
 
     /**
      * @brief Returns the pixel type.
      */
-    Type type() const;
+    constexpr Type type() const { return d.type; }
+
+    /**
+     * @brief Returns the component traits.
+     */
+    constexpr const Traits& traits() const { return traits(d.type); }
+
+    /**
+     * @brief Returns true if components are integers.
+     */
+    constexpr bool isInteger() const { return traits(d.type).isInteger; }
+
+    /**
+     * @brief Returns true if components are floating point.
+     */
+    constexpr bool isFloat() const { return traits(d.type).isFloat; }
 
     /**
      * @brief Returns true if valid.
      */
-    bool isValid() const;
+    constexpr bool isValid() const { return d.type > Unknown && d.type <= Double; }
 
     /**
      * @brief Resets to invalid state.
      */
-    void reset();
+    constexpr void reset() { d.type = Unknown; }
 
     /** @name Operators */
     ///@{
 
     /**
-     * @brief Assignment operator. Performs a shallow copy.
+     * @brief Assignment operator.
      */
-    ImageFormat& operator=(const ImageFormat& other);
+    constexpr ImageFormat& operator=(const ImageFormat& other) = default;
 
     /**
      * @brief Equality operator.
      */
-    bool operator==(const ImageFormat& other) const;
+    constexpr bool operator==(const ImageFormat& other) const { return d.type == other.d.type; }
 
     /**
      * @brief Inequality operator.
      */
-    bool operator!=(const ImageFormat& other) const;
+    constexpr bool operator!=(const ImageFormat& other) const { return d.type != other.d.type; }
 
     /**
      * @brief Strict ordering operator.
      */
-    bool operator<(const ImageFormat& other) const;
+    constexpr bool operator<(const ImageFormat& other) const { return d.type < other.d.type; }
 
     /**
      * @brief Greater-than operator.
      */
-    bool operator>(const ImageFormat& other) const;
+    constexpr bool operator>(const ImageFormat& other) const { return d.type > other.d.type; }
+
+    ///@}
+
+    /** @name Traits */
+    ///@{
+
+    /**
+     * @brief Returns the traits of a pixel type.
+     *
+     * Out of range types return the Unknown entry.
+     */
+    static constexpr const Traits& traits(Type type)
+    {
+        return table[type > Unknown && type <= Double ? type : Unknown];
+    }
 
     ///@}
 
 private:
-    QExplicitlySharedDataPointer<ImageFormatPrivate> p;
+    // indexed by Type, names are short lowercase labels for printing.
+    static constexpr Traits table[] = {
+        { Unknown, 0, false, false, false, "unknown" }, { UInt8, 1, true, false, false, "uint8" },
+        { Int8, 1, true, true, false, "int8" },         { UInt16, 2, true, false, false, "uint16" },
+        { Int16, 2, true, true, false, "int16" },       { UInt32, 4, true, false, false, "uint32" },
+        { Int32, 4, true, true, false, "int32" },       { UInt64, 8, true, false, false, "uint64" },
+        { Int64, 8, true, true, false, "int64" },       { Half, 2, false, true, true, "half" },
+        { Float, 4, false, true, true, "float" },       { Double, 8, false, true, true, "double" },
+    };
+    struct Data {
+        Type type = Unknown;
+    };
+    Data d;
 };
 
 }  // namespace flipman::sdk::core
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#pragma once
+
+#include <flipmansdk/flipmansdk.h>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <functional>
+
+namespace flipman::sdk::core {
+
+class ThreadPoolPrivate;
+
+/**
+ * @class ThreadPool
+ * @brief Bounded worker pool for SDK compute tasks.
+ *
+ * Runs data-parallel work such as image conversion on its own threads,
+ * separate from the global QThreadPool used by the UI and QtConcurrent.
+ */
+class FLIPMANSDK_EXPORT ThreadPool {
+public:
+    /**
+     * @brief Constructs a ThreadPool with the ideal thread count.
+     */
+    ThreadPool();
+
+    /**
+     * @brief Destroys the ThreadPool, waits for running tasks.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Returns the maximum number of worker threads.
+     */
+    int maxThreadCount() const;
+
+    /**
+     * @brief Sets the maximum number of worker threads.
+     *
+     * A count of 1 runs parallelFor() serially on the calling thread.
+     */
+    void setMaxThreadCount(int count);
+
+    /**
+     * @brief Runs a task asynchronously on the pool.
+     */
+    void start(std::function<void()> task);
+
+    /**
+     * @brief Runs @p fn for each index in [0, count) and waits.
+     *
+     * The calling thread takes part in the work, so nested calls from pool
+     * threads cannot deadlock.
+     */
+    void parallelFor(qint64 count, const std::function<void(qint64 index)>& fn);
+
+    /**
+     * @brief Returns the underlying QThreadPool.
+     */
+    QThreadPool* threadPool() const;
+
+    /**
+     * @brief Returns the global ThreadPool instance.
+     */
+    static ThreadPool* instance();
+
+private:
+    Q_DISABLE_COPY_MOVE(ThreadPool)
+    QScopedPointer<ThreadPoolPrivate> p;
+};
+
+/**
+ * @brief Returns the global ThreadPool instance.
+ */
+inline ThreadPool*
+threadPool()
+{
+    return ThreadPool::instance();
+}
+
+}  // namespace flipman::sdk::core
@@ -34,10 +34,13 @@ public:
      * @struct Options
      * @brief Reader configuration parameters.
      *
-     * Contains backend-defined attributes used when opening media.
+     * Contains backend-defined attributes used when opening media. In
+     * probe mode readers parse headers only, no pixel or sample buffers
+     * are allocated and nothing is decoded.
      */
     struct Options {
         QVariantMap values;
+        bool probe = false;
     };
 
 public:
@@ -66,6 +69,18 @@ public:
      */
     virtual bool open(const core::File& file, const Options& options = Options()) = 0;
 
+    /**
+     * @brief Reads media headers without decoding.
+     *
+     * Opens @p file in probe mode and returns its metadata, including
+     * "fps" in the video group and "timeRange" in the container group.
+     * Results are cached per reader, file, frame range and modification
+     * time, the reader is closed afterwards.
+     *
+     * @return Metadata, or an invalid MetaData if the file could not be opened.
+     */
+    core::MetaData probe(const core::File& file);
+
     /**
      * @brief Closes the media file.
      *
@@ -99,6 +114,16 @@ public:
      */
     virtual bool supportsConcurrent() const = 0;
 
+    /**
+     * @brief Returns true if the reader serves and fills the global frame
+     * cache itself.
+     *
+     * Media looks frames up in the frame cache only for readers that return
+     * false, so lookups are made and counted once and readers keep their own
+     * read-ahead running on cache hits. Defaults to false.
+     */
+    virtual bool supportsFrameCache() const;
+
     /**
      * @brief Returns supported file extensions.
      */
@@ -93,6 +93,14 @@ public:
      */
     virtual bool supportsAudio() const = 0;
 
+    /**
+     * @brief Returns true if frames can be written concurrently.
+     *
+     * Writers that return true accept write(image, time) from several
+     * threads at once, for example one file per frame. Defaults to false.
+     */
+    virtual bool supportsConcurrent() const;
+
     /**
      * @brief Returns supported file extensions.
      */
@@ -117,6 +125,16 @@ public:
      */
     virtual av::Time write(const core::ImageBuffer& image);
 
+    /**
+     * @brief Writes an image buffer at a presentation time.
+     *
+     * Used for concurrent writing, see supportsConcurrent(). The default
+     * implementation ignores @p time and writes the next frame in order.
+     *
+     * @return Presentation time of written frame.
+     */
+    virtual av::Time write(const core::ImageBuffer& image, const av::Time& time);
+
     /**
      * @brief Seeks to a time range.
      *
@@ -35,6 +35,18 @@ public:
     /**
      * @brief Opens a media file.
      *
+     * Image sequences are decoded ahead of the current frame on a shared
+     * thread pool into a memory-budgeted frame cache. Supported options:
+     * - readAhead: frames to decode ahead, 0 disables (default 8).
+     * - readAheadBytes: budget of the global core::FrameCache in bytes.
+     * - readAheadThreads: maximum decode threads, shared by all readers.
+     *
+     * Image inputs are kept open in a pool shared by all readers and checked
+     * out per decode, frames and read-ahead workers reuse open files instead
+     * of reopening them. Idle inputs close first when a limit is reached:
+     * - inputHandles: maximum open inputs, in file descriptors (default 64).
+     * - inputBytes: estimated decoder memory of open inputs (default 256 MiB).
+     *
      * @param file Target file.
      * @param options Reader configuration.
      *
@@ -68,6 +80,11 @@ public:
      */
     bool supportsConcurrent() const override;
 
+    /**
+     * @brief Returns true if frames are read ahead into the global frame cache.
+     */
+    bool supportsFrameCache() const override;
+
     /**
      * @brief Returns supported file extensions.
      */
@@ -70,6 +70,11 @@ public:
      */
     bool supportsAudio() const override;
 
+    /**
+     * @brief Returns true, every frame is written to its own file.
+     */
+    bool supportsConcurrent() const override;
+
     /**
      * @brief Returns supported file extensions.
      */
@@ -82,6 +87,15 @@ public:
      */
     av::Time write(const core::ImageBuffer& image) override;
 
+    /**
+     * @brief Writes an image buffer to the file of a given frame.
+     *
+     * Safe to call from several threads at once.
+     *
+     * @return Presentation time of written frame.
+     */
+    av::Time write(const core::ImageBuffer& image, const av::Time& time) override;
+
     /**
      * @brief Seeks to a time range.
      *
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#pragma once
+
+#include <flipmansdk/flipmansdk.h>
+#include <QByteArray>
+#include <QFile>
+#include <QScopedPointer>
+#include <QString>
+
+#include <memory>
+
+namespace flipman::sdk::render {
+
+class LutCachePrivate;
+
+/**
+ * @class LutCache
+ * @brief Process-wide, persistent cache of parsed 3D LUTs.
+ *
+ * Parses .cube files into RGBA float texels and keeps the result on disk
+ * keyed by a hash of the file content, a copied or renamed file hits the
+ * cache and an edited file misses it. Cache files are mapped when read,
+ * the texels are only copied when they are uploaded.
+ *
+ * Cache files are validated on read, files that are truncated or corrupt
+ * are removed and the LUT is parsed again.
+ *
+ * All methods are thread-safe.
+ */
+class FLIPMANSDK_EXPORT LutCache {
+public:
+    /**
+     * @struct Lut
+     * @brief Parsed 3D LUT.
+     */
+    struct Lut {
+        int size = 0;                    ///< Number of entries along each axis.
+        QByteArray rgba32f;              ///< RGBA float texels, red varies fastest.
+        std::shared_ptr<QFile> mapping;  ///< Cache file the texels are mapped from, if any.
+
+        /**
+         * @brief Returns true if the LUT holds texels.
+         */
+        bool isValid() const { return size > 1 && !rgba32f.isEmpty(); }
+    };
+
+    /**
+     * @struct Stats
+     * @brief Cache counters.
+     */
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 rejects = 0;
+        qint64 writes = 0;
+    };
+
+    /**
+     * @brief Constructs a LutCache in the default cache location.
+     */
+    LutCache();
+
+    /**
+     * @brief Destroys the LutCache.
+     */
+    ~LutCache();
+
+    /**
+     * @brief Returns the LUT for @p filename, from the cache if possible.
+     *
+     * Parsed LUTs are written to the cache.
+     *
+     * @param filename .cube file to parse on a miss.
+     * @param hash     Hash of the file content, used as the cache key.
+     * @param cached   If set, receives true when the LUT was read from the cache.
+     * @return The LUT, invalid if the file could not be parsed.
+     */
+    Lut load(const QString& filename, const QByteArray& hash, bool* cached = nullptr);
+
+    /**
+     * @brief Returns the cache file used for @p hash.
+     */
+    QString filePath(const QByteArray& hash) const;
+
+    /**
+     * @brief Removes all entries on disk.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the cache directory.
+     */
+    QString path() const;
+
+    /**
+     * @brief Sets the cache directory, an empty path disables the cache.
+     */
+    void setPath(const QString& path);
+
+    /**
+     * @brief Returns a snapshot of the cache counters.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Resets the cache counters.
+     */
+    void resetStats();
+
+    /**
+     * @brief Parses a 3D .cube file.
+     *
+     * Only 3D LUTs are supported. The data section is parsed in parallel on
+     * the core thread pool in chunks of 256 KiB.
+     *
+     * @return The LUT, invalid if the file could not be parsed.
+     */
+    static Lut parse(const QString& filename);
+
+    /**
+     * @brief Returns the global LutCache instance.
+     */
+    static LutCache* instance();
+
+private:
+    Q_DISABLE_COPY_MOVE(LutCache)
+    QScopedPointer<LutCachePrivate> p;
+};
+
+/**
+ * @brief Returns the global LutCache instance.
+ */
+inline LutCache*
+lutCache()
+{
+    return LutCache::instance();
+}
+
+}  // namespace flipman::sdk::render
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#pragma once
+
+#include <flipmansdk/flipmansdk.h>
+#include <QScopedPointer>
+#include <QString>
+#include <rhi/qrhi.h>
+
+namespace flipman::sdk::render {
+
+class PipelineCachePrivate;
+
+/**
+ * @class PipelineCache
+ * @brief Process-wide, persistent store of QRhi pipeline cache data.
+ *
+ * Backends spend most of their pipeline creation time compiling shaders to
+ * native code. QRhi can export this work as pipeline cache data, which this
+ * class keeps on disk, one file per backend and device, and restores into
+ * the next QRhi created for the same device.
+ *
+ * Files are validated on load, data that is truncated, corrupt or written
+ * for another device is removed and the device starts cold. Saving needs a
+ * QRhi created with QRhi::EnablePipelineCacheDataSave.
+ *
+ * All methods are thread-safe.
+ */
+class FLIPMANSDK_EXPORT PipelineCache {
+public:
+    /**
+     * @struct Stats
+     * @brief Cache counters.
+     */
+    struct Stats {
+        qint64 loads = 0;
+        qint64 rejects = 0;
+        qint64 saves = 0;
+        qint64 loadedBytes = 0;
+        qint64 savedBytes = 0;
+    };
+
+    /**
+     * @brief Constructs a PipelineCache in the default cache location.
+     */
+    PipelineCache();
+
+    /**
+     * @brief Destroys the PipelineCache.
+     */
+    ~PipelineCache();
+
+    /**
+     * @brief Restores pipeline cache data for the device of @p rhi.
+     *
+     * Call before pipelines are created. Data the backend rejects counts as
+     * a reject and leaves the device cold.
+     *
+     * @return True if cache data was restored and accepted by the backend.
+     */
+    bool load(QRhi* rhi);
+
+    /**
+     * @brief Writes the pipeline cache data of @p rhi to disk.
+     *
+     * Data that is unchanged since the last load or save is not written.
+     *
+     * @return True if data was written.
+     */
+    bool save(QRhi* rhi);
+
+    /**
+     * @brief Returns the cache file used for the device of @p rhi.
+     */
+    QString filePath(QRhi* rhi) const;
+
+    /**
+     * @brief Removes all entries on disk.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the cache directory.
+     */
+    QString path() const;
+
+    /**
+     * @brief Sets the cache directory, an empty path disables the cache.
+     */
+    void setPath(const QString& path);
+
+    /**
+     * @brief Returns a snapshot of the cache counters.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Resets the cache counters.
+     */
+    void resetStats();
+
+    /**
+     * @brief Returns the global PipelineCache instance.
+     */
+    static PipelineCache* instance();
+
+private:
+    Q_DISABLE_COPY_MOVE(PipelineCache)
+    QScopedPointer<PipelineCachePrivate> p;
+};
+
+/**
+ * @brief Returns the global PipelineCache instance.
+ */
+inline PipelineCache*
+pipelineCache()
+{
+    return PipelineCache::instance();
+}
+
+}  // namespace flipman::sdk::render
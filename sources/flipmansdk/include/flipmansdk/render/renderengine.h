@@ -128,6 +128,40 @@ public:
 
     ///@}
 
+    /** @name Shaders */
+    ///@{
+
+    /**
+     * @brief Returns true if layer shaders are baked in the background.
+     */
+    bool asyncShaders() const;
+
+    /**
+     * @brief Sets whether layer shaders are baked in the background.
+     *
+     * When enabled, layer shaders are baked on the core thread pool. Until a
+     * layer's shaders are ready it is drawn with the plain shader for its
+     * texture type, without the effect, and updateRequested() is emitted when
+     * the baked shaders can be swapped in. Disable for renders that must be
+     * complete on the first frame. Defaults to true.
+     */
+    void setAsyncShaders(bool async);
+
+    /**
+     * @brief Bakes layer shaders for the effects up front.
+     *
+     * Queues every variant of the effects, and the plain shader, for each
+     * texture type and color space on the core thread pool. Variants already
+     * cached are skipped. Safe to call before the engine is initialized, the
+     * variants are queued once a device is available and again if the device
+     * changes. Each call replaces the effects of the previous one.
+     *
+     * @param effectDefinitions Effects to bake variants for.
+     */
+    void precompile(const QList<ShaderDefinition>& effectDefinitions);
+
+    ///@}
+
     /**
      * @brief Returns generation error, if any.
      */
@@ -143,6 +177,13 @@ public:
      */
     void reset();
 
+Q_SIGNALS:
+
+    /**
+     * @brief Emitted when background shaders are ready and a new frame should be rendered.
+     */
+    void updateRequested();
+
 private:
     Q_DISABLE_COPY_MOVE(RenderEngine)
     QScopedPointer<RenderEnginePrivate> p;
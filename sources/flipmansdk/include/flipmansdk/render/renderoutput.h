@@ -83,11 +83,26 @@ public:
      */
     void setRenderSpec(const RenderSpec& renderSpec);
 
+    /**
+     * @brief Returns the number of readback slots.
+     */
+    int readbackDepth() const;
+
+    /**
+     * @brief Sets the number of readback slots, at least one (default 3).
+     *
+     * Each slot owns a GPU convert buffer and a CPU image. A frame is dropped
+     * only when every slot is either in flight or still held by the output.
+     */
+    void setReadbackDepth(int depth);
+
     /**
      * @brief Receives a completed CPU-readable frame from the render engine.
      *
-     * The default implementation does nothing. Derived output types can override
-     * this to enqueue, write, transmit, or display a rendered frame.
+     * The frame's readback slot is held until releaseFrame() is called, the
+     * engine does not write into a held slot. The default implementation
+     * writes a debug image and releases the frame. Derived output types can
+     * override this to enqueue, write, transmit, or display a rendered frame.
      *
      * This function is called only for outputs where readback() is enabled.
      *
@@ -96,7 +111,44 @@ public:
      */
     virtual void enqueueFrame(const core::ImageBuffer& image, qint64 frame);
 
+    /**
+     * @brief Releases the readback slot of a delivered frame.
+     *
+     * Thread-safe, consumers may release from their playout thread.
+     */
+    void releaseFrame(qint64 frame);
+
+    /** @name Statistics */
+    ///@{
+
+    /**
+     * @brief Returns the number of frames delivered to enqueueFrame().
+     */
+    qint64 deliveredFrames() const;
+
+    /**
+     * @brief Returns the number of rendered frames that were not read back.
+     */
+    qint64 droppedFrames() const;
+
+    /**
+     * @brief Returns the average time from readback request to delivery.
+     */
+    qreal readbackLatencyMs() const;
+
+    /**
+     * @brief Returns the longest time from readback request to delivery.
+     */
+    qreal readbackLatencyMaxMs() const;
+
+    ///@}
+
 private:
+    friend class RenderEnginePrivate;
+    bool isHeld(qint64 frame) const;
+    void hold(qint64 frame);
+    void delivered(qint64 latencyNs);
+    void dropped();
     Q_DISABLE_COPY_MOVE(RenderOutput)
     QScopedPointer<RenderOutputPrivate> p;
 };
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#pragma once
+
+#include <flipmansdk/flipmansdk.h>
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QString>
+#include <rhi/qshader.h>
+
+namespace flipman::sdk::render {
+
+class ShaderCachePrivate;
+
+/**
+ * @class ShaderCache
+ * @brief Process-wide, persistent cache of baked shaders.
+ *
+ * Stores serialized QShader packages on disk keyed by a hash of everything
+ * that affects baking, see ShaderCompiler. Entries live in a versioned
+ * directory and are written atomically, a crash never leaves a partial
+ * entry behind. When the disk size exceeds the budget, least recently used
+ * entries are removed. Shaders kept in memory are bounded on their own, by
+ * entry count, so a cache without a disk path does not grow without limit.
+ *
+ * All methods are thread-safe.
+ */
+class FLIPMANSDK_EXPORT ShaderCache {
+public:
+    /**
+     * @struct Stats
+     * @brief Cache counters.
+     */
+    struct Stats {
+        qint64 memoryHits = 0;
+        qint64 diskHits = 0;
+        qint64 misses = 0;
+        qint64 writes = 0;
+        qint64 evictions = 0;
+        qint64 entries = 0;
+        qint64 memoryEntries = 0;
+        qint64 diskBytes = 0;
+        qint64 budgetBytes = 0;
+    };
+
+    /**
+     * @brief Constructs a ShaderCache in the default cache location.
+     */
+    ShaderCache();
+
+    /**
+     * @brief Destroys the ShaderCache.
+     */
+    ~ShaderCache();
+
+    /**
+     * @brief Looks up a shader, in memory first and on disk after.
+     *
+     * Entries that fail to validate are removed and count as a miss.
+     *
+     * @param key    Cache key.
+     * @param shader Receives the cached shader.
+     * @param disk   If set, receives true when the shader was read from disk.
+     * @return True if the shader was cached.
+     */
+    bool find(const QByteArray& key, QShader& shader, bool* disk = nullptr);
+
+    /**
+     * @brief Inserts a shader and writes it to disk.
+     */
+    void insert(const QByteArray& key, const QShader& shader);
+
+    /**
+     * @brief Loads every entry on disk into memory, up to the memory limit.
+     *
+     * Entries are read in parallel on the core thread pool. Call early in a
+     * session, for example at startup, to take disk reads off the first
+     * frame.
+     *
+     * @return Number of shaders loaded.
+     */
+    int warmUp();
+
+    /**
+     * @brief Removes all entries, in memory and on disk.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the cache directory.
+     */
+    QString path() const;
+
+    /**
+     * @brief Sets the cache directory, an empty path disables the disk cache.
+     *
+     * Entries are kept in a subdirectory for the cache format and Qt
+     * version, a Qt update starts from an empty cache.
+     */
+    void setPath(const QString& path);
+
+    /**
+     * @brief Returns the disk budget in bytes.
+     */
+    qint64 budget() const;
+
+    /**
+     * @brief Sets the disk budget in bytes, evicts entries if needed.
+     */
+    void setBudget(qint64 bytes);
+
+    /**
+     * @brief Returns the maximum number of shaders kept in memory.
+     */
+    int memoryLimit() const;
+
+    /**
+     * @brief Sets the maximum number of shaders kept in memory.
+     *
+     * Least recently used shaders are dropped from memory first, entries on
+     * disk are not affected. Defaults to 1024.
+     */
+    void setMemoryLimit(int entries);
+
+    /**
+     * @brief Returns a snapshot of the cache counters.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Resets hit, miss, write and eviction counters.
+     */
+    void resetStats();
+
+    /**
+     * @brief Returns the global ShaderCache instance.
+     */
+    static ShaderCache* instance();
+
+private:
+    Q_DISABLE_COPY_MOVE(ShaderCache)
+    QScopedPointer<ShaderCachePrivate> p;
+};
+
+/**
+ * @brief Returns the global ShaderCache instance.
+ */
+inline ShaderCache*
+shaderCache()
+{
+    return ShaderCache::instance();
+}
+
+}  // namespace flipman::sdk::render
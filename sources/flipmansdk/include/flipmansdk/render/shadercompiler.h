@@ -22,7 +22,9 @@ class ShaderCompilerPrivate;
  * QShader representation suitable for use with Qt's QRhi rendering system.
  *
  * Internally, the compiler orchestrates Qt's shader baking pipeline
- * to generate a multi-backend shader package.
+ * to generate a multi-backend shader package. Baked shaders are stored in
+ * the persistent ShaderCache keyed by source, stage, options and Qt version,
+ * later sessions load them instead of baking again.
  *
  */
 class FLIPMANSDK_EXPORT ShaderCompiler : public QObject {
@@ -41,6 +43,7 @@ public:
             , generateMsl(false)
             , generateHlsl(false)
             , optimize(false)
+            , cache(true)
         {}
 
         int glslVersion;     ///< GLSL version used as source input.
@@ -48,6 +51,7 @@ public:
         bool generateMsl;    ///< Enables Metal Shading Language output.
         bool generateHlsl;   ///< Enables HLSL output (Direct3D).
         bool optimize;       ///< Enables optimization passes.
+        bool cache;          ///< Uses the persistent ShaderCache.
     };
 
 public:
@@ -78,6 +82,9 @@ public:
      *
      * @note If compilation fails, an invalid QShader is returned and
      *       error() will describe the failure.
+     *
+     * @note Compilers may be used on separate threads. Cache lookups run
+     *       concurrently, bakes are serialized process-wide.
      */
     QShader compile(const QString& source, QShader::Stage stage, const Options& options = Options());
 
@@ -94,6 +101,16 @@ public:
      */
     bool isValid() const;
 
+    /**
+     * @brief Returns true if the last compile was served by the ShaderCache.
+     */
+    bool isCached() const;
+
+    /**
+     * @brief Returns true if the last compile was read from disk by the ShaderCache.
+     */
+    bool isDiskCached() const;
+
     ///@}
 
 private:
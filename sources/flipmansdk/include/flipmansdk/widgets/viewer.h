@@ -142,6 +142,11 @@ protected:
      */
     void render(QRhiCommandBuffer* cb) override;
 
+    /**
+     * @brief Saves pipeline cache data before GPU resources are released.
+     */
+    void releaseResources() override;
+
     ///@}
 
     /** @name Interaction */
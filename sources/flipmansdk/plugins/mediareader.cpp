@@ -2,16 +2,108 @@
 // Copyright (c) 2024 - present Mikael Sundell
 // https://github.com/mikaelsundell/flipman
 
+#include <flipmansdk/core/filerange.h>
 #include <flipmansdk/plugins/mediareader.h>
+#include <QCache>
+#include <QDateTime>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QMutex>
 #include <QPointer>
+#include <QTimer>
 
 namespace flipman::sdk::plugins {
+
+namespace {
+    class ProbeCache {
+    public:
+        struct Entry {
+            QDateTime modified;
+            qint64 size = 0;
+            core::MetaData metaData;
+        };
+
+        bool find(const QString& key, const QFileInfo& info, core::MetaData& metaData)
+        {
+            QMutexLocker locker(&mutex);
+            const Entry* entry = entries.object(key);
+            if (!entry || entry->modified != info.lastModified() || entry->size != info.size())
+                return false;
+            metaData = entry->metaData;
+            return true;
+        }
+
+        void insert(const QString& key, const QFileInfo& info, const core::MetaData& metaData)
+        {
+            QMutexLocker locker(&mutex);
+            entries.insert(key, new Entry { info.lastModified(), info.size(), metaData });
+        }
+
+        static ProbeCache* instance()
+        {
+            static ProbeCache cache;
+            return &cache;
+        }
+
+    private:
+        QMutex mutex;
+        QCache<QString, Entry> entries { 4096 };
+    };
+}  // namespace
+
 MediaReader::MediaReader(QObject* parent)
     : core::Plugin(parent)
 {}
 
 MediaReader::~MediaReader() {}
 
+core::MetaData
+MediaReader::probe(const core::File& file)
+{
+    // sequences are keyed on their pattern and frame range, frames added or
+    // removed give a new key, and validated against the first frame, a
+    // re-render of the sequence touches it.
+    const core::FileRange range = file.fileRange();
+    QString path = file.filePath();
+    if (range.isValid())
+        path = QString("%1:%2-%3:%4").arg(range.pattern()).arg(range.start()).arg(range.end()).arg(range.size());
+    const QFileInfo info(range.isValid() ? range.filePath(range.start()) : file.filePath());
+    const QString key = QString("%1:%2").arg(metaObject()->className(), path);
+
+    core::MetaData metaData;
+    if (ProbeCache::instance()->find(key, info, metaData))
+        return metaData;
+
+    Options options;
+    options.probe = true;
+    if (!open(file, options))
+        return core::MetaData();
+
+    if (!isOpen() && !error().hasError()) {
+        QEventLoop loop;
+        QObject::connect(this, &MediaReader::opened, &loop, &QEventLoop::quit);
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        if (!isOpen())
+            loop.exec();
+    }
+    if (!isOpen())
+        return core::MetaData();
+
+    metaData = this->metaData();
+    metaData.insert(core::MetaData::Group::Video, "fps", QVariant::fromValue(fps()));
+    metaData.insert(core::MetaData::Group::Container, "timeRange", QVariant::fromValue(timeRange()));
+    close();
+
+    ProbeCache::instance()->insert(key, info, metaData);
+    return metaData;
+}
+
+bool
+MediaReader::supportsFrameCache() const
+{
+    return false;
+}
+
 core::AudioBuffer
 MediaReader::audio() const
 {
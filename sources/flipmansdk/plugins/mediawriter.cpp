@@ -12,6 +12,12 @@ MediaWriter::MediaWriter(QObject* parent)
 
 MediaWriter::~MediaWriter() {}
 
+bool
+MediaWriter::supportsConcurrent() const
+{
+    return false;
+}
+
 av::Time
 MediaWriter::write(const core::AudioBuffer& image)
 {
@@ -24,6 +30,13 @@ MediaWriter::write(const core::ImageBuffer& image)
     return av::Time();
 }
 
+av::Time
+MediaWriter::write(const core::ImageBuffer& image, const av::Time& time)
+{
+    Q_UNUSED(time);
+    return write(image);
+}
+
 av::Time
 MediaWriter::seek(const av::TimeRange& range)
 {
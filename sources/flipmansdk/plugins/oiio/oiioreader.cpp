@@ -3,16 +3,248 @@
 // https://github.com/mikaelsundell/flipman
 
 #include <flipmansdk/core/filerange.h>
+#include <flipmansdk/core/framecache.h>
 #include <flipmansdk/plugins/oiio/oiioreader.h>
 #include <OpenImageIO/half.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/strutil.h>
 #include <OpenImageIO/typedesc.h>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 using namespace OIIO;
 
 namespace flipman::sdk::plugins {
 
+class OIIOReadAhead {
+public:
+    OIIOReadAhead();
+    bool find(const QString& key, qint64 frame, core::ImageBuffer& image, bool wait = false);
+    void insert(const QString& key, qint64 frame, const core::ImageBuffer& image);
+    bool request(const QString& key, qint64 frame);
+    void release(const QString& key, qint64 frame);
+    QThreadPool* threadPool();
+    static OIIOReadAhead* instance();
+    struct Data {
+        QMutex mutex;
+        QWaitCondition ready;
+        QSet<QPair<QString, qint64>> pending;
+        QThreadPool threadPool;
+    };
+    Data d;
+};
+
+OIIOReadAhead::OIIOReadAhead()
+{
+    d.threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+    d.threadPool.setObjectName("oiioreadahead");
+}
+
+bool
+OIIOReadAhead::find(const QString& key, qint64 frame, core::ImageBuffer& image, bool wait)
+{
+    if (wait) {
+        // a frame already being decoded ahead is cheaper to wait for than to
+        // decode a second time on the caller thread.
+        QMutexLocker locker(&d.mutex);
+        while (d.pending.contains({ key, frame }))
+            d.ready.wait(&d.mutex);
+    }
+    return core::frameCache()->find(key, frame, image);
+}
+
+void
+OIIOReadAhead::insert(const QString& key, qint64 frame, const core::ImageBuffer& image)
+{
+    core::frameCache()->insert(key, frame, image);
+    release(key, frame);
+}
+
+bool
+OIIOReadAhead::request(const QString& key, qint64 frame)
+{
+    QMutexLocker locker(&d.mutex);
+    if (d.pending.contains({ key, frame }) || core::frameCache()->contains(key, frame))
+        return false;
+
+    d.pending.insert({ key, frame });
+    return true;
+}
+
+void
+OIIOReadAhead::release(const QString& key, qint64 frame)
+{
+    QMutexLocker locker(&d.mutex);
+    if (d.pending.remove({ key, frame }))
+        d.ready.wakeAll();
+}
+
+QThreadPool*
+OIIOReadAhead::threadPool()
+{
+    return &d.threadPool;
+}
+
+OIIOReadAhead*
+OIIOReadAhead::instance()
+{
+    static OIIOReadAhead readAhead;
+    return &readAhead;
+}
+
+class OIIOInputPool {
+public:
+    OIIOInputPool();
+    std::unique_ptr<OIIO::ImageInput> checkOut(const QString& fileName, bool* reused = nullptr);
+    void checkIn(const QString& fileName, std::unique_ptr<OIIO::ImageInput> input);
+    void discard(std::unique_ptr<OIIO::ImageInput> input);
+    void setLimits(qint64 handles, qint64 bytes);
+    static qint64 estimate(const OIIO::ImageInput* input);
+    static OIIOInputPool* instance();
+    struct Entry {
+        QString fileName;
+        std::unique_ptr<OIIO::ImageInput> input;
+    };
+    struct Data {
+        QMutex mutex;
+        std::vector<Entry> idle;
+        qint64 handles = 0;
+        qint64 bytes = 0;
+        qint64 maxHandles = 64;
+        qint64 maxBytes = 256 * 1024 * 1024;
+    };
+    Data d;
+
+private:
+    std::vector<std::unique_ptr<OIIO::ImageInput>> trim();
+};
+
+OIIOInputPool::OIIOInputPool() {}
+
+std::unique_ptr<OIIO::ImageInput>
+OIIOInputPool::checkOut(const QString& fileName, bool* reused)
+{
+    {
+        // the most recently checked in handle is the most likely to still
+        // have its file and decoder state warm.
+        QMutexLocker locker(&d.mutex);
+        for (auto it = d.idle.rbegin(); it != d.idle.rend(); ++it) {
+            if (it->fileName == fileName) {
+                std::unique_ptr<OIIO::ImageInput> input = std::move(it->input);
+                d.idle.erase(std::next(it).base());
+                if (reused)
+                    *reused = true;
+                return input;
+            }
+        }
+    }
+    if (reused)
+        *reused = false;
+
+    std::unique_ptr<OIIO::ImageInput> input = OIIO::ImageInput::open(fileName.toStdString());
+    if (!input)
+        return input;
+
+    std::vector<std::unique_ptr<OIIO::ImageInput>> closed;
+    {
+        QMutexLocker locker(&d.mutex);
+        d.handles++;
+        d.bytes += estimate(input.get());
+        closed = trim();
+    }
+    for (std::unique_ptr<OIIO::ImageInput>& handle : closed)
+        handle->close();
+    return input;
+}
+
+void
+OIIOInputPool::checkIn(const QString& fileName, std::unique_ptr<OIIO::ImageInput> input)
+{
+    if (!input)
+        return;
+
+    std::vector<std::unique_ptr<OIIO::ImageInput>> closed;
+    {
+        QMutexLocker locker(&d.mutex);
+        d.idle.push_back(Entry { fileName, std::move(input) });
+        closed = trim();
+    }
+    for (std::unique_ptr<OIIO::ImageInput>& handle : closed)
+        handle->close();
+}
+
+void
+OIIOInputPool::discard(std::unique_ptr<OIIO::ImageInput> input)
+{
+    if (!input)
+        return;
+
+    {
+        QMutexLocker locker(&d.mutex);
+        d.handles--;
+        d.bytes -= estimate(input.get());
+    }
+    input->close();
+}
+
+void
+OIIOInputPool::setLimits(qint64 handles, qint64 bytes)
+{
+    std::vector<std::unique_ptr<OIIO::ImageInput>> closed;
+    {
+        QMutexLocker locker(&d.mutex);
+        // negative limits keep the current value.
+        if (handles >= 0)
+            d.maxHandles = handles;
+        if (bytes >= 0)
+            d.maxBytes = bytes;
+        closed = trim();
+    }
+    for (std::unique_ptr<OIIO::ImageInput>& handle : closed)
+        handle->close();
+}
+
+std::vector<std::unique_ptr<OIIO::ImageInput>>
+OIIOInputPool::trim()
+{
+    // limits count every open handle, only idle ones can be closed so the
+    // pool never blocks a decode. Least recently checked in close first,
+    // outside the lock.
+    std::vector<std::unique_ptr<OIIO::ImageInput>> closed;
+    size_t count = 0;
+    while (count < d.idle.size() && (d.handles > d.maxHandles || d.bytes > d.maxBytes)) {
+        std::unique_ptr<OIIO::ImageInput>& input = d.idle[count++].input;
+        d.handles--;
+        d.bytes -= estimate(input.get());
+        closed.push_back(std::move(input));
+    }
+    d.idle.erase(d.idle.begin(), d.idle.begin() + std::ptrdiff_t(count));
+    return closed;
+}
+
+qint64
+OIIOInputPool::estimate(const OIIO::ImageInput* input)
+{
+    // decoders buffer about one tile or scanline of native pixels.
+    const OIIO::ImageSpec& spec = input->spec();
+    return qint64(spec.tile_width > 0 ? spec.tile_bytes(true) : spec.scanline_bytes(true));
+}
+
+OIIOInputPool*
+OIIOInputPool::instance()
+{
+    static OIIOInputPool pool;
+    return &pool;
+}
+
 class OIIOReaderPrivate : public QSharedData {
 public:
     OIIOReaderPrivate();
@@ -22,20 +254,42 @@ public:
     av::Time read();
     av::Time skip();
     av::Time seek(const av::TimeRange& range);
-    core::ImageFormat::Type toImageType(const OIIO::TypeDesc& type);
+    QString fileName(qint64 frame) const;
+    void readAhead(qint64 frame);
+    void describe(const OIIO::ImageSpec& spec);
+    static core::MetaData::Group group(const std::string& name);
+    static bool decode(OIIO::ImageInput* input, core::ImageBuffer& image, core::Error& error);
+    static core::ImageFormat::Type toImageType(const OIIO::TypeDesc& type);
     static plugins::PluginHandler::Info info();
     static core::Plugin* creator();
     static QList<QString> extensions();
+    struct Stats {
+        std::atomic<qint64> hits { 0 };
+        std::atomic<qint64> misses { 0 };
+        std::atomic<qint64> opens { 0 };
+        std::atomic<qint64> decodes { 0 };
+        std::atomic<qint64> decodeNs { 0 };
+        std::atomic<qint64> decodeMaxNs { 0 };
+        void decoded(qint64 ns)
+        {
+            decodes.fetch_add(1);
+            decodeNs.fetch_add(ns);
+            qint64 max = decodeMaxNs.load();
+            while (max < ns && !decodeMaxNs.compare_exchange_weak(max, ns))
+                ;
+        }
+    };
     struct Data {
         core::File file;
-        std::unique_ptr<OIIO::ImageInput> input;
-        QString fileName;
         av::Fps fps = av::Fps::fps24();
         av::TimeRange timeRange;
         av::Time startStamp;
         av::Time timeStamp;
         core::ImageBuffer image;
         core::MetaData metaData;
+        int readAhead = 8;
+        bool probe = false;
+        std::shared_ptr<Stats> stats = std::make_shared<Stats>();
         bool open = false;
         core::Error error;
     };
@@ -45,6 +299,33 @@ public:
 namespace {
     std::once_flag flag;
     void init() { OIIO::attribute("threads", 0); }
+
+    template<typename T>
+    void expandRows(quint8* data, size_t pixels, int channels, T alpha)
+    {
+        // scanlines land in the first channels of each rgba pixel, gray is
+        // replicated to rgb and missing alpha is opaque.
+        T* p = reinterpret_cast<T*>(data);
+        for (size_t i = 0; i < pixels; ++i, p += 4) {
+            if (channels == 3) {
+                p[3] = alpha;
+            }
+            else {
+                p[3] = channels == 2 ? p[1] : alpha;
+                p[1] = p[2] = p[0];
+            }
+        }
+    }
+
+    void expandRows(core::ImageFormat::Type type, quint8* data, size_t pixels, int channels)
+    {
+        switch (type) {
+        case core::ImageFormat::Type::UInt8: expandRows<quint8>(data, pixels, channels, 255); break;
+        case core::ImageFormat::Type::Half: expandRows<half>(data, pixels, channels, half(1.0f)); break;
+        case core::ImageFormat::Type::Float: expandRows<float>(data, pixels, channels, 1.0f); break;
+        default: break;
+        }
+    }
 }  // namespace
 
 OIIOReaderPrivate::OIIOReaderPrivate() { std::call_once(flag, init); }
@@ -54,53 +335,157 @@ OIIOReaderPrivate::~OIIOReaderPrivate() {}
 bool
 OIIOReaderPrivate::open(const core::File& file, const OIIOReader::Options& options)
 {
-    Q_UNUSED(options);
-
     d.file = file;
+    d.probe = options.probe;
 
     const core::FileRange range = file.fileRange();
+    QString fileName;
+    if (range.isValid())
+        fileName = range.filePath(range.start());
+    else
+        fileName = file.filePath();
+
+    // the header is read by open, describing the image costs no decode and
+    // sets the frame rate before time stamps are derived from it. The input
+    // goes back to the pool warm for the first read.
+    bool reused = false;
+    std::unique_ptr<OIIO::ImageInput> input = OIIOInputPool::instance()->checkOut(fileName, &reused);
+    if (!input) {
+        d.error = core::Error("oiioreader", "could not open image");
+        return false;
+    }
+    if (!reused)
+        d.stats->opens.fetch_add(1);
+
+    describe(input->spec());
+    OIIOInputPool::instance()->checkIn(fileName, std::move(input));
     d.startStamp = av::Time::zero(d.fps);
     d.timeStamp = d.startStamp;
 
     if (range.isValid()) {
-        const qint64 count = range.size();
+        // missing frames keep their slot so frame numbers map to files.
+        const qint64 count = (range.end() - range.start()) / range.step() + 1;
         d.timeRange = av::TimeRange(d.startStamp, av::Time::fromFrames(count, d.fps));
     }
     else {
         d.timeRange = av::TimeRange(d.startStamp, av::Time::fromFrames(1, d.fps));
     }
 
-    QString fileName;
-    if (range.isValid())
-        fileName = range.frame(range.start()).filePath();
-    else
-        fileName = file.filePath();
-
-    d.input = OIIO::ImageInput::open(fileName.toStdString());
-
-    if (!d.input) {
-        d.error = core::Error("oiioreader", "could not open image");
-        return false;
+    // read-ahead only applies to sequences, single images have nothing to
+    // decode ahead of the current frame and probes never decode.
+    d.readAhead = range.isValid() && !d.probe ? qMax(0, options.values.value("readAhead", 8).toInt()) : 0;
+    if (!d.probe) {
+        if (options.values.contains("readAheadBytes"))
+            core::frameCache()->setBudget(options.values.value("readAheadBytes").toLongLong());
+        if (options.values.contains("readAheadThreads"))
+            OIIOReadAhead::instance()->threadPool()->setMaxThreadCount(
+                qMax(1, options.values.value("readAheadThreads").toInt()));
+        if (options.values.contains("inputHandles") || options.values.contains("inputBytes"))
+            OIIOInputPool::instance()->setLimits(options.values.value("inputHandles", -1).toLongLong(),
+                                                 options.values.value("inputBytes", -1).toLongLong());
     }
 
-    d.fileName = fileName;
     d.open = true;
 
     return true;
 }
 
+void
+OIIOReaderPrivate::describe(const OIIO::ImageSpec& spec)
+{
+    QStringList channelNames;
+    for (const std::string& name : spec.channelnames)
+        channelNames.append(QString::fromStdString(name));
+
+    using Group = core::MetaData::Group;
+    d.metaData.reset();
+    d.metaData.insert(Group::Video, "width", spec.width);
+    d.metaData.insert(Group::Video, "height", spec.height);
+    d.metaData.insert(Group::Video, "dataWindow", QRect(spec.x, spec.y, spec.width, spec.height));
+    d.metaData.insert(Group::Video, "displayWindow",
+                      QRect(spec.full_x, spec.full_y, spec.full_width, spec.full_height));
+    d.metaData.insert(Group::Video, "channels", spec.nchannels);
+    d.metaData.insert(Group::Video, "channelNames", channelNames);
+    d.metaData.insert(Group::Video, "pixelType", QString(spec.format.c_str()));
+    if (spec.tile_width > 0) {
+        d.metaData.insert(Group::Video, "tileWidth", spec.tile_width);
+        d.metaData.insert(Group::Video, "tileHeight", spec.tile_height);
+    }
+
+    for (const OIIO::ParamValue& param : spec.extra_attribs) {
+        const std::string name = param.name().string();
+        QVariant value;
+        if (param.type() == OIIO::TypeString)
+            value = QString::fromStdString(param.get_string());
+        else if (param.type() == OIIO::TypeInt)
+            value = param.get_int();
+        else if (param.type() == OIIO::TypeFloat)
+            value = param.get_float();
+        else
+            value = QString::fromStdString(OIIO::ImageSpec::metadata_val(param, true));
+        d.metaData.insert(group(name), QString::fromStdString(name), value);
+    }
+
+    // exr stores a rational frame rate, dpx a float, other formats fall
+    // back to the default rate.
+    d.fps = av::Fps::fps24();
+    int rational[2] = { 0, 0 };
+    if (spec.getattribute("FramesPerSecond", OIIO::TypeRational, rational) && rational[0] > 0 && rational[1] > 0) {
+        d.fps = av::Fps::guess(qreal(rational[0]) / rational[1]);
+    }
+    else {
+        const float rate = spec.get_float_attribute("dpx:FrameRate", 0.0f);
+        if (rate > 0.0f)
+            d.fps = av::Fps::guess(rate);
+    }
+
+    const OIIO::ParamValue* timeCode = spec.find_attribute("smpte:TimeCode", OIIO::TypeTimeCode);
+    if (timeCode)
+        d.metaData.insert(Group::Timecode, "timecode",
+                          QString::fromStdString(OIIO::ImageSpec::metadata_val(*timeCode, true)));
+}
+
+core::MetaData::Group
+OIIOReaderPrivate::group(const std::string& name)
+{
+    // attributes are grouped by their namespace prefix, names without one
+    // describe the production.
+    using Group = core::MetaData::Group;
+    const OIIO::string_view view(name);
+    if (OIIO::Strutil::istarts_with(view, "smpte:") || OIIO::Strutil::icontains(view, "timecode")
+        || OIIO::Strutil::icontains(view, "keycode"))
+        return Group::Timecode;
+    if (OIIO::Strutil::istarts_with(view, "exif:") || OIIO::Strutil::istarts_with(view, "camera")
+        || OIIO::Strutil::istarts_with(view, "lens") || OIIO::Strutil::istarts_with(view, "make")
+        || OIIO::Strutil::istarts_with(view, "model"))
+        return Group::Camera;
+    if (name.find(':') != std::string::npos || OIIO::Strutil::iequals(view, "compression")
+        || OIIO::Strutil::iequals(view, "planarconfig") || OIIO::Strutil::iequals(view, "Orientation"))
+        return Group::Container;
+    return Group::Production;
+}
+
 bool
 OIIOReaderPrivate::close()
 {
-    if (d.input) {
-        d.input->close();
-        d.input.reset();
-    }
-    d.fileName.clear();
     d.open = false;
     return true;
 }
 
+QString
+OIIOReaderPrivate::fileName(qint64 frame) const
+{
+    const core::FileRange range = d.file.fileRange();
+    if (!range.isValid())
+        return d.file.filePath();
+
+    const qint64 fileFrame = range.start() + frame * range.step();
+    if (!range.hasFrame(fileFrame))
+        return QString();
+
+    return range.filePath(fileFrame);
+}
+
 av::Time
 OIIOReaderPrivate::read()
 {
@@ -108,44 +493,117 @@ OIIOReaderPrivate::read()
         d.error = core::Error("oiioreader", "reader not open");
         return d.timeStamp;
     }
-    const core::FileRange range = d.file.fileRange();
+    if (d.probe) {
+        d.error = core::Error("oiioreader", "reader opened for probe");
+        return d.timeStamp;
+    }
     const qint64 timelineFrame = d.timeStamp.frames();
+    const QString fileName = this->fileName(timelineFrame);
 
-    QString fileName;
-    if (range.isValid()) {
-        const qint64 fileFrame = range.start() + timelineFrame;
-
-        if (!range.hasFrame(fileFrame)) {
-            d.error = core::Error("oiioreader", "frame not mapped");
-            return d.timeStamp;
-        }
+    if (fileName.isEmpty()) {
+        d.error = core::Error("oiioreader", "frame not mapped");
+        return d.timeStamp;
+    }
 
-        fileName = range.frame(fileFrame).filePath();
+    OIIOReadAhead* readAhead = OIIOReadAhead::instance();
+    const QString key = d.file.filePath();
+    if (d.readAhead > 0 && readAhead->find(key, timelineFrame, d.image, true)) {
+        d.stats->hits.fetch_add(1);
     }
     else {
-        fileName = d.file.filePath();
-    }
+        d.stats->misses.fetch_add(1);
 
-    if (!d.input || d.fileName != fileName) {
-        std::unique_ptr<OIIO::ImageInput> newInput = OIIO::ImageInput::open(fileName.toStdString());
+        QElapsedTimer timer;
+        timer.start();
 
-        if (!newInput) {
+        OIIOInputPool* pool = OIIOInputPool::instance();
+        bool reused = false;
+        std::unique_ptr<OIIO::ImageInput> input = pool->checkOut(fileName, &reused);
+        if (!input) {
             d.error = core::Error("oiioreader", "could not open frame");
             return d.timeStamp;
         }
+        if (!reused)
+            d.stats->opens.fetch_add(1);
+
+        // the previous frame is released first, when no one else holds it
+        // the frame decodes into the same storage.
+        core::ImageBuffer image = d.image;
+        d.image = core::ImageBuffer();
+        if (!decode(input.get(), image, d.error)) {
+            pool->discard(std::move(input));
+            return d.timeStamp;
+        }
+        pool->checkIn(fileName, std::move(input));
+
+        d.stats->decoded(timer.nsecsElapsed());
+        d.image = image;
+
+        if (d.readAhead > 0)
+            core::frameCache()->insert(key, timelineFrame, image);
+    }
+
+    readAhead(timelineFrame + 1);
 
-        if (d.input)
-            d.input->close();
+    d.timeStamp.setTicks(d.timeStamp.ticks() + d.timeStamp.tpf());
+    return d.timeStamp;
+}
+
+void
+OIIOReaderPrivate::readAhead(qint64 frame)
+{
+    if (d.readAhead <= 0)
+        return;
+
+    // decode the next frames on the shared read-ahead pool into the global
+    // frame cache, workers check inputs out of the input pool so a handle is
+    // never used by two threads at once.
+    OIIOReadAhead* readAhead = OIIOReadAhead::instance();
+    const QString key = d.file.filePath();
+    for (qint64 next = frame; next < frame + d.readAhead; ++next) {
+        const QString fileName = this->fileName(next);
+        if (fileName.isEmpty())
+            break;
+
+        if (!readAhead->request(key, next))
+            continue;
+
+        std::shared_ptr<Stats> stats = d.stats;
+        readAhead->threadPool()->start([readAhead, stats, key, next, fileName]() {
+            QElapsedTimer timer;
+            timer.start();
+
+            OIIOInputPool* pool = OIIOInputPool::instance();
+            bool reused = false;
+            std::unique_ptr<OIIO::ImageInput> input = pool->checkOut(fileName, &reused);
+            core::ImageBuffer image;
+            core::Error error;
+
+            if (input && !reused)
+                stats->opens.fetch_add(1);
+
+            if (!input || !decode(input.get(), image, error)) {
+                pool->discard(std::move(input));
+                readAhead->release(key, next);
+                return;
+            }
 
-        d.input = std::move(newInput);
-        d.fileName = fileName;
+            pool->checkIn(fileName, std::move(input));
+            stats->decoded(timer.nsecsElapsed());
+            readAhead->insert(key, next, image);
+        });
     }
+}
 
-    // read scanlines using OpenImageIO into a temporary ImageBuffer using a
-    // normalized base pixel type (UINT8, HALF, or FLOAT). The buffer is then
-    // converted to the internal RGBA layout used by the reader.
+bool
+OIIOReaderPrivate::decode(OIIO::ImageInput* input, core::ImageBuffer& image, core::Error& error)
+{
+    // read scanlines using OpenImageIO straight into the internal RGBA layout
+    // using a normalized base pixel type (UINT8, HALF, or FLOAT). A compatible
+    // unshared image keeps its storage, the alpha fill runs on each block of
+    // scanlines while it is still in cache.
 
-    const OIIO::ImageSpec& spec = d.input->spec();
+    const OIIO::ImageSpec& spec = input->spec();
 
     const int width = spec.width;
     const int height = spec.height;
@@ -170,30 +628,39 @@ OIIOReaderPrivate::read()
     const core::ImageFormat::Type type = toImageType(baseType);
 
     if (type == core::ImageFormat::Type::Unknown) {
-        d.error = core::Error("oiioreader", "unsupported pixel format");
-        return d.timeStamp;
+        error = core::Error("oiioreader", "unsupported pixel format");
+        return false;
     }
 
     core::ImageFormat format(type);
     QRect dataWindow(0, 0, width, height);
     QRect displayWindow = dataWindow;
 
-    const int channels = spec.nchannels;
-    core::ImageBuffer image(dataWindow, displayWindow, format, channels);
+    if (!image.isAllocated() || image.dataWindow() != dataWindow || image.imageFormat().type() != type
+        || image.channels() != 4) {
+        image = core::ImageBuffer(dataWindow, displayWindow, format, 4);
+        image.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
+    }
     image.allocate();
 
-    bool ok = d.input->read_scanlines(0, 0, 0, height, 0, 0, channels, baseType, image.data(), OIIO::AutoStride,
-                                      OIIO::AutoStride);
-
-    if (!ok) {
-        std::string err = d.input->geterror();
-        d.error = core::Error("oiioreader", err.c_str());
-        return d.timeStamp;
+    const int channels = qMin(spec.nchannels, 4);
+    const OIIO::stride_t xstride = OIIO::stride_t(4 * format.size());
+    const OIIO::stride_t ystride = xstride * width;
+    const int rows = qMax(1, int((1 << 20) / ystride));
+
+    for (int y = 0; y < height; y += rows) {
+        const int end = qMin(y + rows, height);
+        quint8* data = image.data() + size_t(y) * size_t(ystride);
+        if (!input->read_scanlines(0, 0, spec.y + y, spec.y + end, 0, 0, channels, baseType, data, xstride,
+                                   ystride)) {
+            std::string err = input->geterror();
+            error = core::Error("oiioreader", err.c_str());
+            return false;
+        }
+        if (channels < 4)
+            expandRows(type, data, size_t(end - y) * size_t(width), channels);
     }
-
-    d.image = core::ImageBuffer::convert(image, 4);
-    d.timeStamp.setTicks(d.timeStamp.ticks() + d.timeStamp.tpf());
-    return d.timeStamp;
+    return true;
 }
 
 av::Time
@@ -210,44 +677,24 @@ OIIOReaderPrivate::seek(const av::TimeRange& range)
     d.timeRange = range;
     d.startStamp = range.start();
     d.timeStamp = d.startStamp;
-    if (d.input)
-        d.input->close();
-    d.input.reset();
     return d.timeStamp;
 }
 
 core::ImageFormat::Type
 OIIOReaderPrivate::toImageType(const OIIO::TypeDesc& type)
 {
+    // scalar base types are told apart by size, signedness and float, the
+    // same properties the image format trait table describes.
     using T = core::ImageFormat::Type;
-
-    if (type == OIIO::TypeDesc::UINT8)
-        return T::UInt8;
-    if (type == OIIO::TypeDesc::INT8)
-        return T::Int8;
-
-    if (type == OIIO::TypeDesc::UINT16)
-        return T::UInt16;
-    if (type == OIIO::TypeDesc::INT16)
-        return T::Int16;
-
-    if (type == OIIO::TypeDesc::UINT32)
-        return T::UInt32;
-    if (type == OIIO::TypeDesc::INT32)
-        return T::Int32;
-
-    if (type == OIIO::TypeDesc::UINT64)
-        return T::UInt64;
-    if (type == OIIO::TypeDesc::INT64)
-        return T::Int64;
-
-    if (type == OIIO::TypeDesc::HALF)
-        return T::Half;
-    if (type == OIIO::TypeDesc::FLOAT)
-        return T::Float;
-    if (type == OIIO::TypeDesc::DOUBLE)
-        return T::Double;
-
+    if (type.aggregate != OIIO::TypeDesc::SCALAR || type.arraylen != 0)
+        return T::Unknown;
+
+    for (int i = T::UInt8; i <= T::Double; ++i) {
+        const core::ImageFormat::Traits& traits = core::ImageFormat::traits(T(i));
+        if (type.basesize() == traits.size && type.is_floating_point() == traits.isFloat
+            && (traits.isFloat || type.is_signed() == traits.isSigned))
+            return traits.type;
+    }
     return T::Unknown;
 }
 
@@ -334,6 +781,12 @@ OIIOReader::supportsConcurrent() const
     return true;
 }
 
+bool
+OIIOReader::supportsFrameCache() const
+{
+    return p->d.readAhead > 0;
+}
+
 av::Time
 OIIOReader::read()
 {
@@ -397,7 +850,21 @@ OIIOReader::image() const
 core::MetaData
 OIIOReader::metaData() const
 {
-    return p->d.metaData;
+    core::MetaData metaData = p->d.metaData;
+    if (p->d.probe)
+        return metaData;
+
+    const OIIOReaderPrivate::Stats& stats = *p->d.stats;
+    const qint64 decodes = stats.decodes.load();
+    metaData.insert(core::MetaData::Group::Custom, "readAheadFrames", p->d.readAhead);
+    metaData.insert(core::MetaData::Group::Custom, "readAheadHits", stats.hits.load());
+    metaData.insert(core::MetaData::Group::Custom, "readAheadMisses", stats.misses.load());
+    metaData.insert(core::MetaData::Group::Custom, "inputOpens", stats.opens.load());
+    metaData.insert(core::MetaData::Group::Custom, "decodeFrames", decodes);
+    metaData.insert(core::MetaData::Group::Custom, "decodeAverageMs",
+                    decodes > 0 ? qreal(stats.decodeNs.load()) / decodes / 1e6 : 0.0);
+    metaData.insert(core::MetaData::Group::Custom, "decodeMaxMs", qreal(stats.decodeMaxNs.load()) / 1e6);
+    return metaData;
 }
 
 core::Error
@@ -5,6 +5,8 @@
 #include <flipmansdk/plugins/oiio/oiiowriter.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/typedesc.h>
+#include <QMutex>
+#include <memory>
 
 using namespace OIIO;
 
@@ -14,6 +16,8 @@ class OIIOWriterPrivate : public QSharedData {
 public:
     OIIOWriterPrivate();
     av::Time write(const core::ImageBuffer& image);
+    bool writeFrame(const core::ImageBuffer& image, qint64 frame);
+    void setError(const core::Error& error);
     OIIO::TypeDesc toTypeDesc(core::ImageFormat::Type imageFormat);
     static PluginHandler::Info info();
     static core::Plugin* creator();
@@ -25,6 +29,7 @@ public:
         av::Time timestamp;
         core::MetaData metaData;
         core::Error error;
+        std::shared_ptr<QMutex> mutex = std::make_shared<QMutex>();
     };
     Data d;
 };
@@ -34,7 +39,17 @@ OIIOWriterPrivate::OIIOWriterPrivate() { d.fps = av::Fps::fps24(); }
 av::Time
 OIIOWriterPrivate::write(const core::ImageBuffer& image)
 {
-    const qint64 frame = d.timestamp.frames();
+    if (writeFrame(image, d.timestamp.frames()))
+        d.timestamp.setTicks(d.timestamp.ticks() + d.timestamp.tpf());
+
+    return d.timestamp;
+}
+
+bool
+OIIOWriterPrivate::writeFrame(const core::ImageBuffer& image, qint64 frame)
+{
+    // every frame is written to its own file, nothing shared is modified
+    // here apart from the error, frames can be written concurrently.
     QString fileName = d.file.fileName(frame);
 
     const int width = image.dataWindow().width();
@@ -44,8 +59,8 @@ OIIOWriterPrivate::write(const core::ImageBuffer& image)
     const OIIO::TypeDesc type = toTypeDesc(image.imageFormat().type());
 
     if (type == OIIO::TypeDesc::UNKNOWN) {
-        d.error = core::Error("oiiowriter", "unsupported pixel format");
-        return d.timestamp;
+        setError(core::Error("oiiowriter", "unsupported pixel format"));
+        return false;
     }
 
     OIIO::ImageSpec spec(width, height, channels, type);
@@ -53,51 +68,44 @@ OIIOWriterPrivate::write(const core::ImageBuffer& image)
     auto out = OIIO::ImageOutput::create(fileName.toStdString());
 
     if (!out) {
-        d.error = core::Error("oiiowriter", "could not create image output");
-        return d.timestamp;
+        setError(core::Error("oiiowriter", "could not create image output"));
+        return false;
     }
 
     if (!out->open(fileName.toStdString(), spec)) {
-        d.error = core::Error("oiiowriter", out->geterror().c_str());
-        return d.timestamp;
+        setError(core::Error("oiiowriter", out->geterror().c_str()));
+        return false;
     }
 
-    const bool ok = out->write_image(type, image.data(), image.pixelSize(), image.strideSize());
+    const bool ok = out->write_image(type, image.constData(), image.pixelSize(), image.strideSize());
 
     out->close();
 
     if (!ok) {
-        d.error = core::Error("oiiowriter", out->geterror().c_str());
-        return d.timestamp;
+        setError(core::Error("oiiowriter", out->geterror().c_str()));
+        return false;
     }
+    return true;
+}
 
-    d.timestamp.setTicks(d.timestamp.ticks() + d.timestamp.tpf());
-
-    return d.timestamp;
+void
+OIIOWriterPrivate::setError(const core::Error& error)
+{
+    QMutexLocker locker(d.mutex.get());
+    d.error = error;
 }
 
 OIIO::TypeDesc
 OIIOWriterPrivate::toTypeDesc(core::ImageFormat::Type t)
 {
-    using T = core::ImageFormat::Type;
-    switch (t) {
-    case T::UInt8: return OIIO::TypeDesc::UINT8;
-    case T::Int8: return OIIO::TypeDesc::INT8;
-
-    case T::UInt16: return OIIO::TypeDesc::UINT16;
-    case T::Int16: return OIIO::TypeDesc::INT16;
-
-    case T::UInt32: return OIIO::TypeDesc::UINT32;
-    case T::Int32: return OIIO::TypeDesc::INT32;
-
-    case T::UInt64: return OIIO::TypeDesc::UINT64;
-    case T::Int64: return OIIO::TypeDesc::INT64;
-
-    case T::Half: return OIIO::TypeDesc::HALF;
-    case T::Float: return OIIO::TypeDesc::FLOAT;
-    case T::Double: return OIIO::TypeDesc::DOUBLE;
-    default: return OIIO::TypeDesc::UNKNOWN;
-    }
+    // indexed by core::ImageFormat::Type, same order as its trait table.
+    static constexpr OIIO::TypeDesc::BASETYPE types[] = { OIIO::TypeDesc::UNKNOWN, OIIO::TypeDesc::UINT8,
+                                                          OIIO::TypeDesc::INT8,    OIIO::TypeDesc::UINT16,
+                                                          OIIO::TypeDesc::INT16,   OIIO::TypeDesc::UINT32,
+                                                          OIIO::TypeDesc::INT32,   OIIO::TypeDesc::UINT64,
+                                                          OIIO::TypeDesc::INT64,   OIIO::TypeDesc::HALF,
+                                                          OIIO::TypeDesc::FLOAT,   OIIO::TypeDesc::DOUBLE };
+    return types[core::ImageFormat::traits(t).type];
 }
 
 PluginHandler::Info
@@ -176,6 +184,12 @@ OIIOWriter::supportsAudio() const
     return false;
 }
 
+bool
+OIIOWriter::supportsConcurrent() const
+{
+    return true;
+}
+
 QList<QString>
 OIIOWriter::extensions() const
 {
@@ -188,6 +202,13 @@ OIIOWriter::write(const core::ImageBuffer& image)
     return p->write(image);
 }
 
+av::Time
+OIIOWriter::write(const core::ImageBuffer& image, const av::Time& time)
+{
+    p->writeFrame(image, time.frames());
+    return time;
+}
+
 av::Time
 OIIOWriter::seek(const av::TimeRange& timerange)
 {
@@ -218,6 +239,7 @@ OIIOWriter::timeRange() const
 core::Error
 OIIOWriter::error() const
 {
+    QMutexLocker locker(p->d.mutex.get());
     return p->d.error;
 }
 
@@ -105,7 +105,7 @@ QtWriter::write(const core::ImageBuffer& image)
     if (copy.imageFormat() != core::ImageFormat::UInt8 || copy.channels() != 4) {
         copy = core::ImageBuffer::convert(copy, core::ImageFormat::UInt8, 4);
     }
-    QImage copyImage(reinterpret_cast<quint8*>(image.data()), copy.dataWindow().width(), copy.dataWindow().height(),
+    QImage copyImage(copy.constData(), copy.dataWindow().width(), copy.dataWindow().height(),
                      copy.strideSize(), QImage::Format_ARGB32);
     p->d.timestamp.setTicks(p->d.timestamp.ticks() + p->d.timestamp.tpf());
     p->d.error = core::Error();
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/render/lutcache.h>
+#include <flipmansdk/core/threadpool.h>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace flipman::sdk::render {
+
+namespace {
+    const quint32 lutMagic = 0x464d4c54;  // FMLT
+    const quint32 lutVersion = 1;
+    const int maxSize = 256;
+
+    struct Header {
+        quint32 magic = lutMagic;
+        quint32 version = lutVersion;
+        quint32 size = 0;
+        quint32 channels = 4;
+    };
+
+    const char*
+    nextLine(const char* it, const char* end)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(it, '\n', size_t(end - it)));
+        return newline ? newline + 1 : end;
+    }
+
+    const char*
+    skipSpace(const char* it, const char* end)
+    {
+        while (it < end && (*it == ' ' || *it == '\t' || *it == '\r'))
+            ++it;
+        return it;
+    }
+
+    bool
+    isDataLine(const char* it, const char* end)
+    {
+        it = skipSpace(it, end);
+        return it < end && ((*it >= '0' && *it <= '9') || *it == '-' || *it == '+' || *it == '.');
+    }
+
+    bool
+    startsWith(const char* it, const char* end, std::string_view keyword)
+    {
+        return size_t(end - it) >= keyword.size() && std::memcmp(it, keyword.data(), keyword.size()) == 0;
+    }
+
+    qint64
+    countDataLines(const char* it, const char* end)
+    {
+        qint64 count = 0;
+        for (; it < end; it = nextLine(it, end)) {
+            if (isDataLine(it, end))
+                ++count;
+        }
+        return count;
+    }
+
+    bool
+    parseDataLines(const char* it, const char* end, float* dst)
+    {
+        // values are parsed in place, from_chars neither allocates nor
+        // depends on the locale.
+        for (; it < end; it = nextLine(it, end)) {
+            if (!isDataLine(it, end))
+                continue;
+            const char* lineEnd = nextLine(it, end);
+            for (int c = 0; c < 3; ++c) {
+                it = skipSpace(it, lineEnd);
+                if (it < lineEnd && *it == '+')
+                    ++it;
+                const std::from_chars_result result = std::from_chars(it, lineEnd, dst[c]);
+                if (result.ec != std::errc())
+                    return false;
+                it = result.ptr;
+            }
+            dst[3] = 1.0f;
+            dst += 4;
+        }
+        return true;
+    }
+}  // namespace
+
+class LutCachePrivate {
+public:
+    QString fileName(const QByteArray& hash) const;
+    static LutCache::Lut read(const QString& filePath);
+    static bool write(const QString& filePath, const LutCache::Lut& lut);
+    struct Data {
+        mutable QMutex mutex;
+        QString path;
+        QString dir;
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 rejects = 0;
+        qint64 writes = 0;
+    };
+    Data d;
+};
+
+QString
+LutCachePrivate::fileName(const QByteArray& hash) const
+{
+    return QString::fromLatin1(hash) + ".lut";
+}
+
+LutCache::Lut
+LutCachePrivate::read(const QString& filePath)
+{
+    LutCache::Lut lut;
+    auto file = std::make_shared<QFile>(filePath);
+    if (!file->open(QIODevice::ReadOnly) || file->size() < qint64(sizeof(Header)))
+        return lut;
+
+    const uchar* mapped = file->map(0, file->size());
+    if (!mapped)
+        return lut;
+
+    // the size is checked before it is used, a corrupt header must not
+    // overflow the expected file size.
+    Header header;
+    std::memcpy(&header, mapped, sizeof(header));
+    if (header.magic != lutMagic || header.version != lutVersion || header.size < 2 || header.size > quint32(maxSize)
+        || header.channels != 4)
+        return lut;
+
+    const qint64 bytes = qint64(header.size) * header.size * header.size * header.channels * qint64(sizeof(float));
+    if (file->size() != qint64(sizeof(header)) + bytes)
+        return lut;
+
+    lut.mapping = file;
+    lut.size = int(header.size);
+    lut.rgba32f = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped + sizeof(header)), bytes);
+    return lut;
+}
+
+bool
+LutCachePrivate::write(const QString& filePath, const LutCache::Lut& lut)
+{
+    // entries are written to a temporary file and renamed into place.
+    if (!QDir().mkpath(QFileInfo(filePath).path()))
+        return false;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    Header header;
+    header.size = quint32(lut.size);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(lut.rgba32f);
+    return file.commit();
+}
+
+LutCache::LutCache()
+    : p(new LutCachePrivate())
+{
+    setPath(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("luts"));
+}
+
+LutCache::~LutCache() {}
+
+LutCache::Lut
+LutCache::load(const QString& filename, const QByteArray& hash, bool* cached)
+{
+    if (cached)
+        *cached = false;
+
+    QMutexLocker locker(&p->d.mutex);
+    const QString dir = p->d.dir;
+    locker.unlock();
+
+    if (dir.isEmpty() || hash.isEmpty())
+        return parse(filename);
+
+    const QString filePath = QDir(dir).filePath(p->fileName(hash));
+    Lut lut = LutCachePrivate::read(filePath);
+    if (lut.isValid()) {
+        locker.relock();
+        p->d.hits++;
+        if (cached)
+            *cached = true;
+        return lut;
+    }
+
+    const bool rejected = QFile::exists(filePath) && QFile::remove(filePath);
+    lut = parse(filename);
+    const bool written = lut.isValid() && LutCachePrivate::write(filePath, lut);
+    if (lut.isValid() && !written)
+        qWarning() << "lutcache: could not write LUT cache:" << filePath;
+
+    locker.relock();
+    p->d.misses++;
+    if (rejected)
+        p->d.rejects++;
+    if (written)
+        p->d.writes++;
+    return lut;
+}
+
+QString
+LutCache::filePath(const QByteArray& hash) const
+{
+    QMutexLocker locker(&p->d.mutex);
+    if (p->d.dir.isEmpty() || hash.isEmpty())
+        return QString();
+
+    return QDir(p->d.dir).filePath(p->fileName(hash));
+}
+
+void
+LutCache::clear()
+{
+    QMutexLocker locker(&p->d.mutex);
+    if (p->d.dir.isEmpty())
+        return;
+
+    const QFileInfoList files = QDir(p->d.dir).entryInfoList({ "*.lut" }, QDir::Files);
+    for (const QFileInfo& file : files)
+        QFile::remove(file.filePath());
+}
+
+QString
+LutCache::path() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.path;
+}
+
+void
+LutCache::setPath(const QString& path)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.path = path;
+    p->d.dir = path.isEmpty() ? QString() : QDir(path).filePath(QString("v%1").arg(lutVersion));
+}
+
+LutCache::Stats
+LutCache::stats() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    Stats stats;
+    stats.hits = p->d.hits;
+    stats.misses = p->d.misses;
+    stats.rejects = p->d.rejects;
+    stats.writes = p->d.writes;
+    return stats;
+}
+
+void
+LutCache::resetStats()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.hits = 0;
+    p->d.misses = 0;
+    p->d.rejects = 0;
+    p->d.writes = 0;
+}
+
+LutCache::Lut
+LutCache::parse(const QString& filename)
+{
+    Lut lut;
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "lutcache: could not open LUT:" << filename;
+        return lut;
+    }
+
+    const qint64 fileSize = file.size();
+    const uchar* mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    const QByteArray bytes = mapped ? QByteArray() : file.readAll();
+    const char* begin = mapped ? reinterpret_cast<const char*>(mapped) : bytes.constData();
+    const char* end = begin + (mapped ? fileSize : bytes.size());
+
+    // keywords come before the first data line.
+    int lutSize = 0;
+    const char* it = begin;
+    for (; it < end && !isDataLine(it, end); it = nextLine(it, end)) {
+        const char* line = skipSpace(it, end);
+        if (startsWith(line, end, "LUT_3D_SIZE")) {
+            line = skipSpace(line + 11, end);
+            std::from_chars(line, end, lutSize);
+        }
+        else if (startsWith(line, end, "LUT_1D_SIZE")) {
+            qWarning() << "lutcache: 1D LUTs are not supported:" << filename;
+            return lut;
+        }
+    }
+
+    if (lutSize < 2 || lutSize > maxSize) {
+        qWarning() << "lutcache: invalid LUT size:" << filename << lutSize;
+        return lut;
+    }
+
+    // the data section is split at line boundaries, chunks are counted and
+    // then parsed straight into place in parallel.
+    const qint64 chunkBytes = 256 * 1024;
+    const qint64 chunks = qMax<qint64>(1, (end - it) / chunkBytes);
+    std::vector<const char*> bounds(size_t(chunks + 1), end);
+    bounds[0] = it;
+    for (qint64 c = 1; c < chunks; ++c)
+        bounds[size_t(c)] = nextLine(it + c * chunkBytes - 1, end);
+
+    std::vector<qint64> offsets(size_t(chunks + 1), 0);
+    core::threadPool()->parallelFor(chunks, [&](qint64 c) {
+        offsets[size_t(c + 1)] = countDataLines(bounds[size_t(c)], bounds[size_t(c + 1)]);
+    });
+    for (qint64 c = 0; c < chunks; ++c)
+        offsets[size_t(c + 1)] += offsets[size_t(c)];
+
+    const qint64 expectedTriplets = qint64(lutSize) * lutSize * lutSize;
+    if (offsets.back() != expectedTriplets) {
+        qWarning() << "lutcache: invalid LUT value count:" << filename << "expected" << expectedTriplets * 3 << "got"
+                   << offsets.back() * 3;
+        return lut;
+    }
+
+    lut.rgba32f.resize(expectedTriplets * 4 * qint64(sizeof(float)));
+    float* dst = reinterpret_cast<float*>(lut.rgba32f.data());
+    std::atomic<bool> parsed { true };
+    core::threadPool()->parallelFor(chunks, [&](qint64 c) {
+        if (!parseDataLines(bounds[size_t(c)], bounds[size_t(c + 1)], dst + offsets[size_t(c)] * 4))
+            parsed = false;
+    });
+
+    if (!parsed) {
+        qWarning() << "lutcache: invalid LUT value:" << filename;
+        lut.rgba32f.clear();
+        return lut;
+    }
+
+    lut.size = lutSize;
+    qDebug() << "lutcache: loaded LUT" << filename << "size" << lut.size << "bytes" << lut.rgba32f.size();
+    return lut;
+}
+
+LutCache*
+LutCache::instance()
+{
+    static LutCache cache;
+    return &cache;
+}
+
+}  // namespace flipman::sdk::render
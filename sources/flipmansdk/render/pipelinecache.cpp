@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/render/pipelinecache.h>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace flipman::sdk::render {
+
+namespace {
+    const quint32 magic = 0x464d5043;  // FMPC
+    const quint32 version = 1;
+}  // namespace
+
+class PipelineCachePrivate {
+public:
+    static QByteArray deviceKey(QRhi* rhi);
+    static QByteArray hash(const QByteArray& data);
+    QString fileName(const QByteArray& key) const;
+    static bool read(const QString& filePath, const QByteArray& key, QByteArray& data);
+    static qint64 write(const QString& filePath, const QByteArray& key, const QByteArray& data);
+    struct Data {
+        mutable QMutex mutex;
+        QString path;
+        QString dir;
+        QHash<QString, QByteArray> hashes;
+        qint64 loads = 0;
+        qint64 rejects = 0;
+        qint64 saves = 0;
+        qint64 loadedBytes = 0;
+        qint64 savedBytes = 0;
+    };
+    Data d;
+};
+
+QByteArray
+PipelineCachePrivate::deviceKey(QRhi* rhi)
+{
+    // pipeline data is only valid for the backend and device that produced
+    // it, the driver version is checked by the backends themselves.
+    const QRhiDriverInfo info = rhi->driverInfo();
+    return QByteArray(rhi->backendName()) + ':' + QByteArray::number(info.vendorId, 16) + ':'
+           + QByteArray::number(info.deviceId, 16) + ':' + QByteArray::number(int(info.deviceType)) + ':'
+           + info.deviceName;
+}
+
+QByteArray
+PipelineCachePrivate::hash(const QByteArray& data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QString
+PipelineCachePrivate::fileName(const QByteArray& key) const
+{
+    return QString::fromLatin1(hash(key).toHex()) + ".bin";
+}
+
+bool
+PipelineCachePrivate::read(const QString& filePath, const QByteArray& key, QByteArray& data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    QByteArray fileKey;
+    QByteArray fileHash;
+    stream >> fileMagic >> fileVersion >> fileKey >> data >> fileHash;
+    if (stream.status() != QDataStream::Ok || !stream.atEnd() || fileMagic != magic || fileVersion != version)
+        return false;
+
+    return fileKey == key && !data.isEmpty() && fileHash == hash(data);
+}
+
+qint64
+PipelineCachePrivate::write(const QString& filePath, const QByteArray& key, const QByteArray& data)
+{
+    // data is written to a temporary file and renamed into place.
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return -1;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << magic << version << key << data << hash(data);
+    const qint64 bytes = file.size();
+    if (stream.status() != QDataStream::Ok || !file.commit())
+        return -1;
+
+    return bytes;
+}
+
+PipelineCache::PipelineCache()
+    : p(new PipelineCachePrivate())
+{
+    setPath(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("pipelines"));
+}
+
+PipelineCache::~PipelineCache() {}
+
+bool
+PipelineCache::load(QRhi* rhi)
+{
+    if (!rhi)
+        return false;
+
+    const QByteArray key = PipelineCachePrivate::deviceKey(rhi);
+    QMutexLocker locker(&p->d.mutex);
+    if (p->d.dir.isEmpty())
+        return false;
+
+    const QString name = p->fileName(key);
+    const QString filePath = QDir(p->d.dir).filePath(name);
+    QByteArray data;
+    if (!PipelineCachePrivate::read(filePath, key, data)) {
+        if (QFile::exists(filePath)) {
+            QFile::remove(filePath);
+            p->d.rejects++;
+        }
+        return false;
+    }
+
+    // the backend validates its own header, data it rejects leaves the
+    // device cold and exports nothing, it is replaced on the next save.
+    rhi->setPipelineCacheData(data);
+    if (rhi->pipelineCacheData().isEmpty()) {
+        p->d.rejects++;
+        return false;
+    }
+    p->d.hashes.insert(name, PipelineCachePrivate::hash(data));
+    p->d.loads++;
+    p->d.loadedBytes += data.size();
+    return true;
+}
+
+bool
+PipelineCache::save(QRhi* rhi)
+{
+    if (!rhi)
+        return false;
+
+    const QByteArray data = rhi->pipelineCacheData();
+    if (data.isEmpty())
+        return false;
+
+    const QByteArray key = PipelineCachePrivate::deviceKey(rhi);
+    const QByteArray dataHash = PipelineCachePrivate::hash(data);
+    QMutexLocker locker(&p->d.mutex);
+    if (p->d.dir.isEmpty())
+        return false;
+
+    const QString name = p->fileName(key);
+    if (p->d.hashes.value(name) == dataHash)
+        return false;
+
+    if (!QDir().mkpath(p->d.dir))
+        return false;
+
+    const qint64 bytes = PipelineCachePrivate::write(QDir(p->d.dir).filePath(name), key, data);
+    if (bytes < 0)
+        return false;
+
+    p->d.hashes.insert(name, dataHash);
+    p->d.saves++;
+    p->d.savedBytes += bytes;
+    return true;
+}
+
+QString
+PipelineCache::filePath(QRhi* rhi) const
+{
+    QMutexLocker locker(&p->d.mutex);
+    if (!rhi || p->d.dir.isEmpty())
+        return QString();
+
+    return QDir(p->d.dir).filePath(p->fileName(PipelineCachePrivate::deviceKey(rhi)));
+}
+
+void
+PipelineCache::clear()
+{
+    QMutexLocker locker(&p->d.mutex);
+    if (p->d.dir.isEmpty())
+        return;
+
+    const QFileInfoList files = QDir(p->d.dir).entryInfoList({ "*.bin" }, QDir::Files);
+    for (const QFileInfo& file : files)
+        QFile::remove(file.filePath());
+    p->d.hashes.clear();
+}
+
+QString
+PipelineCache::path() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.path;
+}
+
+void
+PipelineCache::setPath(const QString& path)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.path = path;
+    p->d.dir = path.isEmpty() ? QString()
+                              : QDir(path).filePath(QString("v%1-qt%2").arg(version).arg(qVersion()));
+    p->d.hashes.clear();
+}
+
+PipelineCache::Stats
+PipelineCache::stats() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    Stats stats;
+    stats.loads = p->d.loads;
+    stats.rejects = p->d.rejects;
+    stats.saves = p->d.saves;
+    stats.loadedBytes = p->d.loadedBytes;
+    stats.savedBytes = p->d.savedBytes;
+    return stats;
+}
+
+void
+PipelineCache::resetStats()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.loads = 0;
+    p->d.rejects = 0;
+    p->d.saves = 0;
+    p->d.loadedBytes = 0;
+    p->d.savedBytes = 0;
+}
+
+PipelineCache*
+PipelineCache::instance()
+{
+    static PipelineCache cache;
+    return &cache;
+}
+
+}  // namespace flipman::sdk::render
@@ -3,11 +3,16 @@
 // https://github.com/mikaelsundell/flipman
 
 #include <flipmansdk/render/renderdevice.h>
+#include <flipmansdk/render/pipelinecache.h>
+#if QT_CONFIG(opengl)
+#    include <QOffscreenSurface>
+#endif
 
 namespace flipman::sdk::render {
 
 class RenderDevicePrivate {
 public:
+    ~RenderDevicePrivate();
     bool create(RenderDevice::Backend backend, const QSize& size, RenderDevice::TargetFormat renderTargetFormat);
     bool beginFrame(QRhiCommandBuffer*& commandBuffer);
     void endFrame();
@@ -16,6 +21,9 @@ public:
     QImage readback() const;
     QRhi::Implementation toBackend(RenderDevice::Backend backend);
     struct Data {
+#if QT_CONFIG(opengl)
+        std::unique_ptr<QOffscreenSurface> fallbackSurface;
+#endif
         std::unique_ptr<QRhi> rhi;
         std::unique_ptr<QRhiTexture> colorTexture;
         std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
@@ -32,6 +40,12 @@ public:
     Data d;
 };
 
+RenderDevicePrivate::~RenderDevicePrivate()
+{
+    if (d.rhi)
+        render::pipelineCache()->save(d.rhi.get());
+}
+
 QRhi::Implementation
 RenderDevicePrivate::toBackend(RenderDevice::Backend backend)
 {
@@ -94,7 +108,13 @@ RenderDevicePrivate::create(RenderDevice::Backend backend, const QSize& size, Re
     case QRhi::D3D11: params = &d3dParams; break;
 #endif
 #if QT_CONFIG(opengl)
-    case QRhi::OpenGLES2: params = &glParams; break;
+    case QRhi::OpenGLES2:
+        // an offscreen device has no window, the context is made current on
+        // a fallback surface that outlives the rhi.
+        d.fallbackSurface.reset(QRhiGles2InitParams::newFallbackSurface());
+        glParams.fallbackSurface = d.fallbackSurface.get();
+        params = &glParams;
+        break;
 #endif
     default: params = &nullParams; break;
     }
@@ -107,7 +127,9 @@ RenderDevicePrivate::create(RenderDevice::Backend backend, const QSize& size, Re
     return false;
 #    endif
 #endif
-    d.rhi.reset(QRhi::create(rhiBackend, params));
+    // pipeline cache data is saved when the device is destroyed and restored
+    // by the render engine on the next device.
+    d.rhi.reset(QRhi::create(rhiBackend, params, QRhi::EnablePipelineCacheDataSave));
     if (!d.rhi) {
         d.error = core::Error("renderdevice", "failed to create rhi backend");
         return false;
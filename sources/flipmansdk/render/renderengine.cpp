@@ -5,6 +5,9 @@
 #include <flipmansdk/render/renderengine.h>
 #include <flipmansdk/core/application.h>
 #include <flipmansdk/core/style.h>
+#include <flipmansdk/core/threadpool.h>
+#include <flipmansdk/render/lutcache.h>
+#include <flipmansdk/render/pipelinecache.h>
 #include <flipmansdk/render/shadercompiler.h>
 #include <flipmansdk/render/shadercontract.h>
 #include <flipmansdk/render/shaderparser.h>
@@ -14,9 +17,12 @@
 #include <QFile>
 #include <QHash>
 #include <QMatrix4x4>
-#include <QRegularExpression>
-#include <QTextStream>
+#include <QMutex>
+#include <QPointer>
+#include <atomic>
+#include <cstring>
 #include <limits>
+#include <memory>
 
 #undef RENDERENGINE_STATS
 #undef RENDERENGINE_TRACE
@@ -150,11 +156,31 @@ vec4 odt(vec4 c)
 }
 )");
 
+    QByteArray
+    identityLut(int size)
+    {
+        QByteArray data;
+        data.resize(size * size * size * 4 * int(sizeof(float)));
+        float* dst = reinterpret_cast<float*>(data.data());
+        for (int z = 0; z < size; ++z) {
+            for (int y = 0; y < size; ++y) {
+                for (int x = 0; x < size; ++x) {
+                    *dst++ = float(x) / float(size - 1);
+                    *dst++ = float(y) / float(size - 1);
+                    *dst++ = float(z) / float(size - 1);
+                    *dst++ = 1.0f;
+                }
+            }
+        }
+        return data;
+    }
+
 }  // namespace
 
 class RenderEnginePrivate : public QSharedData {
 public:
     RenderEnginePrivate();
+    ~RenderEnginePrivate();
     bool init(const RenderContext& context, const RenderSpec& spec);
     void reset();
     void update(QRhiResourceUpdateBatch* updates);
@@ -184,26 +210,39 @@ public:
     bool updateBlitState(BlitState& state, QRhiRenderTarget* renderTarget, const RenderSpec& spec);
     void updateBlitTransform(BlitState& state, const RenderSpec& spec, QRhiResourceUpdateBatch* updates);
     void renderBlit(BlitState& state, const RenderSpec& spec, QRhiCommandBuffer* commandBuffer);
+    struct ReadbackSlot {
+        std::unique_ptr<QRhiBuffer> convertBuffer;
+        std::unique_ptr<QRhiShaderResourceBindings> convertBindings;
+        QRhiReadbackResult readbackResult;
+        core::ImageBuffer image;
+        QElapsedTimer timer;
+        qint64 frameIndex = -1;
+        bool pending = false;
+    };
     struct OutputState {
         RenderOutput* output = nullptr;
         BlitState blitState;
         std::unique_ptr<QRhiTexture> texture;
         std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
         std::unique_ptr<QRhiRenderPassDescriptor> renderPassDescriptor;
-        std::unique_ptr<QRhiBuffer> convertBuffer;
         std::unique_ptr<QRhiBuffer> convertUniformBuffer;
-        std::unique_ptr<QRhiShaderResourceBindings> convertBindings;
         std::unique_ptr<QRhiComputePipeline> convertPipeline;
-        QRhiReadbackResult readbackResult;
-        core::ImageBuffer image;
+        std::vector<std::unique_ptr<ReadbackSlot>> readbackSlots;
+        ReadbackSlot* readbackSlot = nullptr;
         RenderOutput::Format convertFormat = RenderOutput::Format::RGBA16F;
         RenderOutput::Format readbackFormat = RenderOutput::Format::RGBA16F;
         QSize size;
         QSize convertSize;
         QSize readbackSize;
         qsizetype readbackStride = 0;
-        quint64 readbackFrameIndex = 0;
-        bool readbackPending = false;
+        bool readbackPending() const
+        {
+            for (const std::unique_ptr<ReadbackSlot>& slot : readbackSlots) {
+                if (slot->pending)
+                    return true;
+            }
+            return false;
+        }
     };
     OutputState* outputState(RenderOutput* output);
     void pruneOutputStates();
@@ -211,117 +250,19 @@ public:
     void renderOutputState(OutputState& state, RenderOutput* output, QRhiCommandBuffer* commandBuffer);
     QString convertShaderName(RenderOutput::Format format) const;
     bool updateConvertState(OutputState& state, RenderOutput* output);
+    bool acquireReadbackSlot(OutputState& state, RenderOutput* output);
     void renderConvertState(OutputState& state, RenderOutput* output, QRhiCommandBuffer* commandBuffer);
     bool prepareReadbackState(OutputState& state, RenderOutput* output);
     void requestReadbackState(OutputState& state, RenderOutput* output, QRhiCommandBuffer* commandBuffer);
-    struct LutData {
-        int size = 0;
-        QByteArray rgba32f;
-        static QByteArray identityLut(int size)
-        {
-            QByteArray data;
-            data.resize(size * size * size * 4 * int(sizeof(float)));
-            float* dst = reinterpret_cast<float*>(data.data());
-            for (int z = 0; z < size; ++z) {
-                for (int y = 0; y < size; ++y) {
-                    for (int x = 0; x < size; ++x) {
-                        *dst++ = float(x) / float(size - 1);
-                        *dst++ = float(y) / float(size - 1);
-                        *dst++ = float(z) / float(size - 1);
-                        *dst++ = 1.0f;
-                    }
-                }
-            }
-            return data;
-        }
-        static LutData loadLut(const QString& filename)
-        {
-            LutData data;
-            QFile file(filename);
-            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                qWarning() << "renderengine: could not open LUT:" << filename;
-                return data;
-            }
-
-            int lutSize = 0;
-            QVector<float> values;
-
-            QTextStream stream(&file);
-            while (!stream.atEnd()) {
-                QString line = stream.readLine().trimmed();
-
-                if (line.isEmpty() || line.startsWith("#"))
-                    continue;
-
-                if (line.startsWith("TITLE"))
-                    continue;
-
-                if (line.startsWith("LUT_3D_SIZE")) {
-                    const QStringList tokens = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-                    if (tokens.size() >= 2)
-                        lutSize = tokens[1].toInt();
-                    continue;
-                }
-
-                if (line.startsWith("DOMAIN_MIN") || line.startsWith("DOMAIN_MAX"))
-                    continue;
-
-                const QStringList tokens = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-                if (tokens.size() < 3)
-                    continue;
-
-                bool okR = false;
-                bool okG = false;
-                bool okB = false;
-
-                const float r = tokens[0].toFloat(&okR);
-                const float g = tokens[1].toFloat(&okG);
-                const float b = tokens[2].toFloat(&okB);
-
-                if (okR && okG && okB) {
-                    values.append(r);
-                    values.append(g);
-                    values.append(b);
-                }
-            }
-
-            if (lutSize < 2) {
-                qWarning() << "renderengine: invalid LUT size:" << filename << lutSize;
-                return data;
-            }
-
-            const int expectedTriplets = lutSize * lutSize * lutSize;
-            if (values.size() != expectedTriplets * 3) {
-                qWarning() << "renderengine: invalid LUT value count:" << filename << "expected" << expectedTriplets * 3
-                           << "got" << values.size();
-                return data;
-            }
-
-            data.size = lutSize;
-            data.rgba32f.resize(expectedTriplets * 4 * int(sizeof(float)));
-
-            float* dst = reinterpret_cast<float*>(data.rgba32f.data());
-            const float* src = values.constData();
-
-            for (int i = 0; i < expectedTriplets; ++i) {
-                *dst++ = *src++;
-                *dst++ = *src++;
-                *dst++ = *src++;
-                *dst++ = 1.0f;
-            }
-
-            qDebug() << "renderengine: loaded LUT" << filename << "size" << data.size << "bytes" << data.rgba32f.size();
-
-            return data;
-        }
-        bool isValid() const { return size > 1 && !rgba32f.isEmpty(); }
+    struct LutTexture {
+        int size = 2;
+        std::unique_ptr<QRhiTexture> texture;
     };
     struct LutState {
         QString name;
         QString filename;
         int binding = -1;
-        int size = 2;
-        std::unique_ptr<QRhiTexture> texture;
+        std::shared_ptr<LutTexture> texture;
     };
     struct ImageState {
         enum class TextureType { Unknown, UInt8, Half, Float, Nv12, Uyvy };
@@ -339,6 +280,10 @@ public:
         std::vector<LutState> luts;
         QString lutKey;
         QString shaderKey;
+        QString vertexKey;
+        QString fragmentKey;
+        QString plainKey;
+        bool pipelinePending = false;
         void reset()
         {
             textureType = TextureType::Unknown;
@@ -353,20 +298,13 @@ public:
             imageData1.reset();
             effectParameterData.clear();
             shaderKey.clear();
+            vertexKey.clear();
+            fragmentKey.clear();
+            plainKey.clear();
+            pipelinePending = false;
             luts.clear();
             lutKey.clear();
         }
-        bool initLut(LutState& lut, const LutData& data, QRhi* rhi)
-        {
-            if (!rhi || !data.isValid())
-                return false;
-
-            lut.size = data.size;
-            lut.texture.reset(
-                rhi->newTexture(QRhiTexture::RGBA32F, lut.size, lut.size, lut.size, 1, QRhiTexture::ThreeDimensional));
-
-            return lut.texture && lut.texture->create();
-        }
         bool initTextures(const core::ImageBuffer& image, QRhi* rhi)
         {
             if (!rhi || !image.isValid())
@@ -472,7 +410,7 @@ public:
                 if (!texture1 || !imageData0.isValid() || !imageData1.isValid())
                     return 0;
 
-                QRhiTextureSubresourceUploadDescription yUpload(imageData0.planeData(0),
+                QRhiTextureSubresourceUploadDescription yUpload(imageData0.constPlaneData(0),
                                                                 static_cast<quint32>(imageData0.planeByteSize(0)));
                 yUpload.setDataStride(static_cast<quint32>(imageData0.planeStride(0)));
                 yUpload.setSourceSize(imageData0.planeSize(0));
@@ -480,7 +418,7 @@ public:
                 updates->uploadTexture(texture0.get(),
                                        QRhiTextureUploadDescription({ QRhiTextureUploadEntry(0, 0, yUpload) }));
 
-                QRhiTextureSubresourceUploadDescription uvUpload(imageData1.planeData(1),
+                QRhiTextureSubresourceUploadDescription uvUpload(imageData1.constPlaneData(1),
                                                                  static_cast<quint32>(imageData1.planeByteSize(1)));
                 uvUpload.setDataStride(static_cast<quint32>(imageData1.planeStride(1)));
                 uvUpload.setSourceSize(imageData1.planeSize(1));
@@ -497,7 +435,7 @@ public:
 
                 const QSize sourceSize(imageData0.dataWindow().width() / 2, imageData0.dataWindow().height());
 
-                QRhiTextureSubresourceUploadDescription subres(imageData0.data(),
+                QRhiTextureSubresourceUploadDescription subres(imageData0.constData(),
                                                                static_cast<quint32>(imageData0.byteSize()));
                 subres.setDataStride(static_cast<quint32>(imageData0.strideSize()));
                 subres.setSourceSize(sourceSize);
@@ -511,7 +449,7 @@ public:
             if (!imageData0.isValid())
                 return 0;
 
-            QRhiTextureSubresourceUploadDescription subres(imageData0.data(),
+            QRhiTextureSubresourceUploadDescription subres(imageData0.constData(),
                                                            static_cast<quint32>(imageData0.byteSize()));
             subres.setDataStride(static_cast<quint32>(imageData0.strideSize()));
             subres.setSourceSize(QSize(imageData0.dataWindow().width(), imageData0.dataWindow().height()));
@@ -521,30 +459,6 @@ public:
 
             return quint64(imageData0.byteSize());
         }
-        bool uploadLut(const LutState& state, const LutData& data, QRhiResourceUpdateBatch* updates)
-        {
-            if (!updates || !state.texture || !data.isValid())
-                return false;
-
-            const int bytesPerPixel = 4 * int(sizeof(float));
-            const int rowBytes = data.size * bytesPerPixel;
-            const int sliceBytes = data.size * rowBytes;
-
-            QVector<QRhiTextureUploadEntry> entries;
-            for (int z = 0; z < state.size; ++z) {
-                const char* slicePtr = data.rgba32f.constData() + z * sliceBytes;
-
-                QRhiTextureSubresourceUploadDescription desc(slicePtr, quint32(sliceBytes));
-                desc.setSourceSize(QSize(state.size, state.size));
-                desc.setDataStride(quint32(rowBytes));
-                entries.append(QRhiTextureUploadEntry(z, 0, desc));
-            }
-
-            QRhiTextureUploadDescription upload;
-            upload.setEntries(entries.cbegin(), entries.cend());
-            updates->uploadTexture(state.texture.get(), upload);
-            return true;
-        }
         static QRhiTexture::Format toTextureFormat(TextureType type)
         {
             switch (type) {
@@ -597,6 +511,29 @@ public:
     void parameterValue(char* dst, const ShaderDescriptor::ShaderParameter& param);
     QString loadShader(const QString& name);
     QShader compileShader(const QString& source, QShader::Stage stage);
+    enum class ShaderStatus { Ready, Pending, Failed };
+    ShaderStatus requestShader(const QString& source, QShader::Stage stage, QShader& shader);
+    ShaderStatus requestShader(const QString& source, QShader::Stage stage, QString& key, QShader& shader);
+    QString shaderKey(const QString& source, QShader::Stage stage) const;
+    ShaderCompiler::Options shaderOptions() const;
+    void precompile(const QList<ShaderDefinition>& effectDefinitions);
+    std::unique_ptr<QRhiGraphicsPipeline> createLayerPipeline(ImageState& imageState, const QShader& vertexShader,
+                                                              const QShader& fragmentShader);
+    template<typename Pipeline> bool createPipeline(Pipeline* pipeline)
+    {
+        // creation on a restored pipeline cache is timed apart from cold
+        // creation, the difference is what the cache saves.
+        QElapsedTimer timer;
+        timer.start();
+        const bool created = pipeline->create();
+#if RE_STATS_ENABLED
+        if (d.pipelineCacheWarm)
+            d.stats.pipelineCreateWarmNs += timer.nsecsElapsed();
+        else
+            d.stats.pipelineCreateColdNs += timer.nsecsElapsed();
+#endif
+        return created;
+    }
     QRectF aspectFit(const QSize& src, const QSize& dst);
     int alignTo(int value, int alignment);
     int std140BaseAlignment(ShaderDescriptor::ShaderParameter::Type type);
@@ -610,6 +547,8 @@ public:
     QString buildLayerShaderSource(ImageState::TextureType textureType, ColorSpace colorSpace,
                                    const ShaderDefinition* effectDefinition);
     QString buildLutShaderKey(const ShaderDefinition* effectDefinition);
+    LutCache::Lut loadLut(const QString& filename, const QByteArray& hash);
+    std::shared_ptr<LutTexture> acquireLutTexture(const QString& filename, QRhiResourceUpdateBatch* updates);
     struct FileHash {
         qint64 size = -1;
         qint64 modified = -1;
@@ -636,6 +575,17 @@ public:
         int generatedShaderSourceCacheMisses = 0;
         int shaderCacheHits = 0;
         int shaderCacheMisses = 0;
+        int shaderMemoryCacheHits = 0;
+        int shaderDiskCacheHits = 0;
+        int shaderDiskCacheMisses = 0;
+        int shaderJobsQueued = 0;
+        int pipelinesPending = 0;
+        int pipelinesFallback = 0;
+        int lutCacheHits = 0;
+        int lutCacheMisses = 0;
+        int lutTexturesShared = 0;
+        qint64 pipelineCreateColdNs = 0;
+        qint64 pipelineCreateWarmNs = 0;
         qint64 updateRenderStatesNs = 0;
         qint64 updateBlitNs = 0;
         qint64 renderSceneNs = 0;
@@ -650,6 +600,17 @@ public:
     };
     void resetFrameStats();
     void logFrameStats() const;
+    struct ShaderJob {
+        std::atomic<bool> done { false };
+        QShader shader;
+        core::Error error;
+        bool cached = false;
+        bool diskCached = false;
+    };
+    struct ShaderNotify {
+        QMutex mutex;
+        RenderEngine* engine = nullptr;
+    };
     struct Data {
         QRhi* deviceRhi = nullptr;
         SceneState sceneState;
@@ -669,7 +630,14 @@ public:
         QHash<QString, QString> shaderSourceCache;
         QHash<QString, QString> generatedShaderSourceCache;
         QHash<QString, QShader> shaderCache;
+        QHash<QString, std::shared_ptr<ShaderJob>> shaderJobs;
+        std::shared_ptr<ShaderNotify> shaderNotify = std::make_shared<ShaderNotify>();
+        QList<ShaderDefinition> precompileDefinitions;
+        bool precompile = false;
+        bool asyncShaders = true;
+        bool pipelineCacheWarm = false;
         QHash<QString, FileHash> fileCache;
+        QHash<QByteArray, std::weak_ptr<LutTexture>> lutTextures;
         FrameStats stats;
         core::Error error;
     };
@@ -678,6 +646,14 @@ public:
 
 RenderEnginePrivate::RenderEnginePrivate() {}
 
+RenderEnginePrivate::~RenderEnginePrivate()
+{
+    // jobs still running hold on to the notify state, they must not signal
+    // an engine that is gone.
+    QMutexLocker locker(&d.shaderNotify->mutex);
+    d.shaderNotify->engine = nullptr;
+}
+
 bool
 RenderEnginePrivate::init(const RenderContext& context, const RenderSpec& spec)
 {
@@ -688,6 +664,11 @@ RenderEnginePrivate::init(const RenderContext& context, const RenderSpec& spec)
 
     d.deviceRhi = context.rhi();
 
+    // pipeline cache data must be restored before the first pipeline is
+    // created on the device, creation only counts as warm when the backend
+    // accepted the data.
+    d.pipelineCacheWarm = render::pipelineCache()->load(d.deviceRhi);
+
     QRhiRenderTarget* renderTarget = context.surface().renderTarget();
     if (!renderTarget) {
         d.error = core::Error("renderengine", "invalid render target");
@@ -751,12 +732,23 @@ RenderEnginePrivate::init(const RenderContext& context, const RenderSpec& spec)
     d.imageStates.clear();
     d.quadState.uploaded = false;
     d.valid = true;
+
+    if (d.precompile)
+        precompile(d.precompileDefinitions);
     return true;
 }
 
 void
 RenderEnginePrivate::reset()
 {
+    // readback results are owned by the output states, pending ones must
+    // complete before the states go away.
+    for (const OutputState& state : d.outputStates) {
+        if (d.deviceRhi && state.readbackPending()) {
+            d.deviceRhi->finish();
+            break;
+        }
+    }
     d.deviceRhi = nullptr;
     d.sceneState = {};
     d.quadState = {};
@@ -770,7 +762,9 @@ RenderEnginePrivate::reset()
     d.shaderSourceCache.clear();
     d.generatedShaderSourceCache.clear();
     d.shaderCache.clear();
+    d.shaderJobs.clear();
     d.fileCache.clear();
+    d.lutTextures.clear();
 }
 
 void
@@ -835,7 +829,7 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
 
         const bool imageContentChanged = !imageState.imageData.isValid() || !image.isAllocated()
                                          || !imageState.imageData.isAllocated()
-                                         || imageState.imageData.data() != image.data();
+                                         || imageState.imageData.constData() != image.constData();
 
         const bool imageChanged = imageLayoutChanged || imageContentChanged;
 
@@ -935,6 +929,8 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
         if (shaderChanged) {
             RE_TRACE() << "renderengine: frame" << frameIndex << "layer" << i << "shader changed";
             imageState.shaderKey = newShaderKey;
+            imageState.fragmentKey.clear();
+            imageState.plainKey.clear();
             imageState.pipeline.reset();
             imageState.effectParameterData.clear();
         }
@@ -1009,6 +1005,8 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
             const QString key = buildLutShaderKey(effectDefinitionPtr);
 
             if (imageState.lutKey != key || imageState.luts.size() != size_t(params.size())) {
+                // textures still in use are shared again, not recreated.
+                const std::vector<LutState> previous = std::move(imageState.luts);
                 imageState.luts.clear();
                 imageState.lutKey = key;
 
@@ -1018,24 +1016,10 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
                     lutState.filename = params[l].value.isValid() ? params[l].value.toString()
                                                                   : params[l].defaultValue.toString();
                     lutState.binding = lutFirstBinding + l;
-
-                    LutData lutData = LutData::loadLut(lutState.filename);
-
-                    if (!lutData.isValid()) {
-                        qWarning() << "renderengine: failed to load LUT, using identity LUT:" << lutState.filename;
-                        lutData.size = 2;
-                        lutData.rgba32f = LutData::identityLut(lutData.size);
-                    }
-
-                    if (!imageState.initLut(lutState, lutData, d.deviceRhi)) {
-                        qWarning() << "renderengine: failed to create LUT texture" << lutState.name << lutState.filename
-                                   << "size" << lutData.size;
-                        continue;
-                    }
-
-                    if (!imageState.uploadLut(lutState, lutData, updates)) {
-                        qWarning() << "renderengine: failed to upload LUT texture" << lutState.name << lutState.filename
-                                   << "size" << lutData.size;
+                    lutState.texture = acquireLutTexture(lutState.filename, updates);
+                    if (!lutState.texture) {
+                        qWarning() << "renderengine: failed to create LUT texture" << lutState.name
+                                   << lutState.filename;
                         continue;
                     }
                     imageState.luts.push_back(std::move(lutState));
@@ -1082,7 +1066,7 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
             for (const auto& lut : imageState.luts) {
                 bindings << QRhiShaderResourceBinding::sampledTexture(lut.binding,
                                                                       QRhiShaderResourceBinding::FragmentStage,
-                                                                      lut.texture.get(), d.sampler.get());
+                                                                      lut.texture->texture.get(), d.sampler.get());
             }
 
             imageState.shaderBindings.reset(d.deviceRhi->newShaderResourceBindings());
@@ -1102,12 +1086,9 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
             RE_TRACE() << "renderengine: frame" << frameIndex << "layer" << i << "shader bindings reused";
         }
 
-        if (!imageState.pipeline) {
+        if (!imageState.pipeline || imageState.pipelinePending) {
             RE_TRACE() << "renderengine: frame" << frameIndex << "layer" << i << "creating pipeline";
 
-            imageState.pipeline.reset(d.deviceRhi->newGraphicsPipeline());
-            imageState.pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
-
             const QString fragmentSource = buildLayerShaderSource(imageState.textureType, image.colorSpace(),
                                                                   effectDefinitionPtr);
             if (fragmentSource.isEmpty()) {
@@ -1116,13 +1097,6 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
                 continue;
             }
 
-            const QShader fragmentShader = compileShader(fragmentSource, QShader::FragmentStage);
-            if (!fragmentShader.isValid()) {
-                qWarning() << "renderengine: fragment shader compilation failed:" << d.error.message();
-                imageState.pipeline.reset();
-                continue;
-            }
-
             const QString transformSource = loadShader("transform");
             if (transformSource.isEmpty()) {
                 qWarning() << "renderengine: could not load transform shader";
@@ -1130,37 +1104,60 @@ RenderEnginePrivate::update(QRhiResourceUpdateBatch* updates)
                 continue;
             }
 
-            const QShader vertexShader = compileShader(transformSource, QShader::VertexStage);
-            if (!vertexShader.isValid()) {
+            QShader vertexShader;
+            QShader fragmentShader;
+            // source hashes are kept on the layer while its jobs are pending.
+            const ShaderStatus vertexStatus = requestShader(transformSource, QShader::VertexStage, imageState.vertexKey,
+                                                            vertexShader);
+            if (vertexStatus == ShaderStatus::Failed) {
                 qWarning() << "renderengine: vertex shader compilation failed:" << d.error.message();
                 imageState.pipeline.reset();
+                imageState.pipelinePending = false;
                 continue;
             }
 
-            imageState.pipeline->setShaderStages(
-                { { QRhiShaderStage::Vertex, vertexShader }, { QRhiShaderStage::Fragment, fragmentShader } });
-
-            imageState.pipeline->setVertexInputLayout(d.quadState.layout);
-
-            QRhiGraphicsPipeline::TargetBlend blend;
-            blend.enable = true;
-            blend.srcColor = QRhiGraphicsPipeline::SrcAlpha;
-            blend.dstColor = QRhiGraphicsPipeline::OneMinusSrcAlpha;
-            blend.srcAlpha = QRhiGraphicsPipeline::One;
-            blend.dstAlpha = QRhiGraphicsPipeline::OneMinusSrcAlpha;
-
-            imageState.pipeline->setTargetBlends({ blend });
-            imageState.pipeline->setShaderResourceBindings(imageState.shaderBindings.get());
-            imageState.pipeline->setRenderPassDescriptor(d.sceneState.renderPassDescriptor.get());
-
-            if (!imageState.pipeline->create()) {
-                qWarning() << "renderengine: failed to create pipeline for layer" << i;
+            const ShaderStatus fragmentStatus = requestShader(fragmentSource, QShader::FragmentStage,
+                                                              imageState.fragmentKey, fragmentShader);
+            if (fragmentStatus == ShaderStatus::Failed) {
+                qWarning() << "renderengine: fragment shader compilation failed:" << d.error.message();
                 imageState.pipeline.reset();
+                imageState.pipelinePending = false;
                 continue;
             }
 
+            if (vertexStatus == ShaderStatus::Ready && fragmentStatus == ShaderStatus::Ready) {
+                imageState.pipeline = createLayerPipeline(imageState, vertexShader, fragmentShader);
+                imageState.pipelinePending = false;
+                if (!imageState.pipeline) {
+                    qWarning() << "renderengine: failed to create pipeline for layer" << i;
+                    continue;
+                }
+            }
+            else if (!imageState.pipeline) {
+                // the layer is drawn with the plain shader for its texture
+                // type while the effect variant bakes, the plain shader only
+                // uses the global and texture bindings of the layer.
+                imageState.pipelinePending = true;
+                if (effectDefinitionPtr && vertexStatus == ShaderStatus::Ready) {
+                    const QString plainSource = buildLayerShaderSource(imageState.textureType, image.colorSpace(),
+                                                                       nullptr);
+                    QShader plainShader;
+                    if (!plainSource.isEmpty()
+                        && requestShader(plainSource, QShader::FragmentStage, imageState.plainKey, plainShader)
+                               == ShaderStatus::Ready) {
+                        imageState.pipeline = createLayerPipeline(imageState, vertexShader, plainShader);
+
 #if RE_STATS_ENABLED
-            ++d.stats.pipelinesCreated;
+                        if (imageState.pipeline)
+                            ++d.stats.pipelinesFallback;
+#endif
+                    }
+                }
+            }
+
+#if RE_STATS_ENABLED
+            if (imageState.pipelinePending)
+                ++d.stats.pipelinesPending;
 #endif
         }
         else {
@@ -1273,7 +1270,7 @@ RenderEnginePrivate::render(const RenderContext& context, const RenderSpec& spec
 
         renderOutputState(*state, output, commandBuffer);
 
-        if (updateConvertState(*state, output)) {
+        if (updateConvertState(*state, output) && acquireReadbackSlot(*state, output)) {
             renderConvertState(*state, output, commandBuffer);
             if (prepareReadbackState(*state, output))
                 requestReadbackState(*state, output, commandBuffer);
@@ -1404,7 +1401,7 @@ RenderEnginePrivate::updateBlitState(BlitState& state, QRhiRenderTarget* renderT
         state.pipeline->setShaderResourceBindings(state.bindings.get());
         state.pipeline->setRenderPassDescriptor(state.renderPassDescriptor);
 
-        if (!state.pipeline->create()) {
+        if (!createPipeline(state.pipeline.get())) {
             d.error = core::Error("renderengine", "could not create blit pipeline");
             state.pipeline.reset();
             return false;
@@ -1488,6 +1485,9 @@ RenderEnginePrivate::pruneOutputStates()
             RE_TRACE() << "renderengine: output state pruned"
                        << "output" << it->output << "size" << it->size;
 
+            if (it->readbackPending())
+                d.deviceRhi->finish();
+
             it = d.outputStates.erase(it);
         }
         else {
@@ -1650,19 +1650,37 @@ RenderEnginePrivate::updateConvertState(OutputState& state, RenderOutput* output
     if (byteSize <= 0)
         return false;
 
-    const bool recreate = !state.convertBuffer || state.convertSize != size || state.convertFormat != format
-                          || state.convertBuffer->size() != quint32(byteSize);
+    const int depth = output->readbackDepth();
+    const bool recreate = state.readbackSlots.size() != size_t(depth) || state.convertSize != size
+                          || state.convertFormat != format
+                          || state.readbackSlots.front()->convertBuffer->size() != quint32(byteSize);
 
     if (recreate) {
-        state.convertBuffer.reset(
-            d.deviceRhi->newBuffer(QRhiBuffer::Static, QRhiBuffer::StorageBuffer, quint32(byteSize)));
+        // slots are only replaced once their readbacks have completed, the
+        // frames in between are dropped.
+        if (state.readbackPending()) {
+            RE_TRACE() << "renderengine: output convert recreate deferred"
+                       << "output" << output << "format" << int(format) << "size" << size;
 
-        if (!state.convertBuffer || !state.convertBuffer->create()) {
-            d.error = core::Error("renderengine", "could not create output convert buffer");
-            state.convertBuffer.reset();
+            output->dropped();
             return false;
         }
 
+        state.readbackSlot = nullptr;
+        state.readbackSlots.clear();
+        for (int i = 0; i < depth; ++i) {
+            std::unique_ptr<ReadbackSlot> slot = std::make_unique<ReadbackSlot>();
+            slot->convertBuffer.reset(
+                d.deviceRhi->newBuffer(QRhiBuffer::Static, QRhiBuffer::StorageBuffer, quint32(byteSize)));
+
+            if (!slot->convertBuffer || !slot->convertBuffer->create()) {
+                d.error = core::Error("renderengine", "could not create output convert buffer");
+                state.readbackSlots.clear();
+                return false;
+            }
+            state.readbackSlots.push_back(std::move(slot));
+        }
+
         state.convertUniformBuffer.reset(d.deviceRhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, 16));
 
         if (!state.convertUniformBuffer || !state.convertUniformBuffer->create()) {
@@ -1673,16 +1691,19 @@ RenderEnginePrivate::updateConvertState(OutputState& state, RenderOutput* output
 
         state.convertSize = size;
         state.convertFormat = format;
-        state.convertBindings.reset();
         state.convertPipeline.reset();
 
-        RE_TRACE() << "renderengine: output convert buffer created"
-                   << "output" << output << "format" << int(format) << "size" << size << "bytes" << byteSize;
+        RE_TRACE() << "renderengine: output convert buffers created"
+                   << "output" << output << "format" << int(format) << "size" << size << "bytes" << byteSize
+                   << "depth" << depth;
     }
 
-    if (!state.convertBindings) {
-        state.convertBindings.reset(d.deviceRhi->newShaderResourceBindings());
-        state.convertBindings->setBindings({
+    for (std::unique_ptr<ReadbackSlot>& slot : state.readbackSlots) {
+        if (slot->convertBindings)
+            continue;
+
+        slot->convertBindings.reset(d.deviceRhi->newShaderResourceBindings());
+        slot->convertBindings->setBindings({
             QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::ComputeStage,
                                                      state.convertUniformBuffer.get()),
 
@@ -1690,12 +1711,12 @@ RenderEnginePrivate::updateConvertState(OutputState& state, RenderOutput* output
                                                       d.sampler.get()),
 
             QRhiShaderResourceBinding::bufferLoadStore(2, QRhiShaderResourceBinding::ComputeStage,
-                                                       state.convertBuffer.get()),
+                                                       slot->convertBuffer.get()),
         });
 
-        if (!state.convertBindings->create()) {
+        if (!slot->convertBindings->create()) {
             d.error = core::Error("renderengine", "could not create output convert bindings");
-            state.convertBindings.reset();
+            slot->convertBindings.reset();
             return false;
         }
     }
@@ -1714,9 +1735,9 @@ RenderEnginePrivate::updateConvertState(OutputState& state, RenderOutput* output
 
         state.convertPipeline.reset(d.deviceRhi->newComputePipeline());
         state.convertPipeline->setShaderStage({ QRhiShaderStage::Compute, shader });
-        state.convertPipeline->setShaderResourceBindings(state.convertBindings.get());
+        state.convertPipeline->setShaderResourceBindings(state.readbackSlots.front()->convertBindings.get());
 
-        if (!state.convertPipeline->create()) {
+        if (!createPipeline(state.convertPipeline.get())) {
             d.error = core::Error("renderengine", "could not create output convert pipeline");
             state.convertPipeline.reset();
             return false;
@@ -1729,6 +1750,29 @@ RenderEnginePrivate::updateConvertState(OutputState& state, RenderOutput* output
     return true;
 }
 
+bool
+RenderEnginePrivate::acquireReadbackSlot(OutputState& state, RenderOutput* output)
+{
+    // a slot is free once its readback has completed and the output has
+    // released the frame delivered from it.
+    state.readbackSlot = nullptr;
+    if (state.readbackSlots.empty())
+        return false;
+
+    for (std::unique_ptr<ReadbackSlot>& slot : state.readbackSlots) {
+        if (!slot->pending && (slot->frameIndex < 0 || !output->isHeld(slot->frameIndex))) {
+            state.readbackSlot = slot.get();
+            return true;
+        }
+    }
+
+    RE_TRACE() << "renderengine: readback dropped"
+               << "output" << output << "frame" << d.frameIndex << "depth" << state.readbackSlots.size();
+
+    output->dropped();
+    return false;
+}
+
 void
 RenderEnginePrivate::renderConvertState(OutputState& state, RenderOutput* output, QRhiCommandBuffer* commandBuffer)
 {
@@ -1739,7 +1783,7 @@ RenderEnginePrivate::renderConvertState(OutputState& state, RenderOutput* output
     if (format == RenderOutput::Format::RGBA16F)
         return;
 
-    if (!state.convertPipeline || !state.convertBindings || !state.convertUniformBuffer)
+    if (!state.convertPipeline || !state.readbackSlot || !state.convertUniformBuffer)
         return;
 
     const RenderSpec outputSpec = output->pass();
@@ -1771,7 +1815,7 @@ RenderEnginePrivate::renderConvertState(OutputState& state, RenderOutput* output
 
     commandBuffer->beginComputePass();
     commandBuffer->setComputePipeline(state.convertPipeline.get());
-    commandBuffer->setShaderResources(state.convertBindings.get());
+    commandBuffer->setShaderResources(state.readbackSlot->convertBindings.get());
     commandBuffer->dispatch(groupsX, groupsY, 1);
     commandBuffer->endComputePass();
 }
@@ -1779,7 +1823,7 @@ RenderEnginePrivate::renderConvertState(OutputState& state, RenderOutput* output
 bool
 RenderEnginePrivate::prepareReadbackState(OutputState& state, RenderOutput* output)
 {
-    if (!output)
+    if (!output || !state.readbackSlot)
         return false;
 
     const RenderSpec outputSpec = output->pass();
@@ -1797,86 +1841,84 @@ RenderEnginePrivate::prepareReadbackState(OutputState& state, RenderOutput* outp
     if (stride <= 0 || byteSize <= 0)
         return false;
 
-    const bool changed = !state.image.isValid() || !state.image.isAllocated() || state.readbackFormat != format
-                         || state.readbackSize != size || state.readbackStride != stride
-                         || qsizetype(state.image.byteSize()) != byteSize;
+    if (state.readbackFormat != format || state.readbackSize != size || state.readbackStride != stride) {
+        for (std::unique_ptr<ReadbackSlot>& slot : state.readbackSlots)
+            slot->image = core::ImageBuffer();
+
+        state.readbackFormat = format;
+        state.readbackSize = size;
+        state.readbackStride = stride;
+    }
 
-    if (!changed)
+    core::ImageBuffer& image = state.readbackSlot->image;
+    if (image.isValid() && image.isAllocated() && qsizetype(image.byteSize()) == byteSize)
         return true;
 
-    state.image = core::ImageBuffer();
+    image = core::ImageBuffer();
 
     const QRect displayWindow(0, 0, size.width(), size.height());
 
     switch (format) {
     case RenderOutput::Format::RGBA16F: {
-        state.image = core::ImageBuffer(displayWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::Half),
-                                        4);
+        image = core::ImageBuffer(displayWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::Half), 4);
 
-        state.image.setPacking(core::ImageBuffer::Packing::Interleaved);
-        state.image.setSubsampling(core::ImageBuffer::Subsampling::None);
-        state.image.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
-        state.image.setPixelRange(core::ImageBuffer::PixelRange::Full);
+        image.setPacking(core::ImageBuffer::Packing::Interleaved);
+        image.setSubsampling(core::ImageBuffer::Subsampling::None);
+        image.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
+        image.setPixelRange(core::ImageBuffer::PixelRange::Full);
         break;
     }
 
     case RenderOutput::Format::RGBA8: {
-        state.image = core::ImageBuffer(displayWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::UInt8),
-                                        4);
+        image = core::ImageBuffer(displayWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::UInt8), 4);
 
-        state.image.setPacking(core::ImageBuffer::Packing::Interleaved);
-        state.image.setSubsampling(core::ImageBuffer::Subsampling::None);
-        state.image.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
-        state.image.setPixelRange(core::ImageBuffer::PixelRange::Full);
+        image.setPacking(core::ImageBuffer::Packing::Interleaved);
+        image.setSubsampling(core::ImageBuffer::Subsampling::None);
+        image.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
+        image.setPixelRange(core::ImageBuffer::PixelRange::Full);
         break;
     }
 
     case RenderOutput::Format::UYVY8: {
         const QRect dataWindow(0, 0, int(stride / 2), size.height());
 
-        state.image = core::ImageBuffer(dataWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::UInt8),
-                                        2);
+        image = core::ImageBuffer(dataWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::UInt8), 2);
 
-        state.image.setPacking(core::ImageBuffer::Packing::Packed);
-        state.image.setSubsampling(core::ImageBuffer::Subsampling::CS422);
-        state.image.setPixelLayout(core::ImageBuffer::PixelLayout::UYVY);
-        state.image.setPixelRange(core::ImageBuffer::PixelRange::Video);
+        image.setPacking(core::ImageBuffer::Packing::Packed);
+        image.setSubsampling(core::ImageBuffer::Subsampling::CS422);
+        image.setPixelLayout(core::ImageBuffer::PixelLayout::UYVY);
+        image.setPixelRange(core::ImageBuffer::PixelRange::Video);
         break;
     }
 
     case RenderOutput::Format::V210: {
         const QRect dataWindow(0, 0, int(stride), size.height());
 
-        state.image = core::ImageBuffer(dataWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::UInt8),
-                                        1);
+        image = core::ImageBuffer(dataWindow, displayWindow, core::ImageFormat(core::ImageFormat::Type::UInt8), 1);
 
-        state.image.setPacking(core::ImageBuffer::Packing::Packed);
-        state.image.setSubsampling(core::ImageBuffer::Subsampling::CS422);
-        state.image.setPixelLayout(core::ImageBuffer::PixelLayout::V210);
-        state.image.setPixelRange(core::ImageBuffer::PixelRange::Video);
+        image.setPacking(core::ImageBuffer::Packing::Packed);
+        image.setSubsampling(core::ImageBuffer::Subsampling::CS422);
+        image.setPixelLayout(core::ImageBuffer::PixelLayout::V210);
+        image.setPixelRange(core::ImageBuffer::PixelRange::Video);
         break;
     }
     }
 
-    state.image.allocate();
+    image.allocate();
 
-    if (!state.image.isValid() || !state.image.isAllocated()) {
+    if (!image.isValid() || !image.isAllocated()) {
         RE_TRACE() << "renderengine: readback image create failed"
                    << "output" << output << "format" << int(format) << "size" << size << "stride" << stride << "bytes"
                    << byteSize;
 
-        state.image = core::ImageBuffer();
+        image = core::ImageBuffer();
         return false;
     }
 
-    state.readbackFormat = format;
-    state.readbackSize = size;
-    state.readbackStride = stride;
-
     RE_TRACE() << "renderengine: readback image prepared"
-               << "output" << output << "format" << int(format) << "dataWindow" << state.image.dataWindow()
-               << "displayWindow" << state.image.displayWindow() << "stride" << state.image.strideSize() << "bytes"
-               << state.image.byteSize();
+               << "output" << output << "format" << int(format) << "dataWindow" << image.dataWindow()
+               << "displayWindow" << image.displayWindow() << "stride" << image.strideSize() << "bytes"
+               << image.byteSize();
 
     return true;
 }
@@ -1884,44 +1926,58 @@ RenderEnginePrivate::prepareReadbackState(OutputState& state, RenderOutput* outp
 void
 RenderEnginePrivate::requestReadbackState(OutputState& state, RenderOutput* output, QRhiCommandBuffer* commandBuffer)
 {
-    if (!output || !commandBuffer || state.readbackPending)
+    if (!output || !commandBuffer || !state.readbackSlot)
         return;
 
-    if (!state.convertBuffer || !state.image.isValid() || !state.image.isAllocated())
+    ReadbackSlot* slot = state.readbackSlot;
+    if (!slot->convertBuffer || !slot->image.isValid() || !slot->image.isAllocated())
         return;
 
-    const qsizetype byteSize = qsizetype(state.image.byteSize());
+    const qsizetype byteSize = qsizetype(slot->image.byteSize());
     if (byteSize <= 0 || byteSize > std::numeric_limits<quint32>::max())
         return;
 
-    state.readbackPending = true;
-    state.readbackFrameIndex = d.frameIndex;
-    state.readbackResult = {};
+    slot->pending = true;
+    slot->frameIndex = qint64(d.frameIndex);
+    slot->readbackResult = {};
+    slot->timer.start();
 
-    state.readbackResult.completed = [&state, output]() {
-        const qsizetype srcSize = state.readbackResult.data.size();
-        const qsizetype dstSize = qsizetype(state.image.byteSize());
+    slot->readbackResult.completed = [slot, output = QPointer<RenderOutput>(output)]() {
+        const qsizetype srcSize = slot->readbackResult.data.size();
+        const qsizetype dstSize = qsizetype(slot->image.byteSize());
+        const qint64 latencyNs = slot->timer.nsecsElapsed();
+        slot->pending = false;
 
         RE_TRACE() << "renderengine: readback complete"
-                   << "output" << output << "frame" << state.readbackFrameIndex << "srcBytes" << srcSize << "dstBytes"
-                   << dstSize;
+                   << "output" << output.data() << "frame" << slot->frameIndex << "srcBytes" << srcSize
+                   << "dstBytes" << dstSize << "latencyMs" << latencyNs / 1e6;
 
-        if (srcSize >= dstSize) {
-            memcpy(state.image.data(), state.readbackResult.data.constData(), size_t(dstSize));
+        if (!output)
+            return;
 
-            output->enqueueFrame(state.image, state.readbackFrameIndex);
+        if (srcSize < dstSize) {
+            output->dropped();
+            return;
         }
 
-        state.readbackPending = false;
+        // the slot is held until the output releases the frame. A consumer
+        // that keeps a copy of the image after release keeps its pixels, the
+        // slot moves on to a new block instead of writing into a shared one.
+        slot->image.allocate();
+        memcpy(slot->image.data(), slot->readbackResult.data.constData(), size_t(dstSize));
+
+        output->hold(slot->frameIndex);
+        output->delivered(latencyNs);
+        output->enqueueFrame(slot->image, slot->frameIndex);
     };
 
     QRhiResourceUpdateBatch* updates = d.deviceRhi->nextResourceUpdateBatch();
-    updates->readBackBuffer(state.convertBuffer.get(), 0, quint32(byteSize), &state.readbackResult);
+    updates->readBackBuffer(slot->convertBuffer.get(), 0, quint32(byteSize), &slot->readbackResult);
 
     commandBuffer->resourceUpdate(updates);
 
     RE_TRACE() << "renderengine: readback requested"
-               << "output" << output << "frame" << state.readbackFrameIndex << "bytes" << byteSize;
+               << "output" << output << "frame" << slot->frameIndex << "bytes" << byteSize;
 }
 
 void
@@ -2012,9 +2068,7 @@ RenderEnginePrivate::compileShader(const QString& source, QShader::Stage stage)
     if (!d.deviceRhi)
         return QShader();
 
-    const QRhi::Implementation impl = d.deviceRhi->backend();
-    const QByteArray hash = QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Sha1).toHex();
-    const QString key = QString("%1:%2:%3").arg(int(impl)).arg(int(stage)).arg(QString::fromLatin1(hash));
+    const QString key = shaderKey(source, stage);
 
 #if RE_TRACE_ENABLED
     const QString stageName = stage == QShader::VertexStage     ? "vertex"
@@ -2039,11 +2093,126 @@ RenderEnginePrivate::compileShader(const QString& source, QShader::Stage stage)
 #endif
     RE_TRACE() << "renderengine: shader cache miss:" << key;
 
+    // the compiler checks the persistent shader cache before baking.
     render::ShaderCompiler compiler;
+    QShader shader = compiler.compile(source, stage, shaderOptions());
+    if (!shader.isValid()) {
+        d.error = compiler.error();
+        return QShader();
+    }
+
+#if RE_STATS_ENABLED
+    if (compiler.isDiskCached())
+        ++d.stats.shaderDiskCacheHits;
+    else if (compiler.isCached())
+        ++d.stats.shaderMemoryCacheHits;
+    else
+        ++d.stats.shaderDiskCacheMisses;
+#endif
+
+    d.shaderCache.insert(key, shader);
+    return shader;
+}
+
+RenderEnginePrivate::ShaderStatus
+RenderEnginePrivate::requestShader(const QString& source, QShader::Stage stage, QShader& shader)
+{
+    QString key;
+    return requestShader(source, stage, key, shader);
+}
+
+RenderEnginePrivate::ShaderStatus
+RenderEnginePrivate::requestShader(const QString& source, QShader::Stage stage, QString& key, QShader& shader)
+{
+    if (!d.deviceRhi)
+        return ShaderStatus::Failed;
+
+    if (!d.asyncShaders) {
+        shader = compileShader(source, stage);
+        return shader.isValid() ? ShaderStatus::Ready : ShaderStatus::Failed;
+    }
+
+    // the key is only hashed when the caller has none cached for the source.
+    if (key.isEmpty())
+        key = shaderKey(source, stage);
+
+    const auto it = d.shaderCache.constFind(key);
+    if (it != d.shaderCache.constEnd()) {
+#if RE_STATS_ENABLED
+        ++d.stats.shaderCacheHits;
+#endif
+        shader = it.value();
+        return ShaderStatus::Ready;
+    }
+
+    std::shared_ptr<ShaderJob> job = d.shaderJobs.value(key);
+    if (!job) {
+#if RE_STATS_ENABLED
+        ++d.stats.shaderCacheMisses;
+        ++d.stats.shaderJobsQueued;
+#endif
+        RE_TRACE() << "renderengine: shader job queued:" << key;
+
+        // each job runs its own compiler, the persistent shader cache is
+        // shared and thread-safe and the compiler serializes the bakes.
+        job = std::make_shared<ShaderJob>();
+        d.shaderJobs.insert(key, job);
+        const ShaderCompiler::Options options = shaderOptions();
+        const std::shared_ptr<ShaderNotify> notify = d.shaderNotify;
+        core::threadPool()->start([job, notify, source, stage, options]() {
+            render::ShaderCompiler compiler;
+            job->shader = compiler.compile(source, stage, options);
+            job->error = compiler.error();
+            job->cached = compiler.isCached();
+            job->diskCached = compiler.isDiskCached();
+            job->done.store(true, std::memory_order_release);
+
+            QMutexLocker locker(&notify->mutex);
+            if (notify->engine)
+                QMetaObject::invokeMethod(notify->engine, &RenderEngine::updateRequested, Qt::QueuedConnection);
+        });
+        return ShaderStatus::Pending;
+    }
+
+    if (!job->done.load(std::memory_order_acquire))
+        return ShaderStatus::Pending;
+
+    // failed jobs are kept so the source is not baked again every frame.
+    if (!job->shader.isValid()) {
+        d.error = job->error;
+        return ShaderStatus::Failed;
+    }
+
+#if RE_STATS_ENABLED
+    if (job->diskCached)
+        ++d.stats.shaderDiskCacheHits;
+    else if (job->cached)
+        ++d.stats.shaderMemoryCacheHits;
+    else
+        ++d.stats.shaderDiskCacheMisses;
+#endif
+
+    shader = job->shader;
+    d.shaderCache.insert(key, shader);
+    d.shaderJobs.remove(key);
+    return ShaderStatus::Ready;
+}
+
+QString
+RenderEnginePrivate::shaderKey(const QString& source, QShader::Stage stage) const
+{
+    const QRhi::Implementation impl = d.deviceRhi->backend();
+    const QByteArray hash = QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QString("%1:%2:%3").arg(int(impl)).arg(int(stage)).arg(QString::fromLatin1(hash));
+}
+
+ShaderCompiler::Options
+RenderEnginePrivate::shaderOptions() const
+{
     render::ShaderCompiler::Options opts;
     opts.glslVersion = 440;
 
-    switch (impl) {
+    switch (d.deviceRhi->backend()) {
     case QRhi::Vulkan: opts.generateSpirv = true; break;
 
     case QRhi::Metal:
@@ -2065,15 +2234,83 @@ RenderEnginePrivate::compileShader(const QString& source, QShader::Stage stage)
         opts.generateHlsl = true;
         break;
     }
+    return opts;
+}
 
-    QShader shader = compiler.compile(source, stage, opts);
-    if (!shader.isValid()) {
-        d.error = compiler.error();
-        return QShader();
+void
+RenderEnginePrivate::precompile(const QList<ShaderDefinition>& effectDefinitions)
+{
+    if (!d.deviceRhi)
+        return;
+
+    struct Variant {
+        ImageState::TextureType textureType;
+        ColorSpace colorSpace;
+    };
+
+    // the color space only changes the shader for ycbcr texture types.
+    const QList<Variant> variants = {
+        { ImageState::TextureType::UInt8, ColorSpace::Rec709 },  { ImageState::TextureType::Half, ColorSpace::Rec709 },
+        { ImageState::TextureType::Float, ColorSpace::Rec709 },  { ImageState::TextureType::Nv12, ColorSpace::Rec601 },
+        { ImageState::TextureType::Nv12, ColorSpace::Rec709 },   { ImageState::TextureType::Nv12, ColorSpace::Rec2020 },
+        { ImageState::TextureType::Uyvy, ColorSpace::Rec601 },   { ImageState::TextureType::Uyvy, ColorSpace::Rec709 },
+        { ImageState::TextureType::Uyvy, ColorSpace::Rec2020 },
+    };
+
+    QList<const ShaderDefinition*> definitions = { nullptr };
+    for (const ShaderDefinition& effectDefinition : effectDefinitions) {
+        if (effectDefinition.isValid() && !effectDefinition.shaderCode().isEmpty())
+            definitions.append(&effectDefinition);
     }
 
-    d.shaderCache.insert(key, shader);
-    return shader;
+    // requests only queue jobs, the variants bake in parallel.
+    const bool async = d.asyncShaders;
+    d.asyncShaders = true;
+
+    QShader shader;
+    const QString transformSource = loadShader("transform");
+    if (!transformSource.isEmpty())
+        requestShader(transformSource, QShader::VertexStage, shader);
+
+    for (const Variant& variant : variants) {
+        for (const ShaderDefinition* definition : definitions) {
+            const QString source = buildLayerShaderSource(variant.textureType, variant.colorSpace, definition);
+            if (!source.isEmpty())
+                requestShader(source, QShader::FragmentStage, shader);
+        }
+    }
+    d.asyncShaders = async;
+}
+
+std::unique_ptr<QRhiGraphicsPipeline>
+RenderEnginePrivate::createLayerPipeline(ImageState& imageState, const QShader& vertexShader,
+                                         const QShader& fragmentShader)
+{
+    std::unique_ptr<QRhiGraphicsPipeline> pipeline(d.deviceRhi->newGraphicsPipeline());
+    pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    pipeline->setShaderStages(
+        { { QRhiShaderStage::Vertex, vertexShader }, { QRhiShaderStage::Fragment, fragmentShader } });
+
+    pipeline->setVertexInputLayout(d.quadState.layout);
+
+    QRhiGraphicsPipeline::TargetBlend blend;
+    blend.enable = true;
+    blend.srcColor = QRhiGraphicsPipeline::SrcAlpha;
+    blend.dstColor = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+    blend.srcAlpha = QRhiGraphicsPipeline::One;
+    blend.dstAlpha = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+
+    pipeline->setTargetBlends({ blend });
+    pipeline->setShaderResourceBindings(imageState.shaderBindings.get());
+    pipeline->setRenderPassDescriptor(d.sceneState.renderPassDescriptor.get());
+
+    if (!createPipeline(pipeline.get()))
+        return nullptr;
+
+#if RE_STATS_ENABLED
+    ++d.stats.pipelinesCreated;
+#endif
+    return pipeline;
 }
 
 QRectF
@@ -2403,6 +2640,75 @@ RenderEnginePrivate::fileHash(const QString& filename)
     return fileHash.hash;
 }
 
+LutCache::Lut
+RenderEnginePrivate::loadLut(const QString& filename, const QByteArray& hash)
+{
+    // parsed LUTs are cached by content hash, a copied or renamed file still
+    // hits the cache and an edited file misses it.
+    bool cached = false;
+    LutCache::Lut lut = lutCache()->load(filename, hash, &cached);
+#if RE_STATS_ENABLED
+    if (cached)
+        ++d.stats.lutCacheHits;
+    else
+        ++d.stats.lutCacheMisses;
+#endif
+    return lut;
+}
+
+std::shared_ptr<RenderEnginePrivate::LutTexture>
+RenderEnginePrivate::acquireLutTexture(const QString& filename, QRhiResourceUpdateBatch* updates)
+{
+    // layers that reference the same LUT content share one texture, it is
+    // released with the last layer using it.
+    const QByteArray hash = fileHash(filename);
+    const QByteArray key = hash.isEmpty() ? QByteArray("identity") : hash;
+    if (std::shared_ptr<LutTexture> texture = d.lutTextures.value(key).lock()) {
+#if RE_STATS_ENABLED
+        ++d.stats.lutTexturesShared;
+#endif
+        return texture;
+    }
+
+    LutCache::Lut data = hash.isEmpty() ? LutCache::Lut() : loadLut(filename, hash);
+    if (!data.isValid()) {
+        qWarning() << "renderengine: failed to load LUT, using identity LUT:" << filename;
+        data = LutCache::Lut();
+        data.size = 2;
+        data.rgba32f = identityLut(data.size);
+    }
+
+    auto texture = std::make_shared<LutTexture>();
+    texture->size = data.size;
+    texture->texture.reset(d.deviceRhi->newTexture(QRhiTexture::RGBA32F, data.size, data.size, data.size, 1,
+                                                   QRhiTexture::ThreeDimensional));
+    if (!texture->texture || !texture->texture->create())
+        return nullptr;
+
+    const int bytesPerPixel = 4 * int(sizeof(float));
+    const int rowBytes = data.size * bytesPerPixel;
+    const int sliceBytes = data.size * rowBytes;
+
+    QVector<QRhiTextureUploadEntry> entries;
+    for (int z = 0; z < data.size; ++z) {
+        const char* slicePtr = data.rgba32f.constData() + qint64(z) * sliceBytes;
+
+        QRhiTextureSubresourceUploadDescription desc(slicePtr, quint32(sliceBytes));
+        desc.setSourceSize(QSize(data.size, data.size));
+        desc.setDataStride(quint32(rowBytes));
+        entries.append(QRhiTextureUploadEntry(z, 0, desc));
+    }
+
+    QRhiTextureUploadDescription upload;
+    upload.setEntries(entries.cbegin(), entries.cend());
+    updates->uploadTexture(texture->texture.get(), upload);
+
+    for (auto it = d.lutTextures.begin(); it != d.lutTextures.end();)
+        it = it->expired() ? d.lutTextures.erase(it) : std::next(it);
+    d.lutTextures.insert(key, texture);
+    return texture;
+}
+
 QByteArray
 RenderEnginePrivate::textHash(const QString& text) const
 {
@@ -2438,14 +2744,23 @@ RenderEnginePrivate::logFrameStats() const
                        << " srcHit=" << d.stats.shaderSourceCacheHits << " srcMiss=" << d.stats.shaderSourceCacheMisses
                        << " genHit=" << d.stats.generatedShaderSourceCacheHits
                        << " genMiss=" << d.stats.generatedShaderSourceCacheMisses
-                       << " shaderHit=" << d.stats.shaderCacheHits << " shaderMiss=" << d.stats.shaderCacheMisses;
+                       << " shaderHit=" << d.stats.shaderCacheHits << " shaderMiss=" << d.stats.shaderCacheMisses
+                       << " memHit=" << d.stats.shaderMemoryCacheHits << " diskHit=" << d.stats.shaderDiskCacheHits
+                       << " diskMiss=" << d.stats.shaderDiskCacheMisses
+                       << " shaderJobs=" << d.stats.shaderJobsQueued << " pipePending=" << d.stats.pipelinesPending
+                       << " pipeFallback=" << d.stats.pipelinesFallback
+                       << " pipeColdMs=" << ms(d.stats.pipelineCreateColdNs)
+                       << " pipeWarmMs=" << ms(d.stats.pipelineCreateWarmNs) << " lutHit=" << d.stats.lutCacheHits
+                       << " lutMiss=" << d.stats.lutCacheMisses << " lutShared=" << d.stats.lutTexturesShared;
 #endif
 }
 
 RenderEngine::RenderEngine(QObject* parent)
     : QObject(parent)
     , p(new RenderEnginePrivate())
-{}
+{
+    p->d.shaderNotify->engine = this;
+}
 
 RenderEngine::~RenderEngine() = default;
 
@@ -2539,6 +2854,26 @@ RenderEngine::setRenderOutputs(const QList<RenderOutput*>& renderOutputs)
     p->d.renderOutputs = renderOutputs;
 }
 
+bool
+RenderEngine::asyncShaders() const
+{
+    return p->d.asyncShaders;
+}
+
+void
+RenderEngine::setAsyncShaders(bool async)
+{
+    p->d.asyncShaders = async;
+}
+
+void
+RenderEngine::precompile(const QList<ShaderDefinition>& effectDefinitions)
+{
+    p->d.precompileDefinitions = effectDefinitions;
+    p->d.precompile = true;
+    p->precompile(effectDefinitions);
+}
+
 bool
 RenderEngine::isValid() const
 {
@@ -2548,6 +2883,10 @@ RenderEngine::isValid() const
 void
 RenderEngine::reset()
 {
+    // pipeline cache data is saved while the device is still alive, callers
+    // reset the engine before they destroy the device.
+    if (p->d.deviceRhi)
+        render::pipelineCache()->save(p->d.deviceRhi);
     p->reset();
     p->d.imageLayers.clear();
 }
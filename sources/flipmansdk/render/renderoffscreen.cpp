@@ -88,7 +88,12 @@ RenderOffscreen::render()
         return {};
     }
 
+    // the frame is read back right away, layer shaders cannot be left to
+    // bake in the background.
+    const bool asyncShaders = p->d.renderEngine->asyncShaders();
+    p->d.renderEngine->setAsyncShaders(false);
     p->d.renderEngine->render(context, renderSpec, commandBuffer);
+    p->d.renderEngine->setAsyncShaders(asyncShaders);
 
     p->d.device->endFrame();
 
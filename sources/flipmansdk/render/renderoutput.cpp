@@ -10,10 +10,53 @@
 #include <QScopedPointer>
 #include <QStandardPaths>
 #include <QDir>
+#include <QMutex>
+#include <QSet>
+
+#include <atomic>
 
 
 namespace flipman::sdk::render {
 
+namespace {
+    void writeImage(const core::ImageBuffer& image)
+    {
+        static bool written = false;
+        if (written)
+            return;
+
+        if (!image.isValid() || !image.isAllocated())
+            return;
+
+        written = true;
+
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+        const QString filename = QDir(dir).filePath(QStringLiteral("flipman-renderoutput-rgba8.png"));
+
+        QFileInfo output(filename);
+
+        QScopedPointer<plugins::MediaWriter> writer(
+            core::pluginRegistry()->getPlugin<plugins::MediaWriter>(output.suffix()));
+
+        if (!writer) {
+            core::logErr() << "renderoutput: no writer found for extension:" << output.suffix() << Qt::endl;
+            return;
+        }
+
+        if (!writer->open(output)) {
+            core::logErr() << "renderoutput: could not open writer for file:" << output.filePath() << Qt::endl;
+            return;
+        }
+
+        if (!writer->write(image)) {
+            core::logErr() << "renderoutput: could not write image:" << output.filePath() << Qt::endl;
+            return;
+        }
+
+        qDebug() << "renderoutput: wrote debug image" << output.filePath();
+    }
+}  // namespace
+
 class RenderOutputPrivate : public QSharedData {
 public:
     RenderOutputPrivate();
@@ -24,6 +67,13 @@ public:
         bool enabled = false;
         RenderOutput::Format format = RenderOutput::Format::RGBA16F;
         RenderSpec spec;
+        int readbackDepth = 3;
+        mutable QMutex mutex;
+        QSet<qint64> held;
+        std::atomic<qint64> delivered { 0 };
+        std::atomic<qint64> dropped { 0 };
+        std::atomic<qint64> latencyNs { 0 };
+        std::atomic<qint64> latencyMaxNs { 0 };
     };
     Data d;
 };
@@ -81,6 +131,18 @@ RenderOutput::setRenderSpec(const RenderSpec& spec)
     }
 }
 
+int
+RenderOutput::readbackDepth() const
+{
+    return p->d.readbackDepth;
+}
+
+void
+RenderOutput::setReadbackDepth(int depth)
+{
+    p->d.readbackDepth = qMax(1, depth);
+}
+
 void
 RenderOutput::enqueueFrame(const core::ImageBuffer& image, qint64 frame)
 {
@@ -89,41 +151,72 @@ RenderOutput::enqueueFrame(const core::ImageBuffer& image, qint64 frame)
              << image.dataWindow() << "displayWindow" << image.displayWindow() << "format"
              << int(image.imageFormat().type()) << "channels" << image.channels() << "packing" << int(image.packing())
              << "subsampling" << int(image.subsampling()) << "stride" << image.strideSize() << "bytes"
-             << image.byteSize() << "data" << static_cast<const void*>(image.data());
+             << image.byteSize() << "data" << static_cast<const void*>(image.constData());
 
-    static bool written = false;
-    if (written)
-        return;
+    writeImage(image);
+    releaseFrame(frame);
+}
 
-    if (!image.isValid() || !image.isAllocated())
-        return;
+void
+RenderOutput::releaseFrame(qint64 frame)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.held.remove(frame);
+}
 
-    written = true;
+qint64
+RenderOutput::deliveredFrames() const
+{
+    return p->d.delivered.load();
+}
 
-    const QString dir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    const QString filename = QDir(dir).filePath(QStringLiteral("flipman-renderoutput-rgba8.png"));
+qint64
+RenderOutput::droppedFrames() const
+{
+    return p->d.dropped.load();
+}
 
-    QFileInfo output(filename);
+qreal
+RenderOutput::readbackLatencyMs() const
+{
+    const qint64 delivered = p->d.delivered.load();
+    return delivered > 0 ? qreal(p->d.latencyNs.load()) / delivered / 1e6 : 0.0;
+}
 
-    QScopedPointer<plugins::MediaWriter> writer(
-        core::pluginRegistry()->getPlugin<plugins::MediaWriter>(output.suffix()));
+qreal
+RenderOutput::readbackLatencyMaxMs() const
+{
+    return qreal(p->d.latencyMaxNs.load()) / 1e6;
+}
 
-    if (!writer) {
-        core::logErr() << "renderoutput: no writer found for extension:" << output.suffix() << Qt::endl;
-        return;
-    }
+bool
+RenderOutput::isHeld(qint64 frame) const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.held.contains(frame);
+}
 
-    if (!writer->open(output)) {
-        core::logErr() << "renderoutput: could not open writer for file:" << output.filePath() << Qt::endl;
-        return;
-    }
+void
+RenderOutput::hold(qint64 frame)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.held.insert(frame);
+}
 
-    if (!writer->write(image)) {
-        core::logErr() << "renderoutput: could not write image:" << output.filePath() << Qt::endl;
-        return;
-    }
+void
+RenderOutput::delivered(qint64 latencyNs)
+{
+    p->d.delivered.fetch_add(1);
+    p->d.latencyNs.fetch_add(latencyNs);
+    qint64 max = p->d.latencyMaxNs.load();
+    while (max < latencyNs && !p->d.latencyMaxNs.compare_exchange_weak(max, latencyNs))
+        ;
+}
 
-    qDebug() << "renderoutput: wrote debug image" << output.filePath();
+void
+RenderOutput::dropped()
+{
+    p->d.dropped.fetch_add(1);
 }
 
 }  // namespace flipman::sdk::render
@@ -0,0 +1,371 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/render/shadercache.h>
+#include <flipmansdk/core/threadpool.h>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <vector>
+
+namespace flipman::sdk::render {
+
+namespace {
+    const quint32 magic = 0x464d5343;  // FMSC
+    const quint32 version = 1;
+}  // namespace
+
+class ShaderCachePrivate {
+public:
+    void index();
+    void evict();
+    QString fileName(const QByteArray& key) const;
+    static bool read(const QString& filePath, QShader& shader);
+    static qint64 write(const QString& filePath, const QShader& shader);
+    static void touch(const QString& filePath);
+    struct Entry {
+        qint64 bytes = 0;
+        qint64 used = 0;
+    };
+    struct Data {
+        mutable QMutex mutex;
+        QString path;
+        QString dir;
+        qint64 budget = 256 * 1024 * 1024;
+        QCache<QString, QShader> shaders { 1024 };
+        QHash<QString, Entry> entries;
+        qint64 diskBytes = 0;
+        bool indexed = false;
+        qint64 memoryHits = 0;
+        qint64 diskHits = 0;
+        qint64 misses = 0;
+        qint64 writes = 0;
+        qint64 evictions = 0;
+    };
+    Data d;
+};
+
+void
+ShaderCachePrivate::index()
+{
+    // the directory is scanned once, entries written by other processes
+    // after that are picked up when read.
+    if (d.indexed || d.dir.isEmpty())
+        return;
+
+    d.indexed = true;
+    const QFileInfoList files = QDir(d.dir).entryInfoList({ "*.qsb" }, QDir::Files);
+    for (const QFileInfo& file : files) {
+        const Entry entry { file.size(), file.lastModified().toMSecsSinceEpoch() };
+        d.entries.insert(file.fileName(), entry);
+        d.diskBytes += entry.bytes;
+    }
+    evict();
+}
+
+void
+ShaderCachePrivate::evict()
+{
+    while (d.diskBytes > d.budget && !d.entries.isEmpty()) {
+        auto oldest = d.entries.begin();
+        for (auto it = d.entries.begin(); it != d.entries.end(); ++it) {
+            if (it->used < oldest->used)
+                oldest = it;
+        }
+        QFile::remove(QDir(d.dir).filePath(oldest.key()));
+        d.shaders.remove(oldest.key());
+        d.diskBytes -= oldest->bytes;
+        d.entries.erase(oldest);
+        d.evictions++;
+    }
+}
+
+QString
+ShaderCachePrivate::fileName(const QByteArray& key) const
+{
+    return QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex()) + ".qsb";
+}
+
+bool
+ShaderCachePrivate::read(const QString& filePath, QShader& shader)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    QByteArray data;
+    stream >> fileMagic >> fileVersion >> data;
+    if (stream.status() != QDataStream::Ok || !stream.atEnd() || fileMagic != magic || fileVersion != version)
+        return false;
+
+    shader = QShader::fromSerialized(data);
+    return shader.isValid();
+}
+
+qint64
+ShaderCachePrivate::write(const QString& filePath, const QShader& shader)
+{
+    // entries are written to a temporary file and renamed into place.
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return -1;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << magic << version << shader.serialized();
+    const qint64 bytes = file.size();
+    if (stream.status() != QDataStream::Ok || !file.commit())
+        return -1;
+
+    return bytes;
+}
+
+void
+ShaderCachePrivate::touch(const QString& filePath)
+{
+    // the modification time orders entries for eviction across sessions.
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadWrite))
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+ShaderCache::ShaderCache()
+    : p(new ShaderCachePrivate())
+{
+    setPath(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("shaders"));
+}
+
+ShaderCache::~ShaderCache() {}
+
+bool
+ShaderCache::find(const QByteArray& key, QShader& shader, bool* disk)
+{
+    QMutexLocker locker(&p->d.mutex);
+    const QString name = p->fileName(key);
+    if (const QShader* cachedShader = p->d.shaders.object(name)) {
+        shader = *cachedShader;
+        p->d.memoryHits++;
+        if (disk)
+            *disk = false;
+        return true;
+    }
+    if (p->d.dir.isEmpty()) {
+        p->d.misses++;
+        return false;
+    }
+
+    const QString filePath = QDir(p->d.dir).filePath(name);
+    locker.unlock();
+
+    QShader cached;
+    const bool valid = ShaderCachePrivate::read(filePath, cached);
+    if (valid)
+        ShaderCachePrivate::touch(filePath);
+    else if (QFile::exists(filePath))
+        QFile::remove(filePath);
+
+    locker.relock();
+    if (!valid) {
+        if (p->d.entries.contains(name)) {
+            p->d.diskBytes -= p->d.entries.value(name).bytes;
+            p->d.entries.remove(name);
+        }
+        p->d.misses++;
+        return false;
+    }
+    if (p->d.entries.contains(name))
+        p->d.entries[name].used = QDateTime::currentMSecsSinceEpoch();
+    p->d.shaders.insert(name, new QShader(cached));
+    p->d.diskHits++;
+    if (disk)
+        *disk = true;
+    shader = cached;
+    return true;
+}
+
+void
+ShaderCache::insert(const QByteArray& key, const QShader& shader)
+{
+    if (!shader.isValid())
+        return;
+
+    QMutexLocker locker(&p->d.mutex);
+    const QString name = p->fileName(key);
+    p->d.shaders.insert(name, new QShader(shader));
+    if (p->d.dir.isEmpty())
+        return;
+
+    p->index();
+    const QString dir = p->d.dir;
+    locker.unlock();
+
+    if (!QDir().mkpath(dir))
+        return;
+
+    const qint64 bytes = ShaderCachePrivate::write(QDir(dir).filePath(name), shader);
+    if (bytes < 0)
+        return;
+
+    locker.relock();
+    if (dir != p->d.dir)
+        return;
+
+    if (p->d.entries.contains(name))
+        p->d.diskBytes -= p->d.entries.value(name).bytes;
+    p->d.entries.insert(name, { bytes, QDateTime::currentMSecsSinceEpoch() });
+    p->d.diskBytes += bytes;
+    p->d.writes++;
+    p->evict();
+}
+
+int
+ShaderCache::warmUp()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->index();
+    const QString dir = p->d.dir;
+    QStringList names;
+    for (auto it = p->d.entries.constBegin(); it != p->d.entries.constEnd(); ++it) {
+        if (!p->d.shaders.contains(it.key()))
+            names.append(it.key());
+    }
+    locker.unlock();
+
+    std::vector<QShader> shaders(size_t(names.size()));
+    core::threadPool()->parallelFor(qint64(names.size()), [&](qint64 index) {
+        const QString filePath = QDir(dir).filePath(names[index]);
+        if (!ShaderCachePrivate::read(filePath, shaders[size_t(index)]))
+            QFile::remove(filePath);
+    });
+
+    locker.relock();
+    if (dir != p->d.dir)
+        return 0;
+
+    int loaded = 0;
+    for (qsizetype i = 0; i < names.size(); ++i) {
+        const QShader& shader = shaders[size_t(i)];
+        if (shader.isValid()) {
+            p->d.shaders.insert(names[i], new QShader(shader));
+            loaded++;
+        }
+        else if (p->d.entries.contains(names[i])) {
+            p->d.diskBytes -= p->d.entries.value(names[i]).bytes;
+            p->d.entries.remove(names[i]);
+        }
+    }
+    return loaded;
+}
+
+void
+ShaderCache::clear()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->index();
+    for (auto it = p->d.entries.constBegin(); it != p->d.entries.constEnd(); ++it)
+        QFile::remove(QDir(p->d.dir).filePath(it.key()));
+    p->d.shaders.clear();
+    p->d.entries.clear();
+    p->d.diskBytes = 0;
+}
+
+QString
+ShaderCache::path() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.path;
+}
+
+void
+ShaderCache::setPath(const QString& path)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.path = path;
+    p->d.dir = path.isEmpty() ? QString()
+                              : QDir(path).filePath(QString("v%1-qt%2").arg(version).arg(qVersion()));
+    p->d.shaders.clear();
+    p->d.entries.clear();
+    p->d.diskBytes = 0;
+    p->d.indexed = false;
+}
+
+qint64
+ShaderCache::budget() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return p->d.budget;
+}
+
+void
+ShaderCache::setBudget(qint64 bytes)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.budget = qMax<qint64>(0, bytes);
+    if (p->d.indexed)
+        p->evict();
+}
+
+int
+ShaderCache::memoryLimit() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    return int(p->d.shaders.maxCost());
+}
+
+void
+ShaderCache::setMemoryLimit(int entries)
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.shaders.setMaxCost(qMax(0, entries));
+}
+
+ShaderCache::Stats
+ShaderCache::stats() const
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->index();
+    Stats stats;
+    stats.memoryHits = p->d.memoryHits;
+    stats.diskHits = p->d.diskHits;
+    stats.misses = p->d.misses;
+    stats.writes = p->d.writes;
+    stats.evictions = p->d.evictions;
+    stats.entries = p->d.entries.size();
+    stats.memoryEntries = p->d.shaders.size();
+    stats.diskBytes = p->d.diskBytes;
+    stats.budgetBytes = p->d.budget;
+    return stats;
+}
+
+void
+ShaderCache::resetStats()
+{
+    QMutexLocker locker(&p->d.mutex);
+    p->d.memoryHits = 0;
+    p->d.diskHits = 0;
+    p->d.misses = 0;
+    p->d.writes = 0;
+    p->d.evictions = 0;
+}
+
+ShaderCache*
+ShaderCache::instance()
+{
+    static ShaderCache cache;
+    return &cache;
+}
+
+}  // namespace flipman::sdk::render
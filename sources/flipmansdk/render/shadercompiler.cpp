@@ -2,7 +2,9 @@
 // Copyright (c) 2024 - present Mikael Sundell
 // https://github.com/mikaelsundell/flipman
 
+#include <flipmansdk/render/shadercache.h>
 #include <flipmansdk/render/shadercompiler.h>
+#include <QMutex>
 #include <rhi/qshaderbaker.h>
 
 namespace flipman::sdk::render {
@@ -10,8 +12,12 @@ namespace flipman::sdk::render {
 class ShaderCompilerPrivate {
 public:
     QShader compile(const QString& source, QShader::Stage stage, const ShaderCompiler::Options& options);
+    QShader bake(const QString& source, QShader::Stage stage, const ShaderCompiler::Options& options);
+    static QByteArray cacheKey(const QString& source, QShader::Stage stage, const ShaderCompiler::Options& options);
     struct Data {
         core::Error error;
+        bool cached = false;
+        bool diskCached = false;
     };
     Data d;
 };
@@ -20,10 +26,29 @@ QShader
 ShaderCompilerPrivate::compile(const QString& source, QShader::Stage stage, const ShaderCompiler::Options& options)
 {
     d.error = core::Error();
+    d.cached = false;
+    d.diskCached = false;
     if (source.trimmed().isEmpty()) {
         d.error = core::Error("shadercompiler", "source is empty");
         return {};
     }
+    if (!options.cache)
+        return bake(source, stage, options);
+
+    const QByteArray key = cacheKey(source, stage, options);
+    QShader shader;
+    if (shaderCache()->find(key, shader, &d.diskCached)) {
+        d.cached = true;
+        return shader;
+    }
+    shader = bake(source, stage, options);
+    shaderCache()->insert(key, shader);
+    return shader;
+}
+
+QShader
+ShaderCompilerPrivate::bake(const QString& source, QShader::Stage stage, const ShaderCompiler::Options& options)
+{
     QShaderBaker baker;
     baker.setSourceString(source.toUtf8(), stage);
 
@@ -47,7 +72,13 @@ ShaderCompilerPrivate::compile(const QString& source, QShader::Stage stage, cons
     }
 
     baker.setSpirvOptions(spirvOpts);
+
+    // QShaderBaker makes no thread-safety guarantee for glslang and
+    // SPIRV-Cross, bakes on pool threads are serialized.
+    static QMutex bakeMutex;
+    QMutexLocker locker(&bakeMutex);
     QShader shader = baker.bake();
+    locker.unlock();
     if (!shader.isValid()) {
         d.error = core::Error("shadercompiler", baker.errorMessage());
         return QShader();
@@ -55,6 +86,24 @@ ShaderCompilerPrivate::compile(const QString& source, QShader::Stage stage, cons
     return shader;
 }
 
+QByteArray
+ShaderCompilerPrivate::cacheKey(const QString& source, QShader::Stage stage, const ShaderCompiler::Options& options)
+{
+    // the baker output depends on the runtime Qt version, the stage and the
+    // targets, bump the prefix when bake() changes its targets or variants.
+    QByteArray key = QByteArray("shadercompiler:1:") + qVersion();
+    key += QString(":%1:%2:%3%4%5%6:")
+               .arg(int(stage))
+               .arg(options.glslVersion)
+               .arg(int(options.generateSpirv))
+               .arg(int(options.generateMsl))
+               .arg(int(options.generateHlsl))
+               .arg(int(options.optimize))
+               .toLatin1();
+    key += source.toUtf8();
+    return key;
+}
+
 ShaderCompiler::ShaderCompiler(QObject* parent)
     : QObject(parent)
     , p(new ShaderCompilerPrivate())
@@ -80,4 +129,16 @@ ShaderCompiler::isValid() const
     return !p->d.error.hasError();
 }
 
+bool
+ShaderCompiler::isCached() const
+{
+    return p->d.cached;
+}
+
+bool
+ShaderCompiler::isDiskCached() const
+{
+    return p->d.diskCached;
+}
+
 }  // namespace flipman::sdk::render
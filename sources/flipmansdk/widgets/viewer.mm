@@ -6,6 +6,7 @@
 #include <flipmansdk/core/core.h>
 #include <flipmansdk/core/application.h>
 #include <flipmansdk/core/style.h>
+#include <flipmansdk/render/pipelinecache.h>
 #include <flipmansdk/render/renderengine.h>
 #include <flipmansdk/render/renderspec.h>
 #include <QColorSpace>
@@ -386,7 +387,11 @@ Viewer::Viewer(QWidget* parent)
     p->init();
 }
 
-Viewer::~Viewer() {}
+Viewer::~Viewer()
+{
+    if (rhi())
+        render::pipelineCache()->save(rhi());
+}
 
 void
 Viewer::initialize(QRhiCommandBuffer*)
@@ -400,6 +405,15 @@ Viewer::render(QRhiCommandBuffer* commandBuffer)
     p->render(commandBuffer);
 }
 
+void
+Viewer::releaseResources()
+{
+    // the widget's device is about to go away, its pipeline cache data is
+    // saved for the next one.
+    if (rhi())
+        render::pipelineCache()->save(rhi());
+}
+
 render::RenderEngine*
 Viewer::renderEngine() const
 {
@@ -412,7 +426,12 @@ Viewer::setRenderEngine(render::RenderEngine* renderEngine)
     if (p->d.renderEngine == renderEngine)
         return;
 
+    if (p->d.renderEngine)
+        disconnect(p->d.renderEngine, &render::RenderEngine::updateRequested, this, nullptr);
+
     p->d.renderEngine = renderEngine;
+    if (p->d.renderEngine)
+        connect(p->d.renderEngine, &render::RenderEngine::updateRequested, this, qOverload<>(&Viewer::update));
     p->updateView();
     update();
 }
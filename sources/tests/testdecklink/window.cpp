@@ -322,8 +322,10 @@ public:
                  << int(image.imageFormat().type()) << "channels" << image.channels() << "packing"
                  << int(image.packing()) << "stride" << image.strideSize() << "bytes" << image.byteSize();
 
+        // the callback copies into the DeckLink frame, the slot is free after.
         if (m_callback)
             m_callback(image, frame);
+        releaseFrame(frame);
     }
 
 private:
@@ -795,7 +797,7 @@ WindowPrivate::copyImageToDeckLinkFrame(const sdk::core::ImageBuffer& image)
         return false;
 
     auto* dst = static_cast<uint8_t*>(frameBytes);
-    const auto* src = static_cast<const uint8_t*>(image.data());
+    const auto* src = static_cast<const uint8_t*>(image.constData());
 
     for (int y = 0; y < height; ++y)
         std::memcpy(dst + size_t(y) * deckLinkRowBytes, src + size_t(y) * imageRowBytes, size_t(deckLinkRowBytes));
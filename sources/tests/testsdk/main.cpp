@@ -28,6 +28,7 @@ run()
 {
     const bool runContainers = false;
     const bool runTypes = false;
+    const bool runScanner = false;
     const bool runImage = false;
     const bool runMedia = false;
     const bool runTimer = false;
@@ -45,6 +46,9 @@ run()
         && !runTest("types", [] { return testFile() && testTime() && testTimeRange() && testFps() && testSmpte(); }))
         return false;
 
+    if (runScanner && !runTest("scanner", [] { return testFileScanner(); }))
+        return false;
+
     if (runImage && !runTest("image", [] { return testImage(); }))
         return false;
 
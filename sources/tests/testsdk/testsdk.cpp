@@ -5,7 +5,9 @@
 #include "testsdk.h"
 #include <QApplication>
 #include <QDebug>
+#include <QTemporaryDir>
 #include <QThread>
+#include <QtEndian>
 #include <flipmansdk/av/clip.h>
 #include <flipmansdk/av/fps.h>
 #include <flipmansdk/av/media.h>
@@ -21,21 +23,30 @@
 #include <flipmansdk/core/environment.h>
 #include <flipmansdk/core/file.h>
 #include <flipmansdk/core/filerange.h>
+#include <flipmansdk/core/filescanner.h>
+#include <flipmansdk/core/framecache.h>
 #include <flipmansdk/core/imagebuffer.h>
+#include <flipmansdk/core/imagebufferpool.h>
 #include <flipmansdk/core/log.h>
 #include <flipmansdk/core/system.h>
+#include <flipmansdk/core/threadpool.h>
 #include <flipmansdk/plugins/imageeffectreader.h>
 #include <flipmansdk/plugins/mediareader.h>
 #include <flipmansdk/plugins/mediawriter.h>
 #include <flipmansdk/plugins/pluginregistry.h>
+#include <flipmansdk/render/lutcache.h>
+#include <flipmansdk/render/pipelinecache.h>
+#include <flipmansdk/render/renderdevice.h>
 #include <flipmansdk/render/renderengine.h>
 #include <flipmansdk/render/renderoffscreen.h>
+#include <flipmansdk/render/shadercache.h>
 #include <flipmansdk/render/shadercompiler.h>
 #include <flipmansdk/render/shadercontract.h>
 #include <flipmansdk/render/shaderdefinition.h>
 #include <flipmansdk/render/shaderparser.h>
 #include <iostream>
 #include <rhi/qrhi.h>
+#include <type_traits>
 
 namespace flipman::sdk::test {
 namespace {
@@ -221,6 +232,109 @@ testFile()
         }
     }
 
+    core::FileRange range("/shots/plate.####.exr", 1001, 1010);
+    range.removeFrame(1004);
+    range.removeFrame(1005);
+    range.insertFrame(1013);
+    range.removeFrame(1001);
+
+    bool ok = true;
+    ok &= testValue(range.filePath(1002), QString("/shots/plate.1002.exr"), "file range path");
+    ok &= testValue(range.pattern(), QString("/shots/plate.####.exr"), "file range pattern");
+    ok &= testValue(range.start(), qint64(1002), "file range start");
+    ok &= testValue(range.end(), qint64(1013), "file range end");
+    ok &= testValue(range.size(), qint64(8), "file range size");
+    ok &= testValue(range.holes() == QList<qint64>({ 1004, 1005, 1011, 1012 }), true, "file range holes");
+    ok &= testValue(range.hasFrame(1005), false, "file range missing frame");
+
+    range.insertFrame(1005);
+    ok &= testValue(range.hasFrame(1005), true, "file range filled frame");
+    if (!ok) {
+        core::logErr() << "file range validation failed" << Qt::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool
+testFileScanner()
+{
+    core::logOut() << "test file scanner" << Qt::endl;
+
+    QTemporaryDir temp;
+    if (!temp.isValid()) {
+        core::logErr() << "could not create temporary directory" << Qt::endl;
+        return false;
+    }
+
+    const QList<qint64> counts = { 10000, 100000, 1000000 };
+    QStringList paths;
+    for (qint64 count : counts) {
+        const QString path = QString("%1/%2").arg(temp.path()).arg(count);
+        QDir().mkpath(path);
+        for (qint64 frame = 1; frame <= count; ++frame) {
+            if (frame == count / 2)
+                continue;
+            QFile file(QString("%1/plate.%2.exr").arg(path).arg(frame, 7, 10, QChar('0')));
+            if (!file.open(QIODevice::WriteOnly)) {
+                core::logErr() << "could not create file: " << file.fileName() << Qt::endl;
+                return false;
+            }
+        }
+        QFile notes(QString("%1/notes.txt").arg(path));
+        if (!notes.open(QIODevice::WriteOnly)) {
+            core::logErr() << "could not create file: " << notes.fileName() << Qt::endl;
+            return false;
+        }
+        paths.append(path);
+    }
+
+    bool ok = true;
+    core::FileScanner scanner;
+    scanner.setHoles(true);
+    for (int i = 0; i < paths.size(); ++i) {
+        av::Timer timer;
+        timer.start();
+        const QList<core::File> files = scanner.scan(paths[i]);
+        timer.stop();
+        core::logOut() << "entries: " << counts[i] << ", scan: " << timer.elapsed() / 1e6 << " ms" << Qt::endl;
+
+        ok &= testValue(files.size(), qsizetype(2), "scanner file count");
+        if (files.size() == 2) {
+            const core::FileRange range = files[1].fileRange();
+            ok &= testValue(files[0].fileName(), QString("notes.txt"), "scanner plain file");
+            ok &= testValue(range.size(), counts[i] - 1, "scanner range size");
+            ok &= testValue(range.holes() == QList<qint64>({ counts[i] / 2 }), true, "scanner range holes");
+        }
+    }
+
+    av::Timer timer;
+    timer.start();
+    const QList<core::File> files = scanner.scan(paths);
+    timer.stop();
+    core::logOut() << "directories: " << paths.size() << ", parallel scan: " << timer.elapsed() / 1e6 << " ms"
+                   << Qt::endl;
+    ok &= testValue(files.size(), qsizetype(paths.size() * 2), "scanner parallel file count");
+
+    scanner.setRecursive(true);
+    timer.restart();
+    const QList<core::File> tree = scanner.scan(temp.path());
+    timer.stop();
+    core::logOut() << "recursive scan: " << timer.elapsed() / 1e6 << " ms" << Qt::endl;
+    ok &= testValue(tree.size(), qsizetype(paths.size() * 2), "scanner recursive file count");
+
+    scanner.setRecursive(false);
+    scanner.setHoles(false);
+    ok &= testValue(scanner.scan(paths.first()).size(), qsizetype(3), "scanner split ranges");
+
+    // an empty path lists the current directory.
+    scanner.scan(QString());
+    ok &= testValue(scanner.error().hasError(), false, "scanner empty path");
+    if (!ok) {
+        core::logErr() << "file scanner validation failed" << Qt::endl;
+        return false;
+    }
     return true;
 }
 
@@ -306,6 +420,13 @@ testImageClassification()
     const QRect rect(0, 0, 1920, 1080);
     core::ImageFormat format(core::ImageFormat::UInt8);
 
+    static_assert(std::is_trivially_copyable_v<core::ImageFormat>, "image format must not allocate");
+    if (format.size() != 1 || !format.isInteger() || core::ImageFormat(core::ImageFormat::Half).size() != 2
+        || !core::ImageFormat(core::ImageFormat::Float).isFloat() || core::ImageFormat().isValid()) {
+        core::logErr() << "image format traits failed" << Qt::endl;
+        return false;
+    }
+
     {
         core::ImageBuffer image(rect, rect, format, 4);
         image.setPacking(core::ImageBuffer::Packing::Interleaved);
@@ -604,7 +725,7 @@ testImagePlanar()
         }
     }
 
-    QImage planarImage(reinterpret_cast<const uchar*>(planarRGB.data()), dataWindow.width(), dataWindow.height(),
+    QImage planarImage(reinterpret_cast<const uchar*>(planarRGB.constData()), dataWindow.width(), dataWindow.height(),
                        planarRGB.strideSize(), QImage::Format_RGB888);
 
     if (!planarImage.save(QString("%1/planarChecker.png").arg(imagePath))) {
@@ -705,7 +826,7 @@ testImageInterleaved()
     }
 
     core::ImageBuffer ramp16 = core::ImageBuffer::convert(ramp, core::ImageFormat::UInt16, 4);
-    QImage ramp16Image(reinterpret_cast<const uchar*>(ramp16.data()), dataWindow.width(), dataWindow.height(),
+    QImage ramp16Image(reinterpret_cast<const uchar*>(ramp16.constData()), dataWindow.width(), dataWindow.height(),
                        ramp16.strideSize(), QImage::Format_RGBX64);
 
     if (!ramp16Image.save(QString("%1/ramp16.png").arg(imagePath))) {
@@ -1118,12 +1239,359 @@ testImageThreaded()
     return ok.load();
 }
 
+bool
+testImageKernels()
+{
+    core::logOut() << "test image kernels" << Qt::endl;
+
+    // a one pixel wide image converts rows of three components which is below
+    // every vector width, so it runs the scalar path and is the reference for
+    // the vectorised conversion of the same pixels laid out as one wide row.
+    using T = core::ImageFormat::Type;
+    const QList<QPair<T, T>> conversions = { { T::UInt8, T::Half },  { T::UInt16, T::Half }, { T::UInt8, T::Float },
+                                             { T::Half, T::UInt8 },  { T::Float, T::UInt8 }, { T::Half, T::Float },
+                                             { T::Float, T::Half } };
+    const int pixels = 4099;
+
+    bool ok = true;
+    for (const auto& conversion : conversions) {
+        core::ImageBuffer wide(QRect(0, 0, pixels, 1), QRect(0, 0, pixels, 1), core::ImageFormat(conversion.first), 3);
+        core::ImageBuffer tall(QRect(0, 0, 1, pixels), QRect(0, 0, 1, pixels), core::ImageFormat(conversion.first), 3);
+        wide.setPixelLayout(core::ImageBuffer::PixelLayout::RGB);
+        tall.setPixelLayout(core::ImageBuffer::PixelLayout::RGB);
+        wide.allocate();
+        tall.allocate();
+
+        const size_t count = size_t(pixels) * 3;
+        for (size_t i = 0; i < count; ++i) {
+            switch (conversion.first) {
+            case T::UInt8: reinterpret_cast<quint8*>(wide.data())[i] = quint8(i * 7); break;
+            case T::UInt16: reinterpret_cast<quint16*>(wide.data())[i] = quint16(i * 16); break;
+            case T::Half: reinterpret_cast<quint16*>(wide.data())[i] = quint16(i * 13) & 0x7bff; break;
+            case T::Float: reinterpret_cast<float*>(wide.data())[i] = float(i) / float(count) * 2.5f - 0.5f; break;
+            default: break;
+            }
+        }
+        std::memcpy(tall.data(), wide.data(), wide.byteSize());
+
+        for (int channels : { 3, 4 }) {
+            const core::ImageBuffer fast = core::ImageBuffer::convert(wide, conversion.second, channels);
+            const core::ImageBuffer reference = core::ImageBuffer::convert(tall, conversion.second, channels);
+            if (std::memcmp(fast.data(), reference.data(), fast.byteSize()) != 0) {
+                core::logErr() << "kernel mismatch:" << int(conversion.first) << "to" << int(conversion.second)
+                               << "channels:" << channels << Qt::endl;
+                ok = false;
+            }
+        }
+    }
+
+    const QRect rect(0, 0, 33, 1);
+    core::ImageBuffer bgra(rect, rect, core::ImageFormat(T::UInt8), 4);
+    bgra.setPixelLayout(core::ImageBuffer::PixelLayout::BGRA);
+    bgra.allocate();
+    for (int i = 0; i < rect.width() * 4; ++i)
+        bgra.data()[i] = quint8(i);
+
+    const core::ImageBuffer rgba = core::ImageBuffer::convert(bgra, core::ImageBuffer::PixelLayout::RGBA);
+    for (int x = 0; x < rect.width(); ++x) {
+        const quint8* s = bgra.data() + x * 4;
+        const quint8* d = rgba.data() + x * 4;
+        if (d[0] != s[2] || d[1] != s[1] || d[2] != s[0] || d[3] != s[3]) {
+            core::logErr() << "bgra to rgba mismatch at:" << x << Qt::endl;
+            ok = false;
+            break;
+        }
+    }
+    return ok;
+}
+
+bool
+testImageParallel()
+{
+    core::logOut() << "test image parallel" << Qt::endl;
+
+    const QRect rect(0, 0, 3840, 2160);
+    core::ImageBuffer src(rect, rect, core::ImageFormat(core::ImageFormat::Half), 3);
+    src.setPixelLayout(core::ImageBuffer::PixelLayout::RGB);
+    src.allocate();
+
+    quint16* s = reinterpret_cast<quint16*>(src.data());
+    for (size_t i = 0; i < size_t(rect.width()) * rect.height() * 3; ++i)
+        s[i] = quint16(i * 31) & 0x7bff;
+
+    const qint64 tileSize = core::ImageBuffer::convertTileSize();
+
+    av::Timer timer;
+    core::ImageBuffer::setConvertTileSize(std::numeric_limits<qint64>::max());
+    timer.start();
+    const core::ImageBuffer serial = core::ImageBuffer::convert(src, core::ImageFormat::UInt8, 4);
+    timer.stop();
+    const qint64 serialNs = timer.elapsed();
+
+    core::ImageBuffer::setConvertTileSize(tileSize);
+    timer.restart();
+    const core::ImageBuffer parallel = core::ImageBuffer::convert(src, core::ImageFormat::UInt8, 4);
+    timer.stop();
+    const qint64 parallelNs = timer.elapsed();
+
+    core::logOut() << "threads: " << core::threadPool()->maxThreadCount() << ", serial: " << serialNs / 1e6
+                   << " ms, parallel: " << parallelNs / 1e6 << " ms" << Qt::endl;
+
+    return testValue(std::memcmp(serial.data(), parallel.data(), serial.byteSize()), 0, "parallel.convert");
+}
+
+bool
+testImageDecode()
+{
+    core::logOut() << "test image decode" << Qt::endl;
+
+    // rec709 video range red, 8-bit and 10-bit code values.
+    const int width = 6;
+    const int height = 2;
+    const QRect rect(0, 0, width, height);
+    const quint8 y8 = 63, cb8 = 102, cr8 = 240;
+    const quint32 y10 = 252, cb10 = 408, cr10 = 960;
+
+    QList<core::ImageBuffer> images;
+
+    core::ImageBuffer nv12(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 1);
+    nv12.setPacking(core::ImageBuffer::Packing::BiPlanar);
+    nv12.setSubsampling(core::ImageBuffer::Subsampling::CS420);
+    nv12.setPixelLayout(core::ImageBuffer::PixelLayout::NV12);
+    nv12.allocate();
+    std::memset(nv12.planeData(0), y8, nv12.planeByteSize(0));
+    for (size_t i = 0; i < nv12.planeByteSize(1); i += 2) {
+        nv12.planeData(1)[i] = cb8;
+        nv12.planeData(1)[i + 1] = cr8;
+    }
+    images.append(nv12);
+
+    core::ImageBuffer nv21(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 1);
+    nv21.setPacking(core::ImageBuffer::Packing::BiPlanar);
+    nv21.setSubsampling(core::ImageBuffer::Subsampling::CS420);
+    nv21.setPixelLayout(core::ImageBuffer::PixelLayout::NV21);
+    nv21.allocate();
+    std::memset(nv21.planeData(0), y8, nv21.planeByteSize(0));
+    for (size_t i = 0; i < nv21.planeByteSize(1); i += 2) {
+        nv21.planeData(1)[i] = cr8;
+        nv21.planeData(1)[i + 1] = cb8;
+    }
+    images.append(nv21);
+
+    core::ImageBuffer uyvy(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 2);
+    uyvy.setPacking(core::ImageBuffer::Packing::Packed);
+    uyvy.setSubsampling(core::ImageBuffer::Subsampling::CS422);
+    uyvy.setPixelLayout(core::ImageBuffer::PixelLayout::UYVY);
+    uyvy.allocate();
+    for (size_t i = 0; i < uyvy.byteSize(); i += 4) {
+        const quint8 pair[4] = { cb8, y8, cr8, y8 };
+        std::memcpy(uyvy.data() + i, pair, 4);
+    }
+    images.append(uyvy);
+
+    core::ImageBuffer yuyv(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 2);
+    yuyv.setPacking(core::ImageBuffer::Packing::Packed);
+    yuyv.setSubsampling(core::ImageBuffer::Subsampling::CS422);
+    yuyv.setPixelLayout(core::ImageBuffer::PixelLayout::YUYV);
+    yuyv.allocate();
+    for (size_t i = 0; i < yuyv.byteSize(); i += 4) {
+        const quint8 pair[4] = { y8, cb8, y8, cr8 };
+        std::memcpy(yuyv.data() + i, pair, 4);
+    }
+    images.append(yuyv);
+
+    // v210 rows are 128 byte aligned, the data window width is in bytes.
+    core::ImageBuffer v210(QRect(0, 0, 128, height), rect, core::ImageFormat(core::ImageFormat::UInt8), 1);
+    v210.setPacking(core::ImageBuffer::Packing::Packed);
+    v210.setSubsampling(core::ImageBuffer::Subsampling::CS422);
+    v210.setPixelLayout(core::ImageBuffer::PixelLayout::V210);
+    v210.allocate();
+    std::memset(v210.data(), 0, v210.byteSize());
+    for (int row = 0; row < height; ++row) {
+        const quint32 words[4] = { cb10 | y10 << 10 | cr10 << 20, y10 | cb10 << 10 | y10 << 20,
+                                   cr10 | y10 << 10 | cb10 << 20, y10 | cr10 << 10 | y10 << 20 };
+        for (int i = 0; i < 4; ++i)
+            qToLittleEndian<quint32>(words[i], v210.data() + size_t(row) * v210.strideSize() + i * 4);
+    }
+    images.append(v210);
+
+    bool ok = true;
+    for (core::ImageBuffer& image : images) {
+        image.setPixelRange(core::ImageBuffer::PixelRange::Video);
+        image.setColorSpace(render::ColorSpace::Rec709);
+
+        const core::ImageBuffer rgba = core::ImageBuffer::decode(image);
+        ok &= testValue(rgba.dataWindow().width(), width, "decode.width");
+        ok &= testValue(rgba.isRgb() && rgba.channels() == 4, true, "decode.rgba");
+
+        const quint8* d = rgba.data();
+        for (size_t i = 0; i < rgba.byteSize(); i += 4) {
+            ok &= testValue(int(d[i]), 255, "decode.r");
+            ok &= testValue(d[i + 1] <= 1, true, "decode.g");
+            ok &= testValue(int(d[i + 2]), 0, "decode.b");
+            ok &= testValue(int(d[i + 3]), 255, "decode.a");
+        }
+    }
+
+    // full range rec601 mid gray to float.
+    uyvy.setPixelRange(core::ImageBuffer::PixelRange::Full);
+    uyvy.setColorSpace(render::ColorSpace::Rec601);
+    std::memset(uyvy.data(), 128, uyvy.byteSize());
+    const core::ImageBuffer gray = core::ImageBuffer::decode(uyvy, core::ImageFormat::Float);
+    const float* f = reinterpret_cast<const float*>(gray.data());
+    for (int c = 0; c < 3; ++c)
+        ok &= testValue(qAbs(f[c] - 128.0f / 255.0f) < 1e-6f, true, "decode.gray");
+    ok &= testValue(f[3], 1.0f, "decode.alpha");
+    return ok;
+}
+
+bool
+testImageEncode()
+{
+    core::logOut() << "test image encode" << Qt::endl;
+
+    const QRect rect(0, 0, 13, 4);
+    core::ImageBuffer src(rect, rect, core::ImageFormat(core::ImageFormat::Float), 4);
+    src.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
+    src.setColorSpace(render::ColorSpace::Rec709);
+    src.allocate();
+
+    float* s = reinterpret_cast<float*>(src.data());
+    for (int i = 0; i < rect.width() * rect.height(); ++i) {
+        s[i * 4] = 1.0f;
+        s[i * 4 + 1] = 0.0f;
+        s[i * 4 + 2] = 0.0f;
+        s[i * 4 + 3] = 1.0f;
+    }
+
+    // rec709 legal range red, the same code values as the uyvy8 shader.
+    bool ok = true;
+    const core::ImageBuffer uyvy = core::ImageBuffer::encode(src, core::ImageBuffer::PixelLayout::UYVY);
+    ok &= testValue(uyvy.pixelRange() == core::ImageBuffer::PixelRange::Video, true, "encode.pixelRange");
+    ok &= testValue(int(uyvy.data()[0]), 102, "encode.u");
+    ok &= testValue(int(uyvy.data()[1]), 63, "encode.y0");
+    ok &= testValue(int(uyvy.data()[2]), 240, "encode.v");
+    ok &= testValue(int(uyvy.data()[3]), 63, "encode.y1");
+
+    for (int i = 0; i < rect.width() * rect.height(); ++i) {
+        s[i * 4] = 0.8f;
+        s[i * 4 + 1] = 0.3f;
+        s[i * 4 + 2] = 0.1f;
+    }
+
+    const core::ImageBuffer v210 =
+        core::ImageBuffer::encode(src, core::ImageBuffer::PixelLayout::V210, core::ImageBuffer::ChromaFilter::Cosited);
+    ok &= testValue(v210.strideSize(), size_t(128), "encode.v210 stride");
+
+    const core::ImageBuffer decoded = core::ImageBuffer::decode(v210, core::ImageFormat::Float);
+    ok &= testValue(decoded.dataWindow().width(), rect.width(), "encode.v210 width");
+
+    const float* d = reinterpret_cast<const float*>(decoded.data());
+    for (int i = 0; i < rect.width() * rect.height() * 4; ++i)
+        ok &= testValue(qAbs(d[i] - s[i]) < 2.0f / 1023.0f, true, "encode.v210 roundtrip");
+    return ok;
+}
+
+bool
+testImageCache()
+{
+    core::logOut() << "test image cache" << Qt::endl;
+
+    const QRect rect(0, 0, 4, 4);
+    const qint64 bytes = 4 * 4 * 4;
+
+    core::FrameCache cache;
+    cache.setBudget(3 * bytes);
+
+    const QString key = "cache.####.exr";
+    for (qint64 frame = 0; frame < 4; ++frame) {
+        core::ImageBuffer image(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 4);
+        image.allocate();
+        image.data()[0] = quint8(frame);
+        cache.insert(key, frame, image);
+    }
+
+    bool ok = true;
+    core::ImageBuffer image;
+    ok &= testValue(cache.find(key, 3, image), true, "cache.find");
+    ok &= testValue(int(image.data()[0]), 3, "cache.image");
+    ok &= testValue(cache.find("other.####.exr", 3, image), false, "cache.find other");
+
+    core::FrameCache::Stats stats = cache.stats();
+    ok &= testValue(stats.hits, qint64(1), "cache.hits");
+    ok &= testValue(stats.misses, qint64(1), "cache.misses");
+    ok &= testValue(stats.evictions, qint64(1), "cache.evictions");
+    ok &= testValue(stats.frames, qint64(3), "cache.frames");
+    ok &= testValue(stats.residentBytes, 3 * bytes, "cache.residentBytes");
+
+    cache.remove(key);
+    ok &= testValue(cache.stats().residentBytes, qint64(0), "cache.remove");
+
+    core::logOut() << "hits: " << stats.hits << ", misses: " << stats.misses << ", evictions: " << stats.evictions
+                   << Qt::endl;
+    return ok;
+}
+
+bool
+testImagePool()
+{
+    core::logOut() << "test image pool" << Qt::endl;
+
+    const QRect rect(0, 0, 1920, 1080);
+    core::ImageBufferPool pool;
+
+    bool ok = true;
+    for (int frame = 0; frame < 8; ++frame) {
+        core::ImageBuffer image(rect, rect, core::ImageFormat(core::ImageFormat::Half), 4);
+        image.allocate(&pool);
+        ok &= testValue(image.byteSize(), size_t(1920 * 1080 * 4 * 2), "pool.byteSize");
+        ok &= testValue(quintptr(image.data()) % 4096, quintptr(0), "pool.alignment");
+    }
+
+    core::ImageBufferPool::Stats stats = pool.stats();
+    ok &= testValue(stats.allocations, qint64(1), "pool.allocations");
+    ok &= testValue(stats.reuses, qint64(7), "pool.reuses");
+    ok &= testValue(stats.usedBlocks, qint64(0), "pool.usedBlocks");
+    ok &= testValue(stats.pooledBlocks, qint64(1), "pool.pooledBlocks");
+
+    pool.trim();
+    ok &= testValue(pool.stats().pooledBytes, qint64(0), "pool.trim");
+
+    // metadata changes detach without copying, pixels are copied on write.
+    core::ImageBuffer image(rect, rect, core::ImageFormat(core::ImageFormat::Half), 4);
+    image.allocate(&pool);
+    core::ImageBuffer shared = image;
+    shared.setColorSpace(render::ColorSpace::Rec709);
+    ok &= testValue(shared.constData() == image.constData(), true, "pool.sharedPixels");
+    ok &= testValue(image.colorSpace() == render::ColorSpace::Unknown, true, "pool.sharedColorSpace");
+    shared.reset();
+    ok &= testValue(image.isAllocated(), true, "pool.sharedReset");
+
+    shared = image;
+    shared.detach();
+    shared.data()[0] = 1;
+    ok &= testValue(shared.constData() != image.constData(), true, "pool.copyOnWrite");
+    ok &= testValue(image.data() == image.constData(), true, "pool.unsharedWrite");
+
+    // writing through a copy detaches it, the other buffer keeps its pixels.
+    core::ImageBuffer copy = image;
+    const quint8 value = image.constData()[0];
+    copy.data()[0] = quint8(value + 1);
+    ok &= testValue(copy.constData() != image.constData(), true, "pool.copyWrite");
+    ok &= testValue(image.constData()[0], value, "pool.copyWriteSource");
+
+    core::logOut() << "allocations: " << stats.allocations << ", reuses: " << stats.reuses
+                   << ", peak bytes: " << stats.peakBytes << Qt::endl;
+    return ok;
+}
+
 bool
 testImage()
 {
     return testImageClassification() && testImageNV12Layout() && testImagePackedLayout() && testImageUint16()
            && testImageDouble() && testImagePlanar() && testImageInterleaved() && testImageAverage()
-           && testImageThreaded();
+           && testImageKernels() && testImageParallel() && testImageDecode() && testImageEncode()
+           && testImageCache() && testImagePool() && testImageThreaded();
 }
 
 bool
@@ -1344,8 +1812,8 @@ testRenderOffscreen()
                 const int height = rendered.dataWindow().height();
                 const size_t components = size_t(width) * height * 4;
 
-                const quint8* a = rendered.data();
-                const quint8* b = source.data();
+                const quint8* a = rendered.constData();
+                const quint8* b = source.constData();
                 int diffCount = 0;
 
                 core::ImageBuffer diff(rendered.dataWindow(), rendered.displayWindow(),
@@ -1390,9 +1858,8 @@ testRenderRoundtrip()
 
         void enqueueFrame(const core::ImageBuffer& image, qint64 frame) override
         {
-            Q_UNUSED(frame);
-
             captured = image;
+            releaseFrame(frame);
             received.store(true);
         }
 
@@ -1636,16 +2103,462 @@ testRenderRoundtrip()
     return ok.load();
 }
 
+bool
+testRenderReadback()
+{
+    core::logOut() << "test render readback" << Qt::endl;
+
+    class ReadbackOutput : public render::RenderOutput {
+    public:
+        explicit ReadbackOutput(bool release, QObject* parent = nullptr)
+            : render::RenderOutput(parent)
+            , release(release)
+        {}
+
+        void enqueueFrame(const core::ImageBuffer& image, qint64 frame) override
+        {
+            captured = image;
+            if (release)
+                releaseFrame(frame);
+        }
+
+        core::ImageBuffer captured;
+        bool release;
+    };
+
+    const QSize size(64, 32);
+    const QRect rect(QPoint(0, 0), size);
+    const int depth = 2;
+    const int frames = 8;
+
+    core::ImageBuffer source(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 4);
+    source.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
+    source.setPixelRange(core::ImageBuffer::PixelRange::Full);
+    source.allocate();
+    std::memset(source.data(), 128, source.byteSize());
+
+    auto renderFrames = [&](ReadbackOutput& output) -> bool {
+        output.setEnabled(true);
+        output.setFormat(render::RenderOutput::Format::RGBA8);
+        output.setReadbackDepth(depth);
+
+        render::RenderSpec outputSpec;
+        outputSpec.setSize(size);
+
+        QMatrix4x4 view;
+        view.setToIdentity();
+        outputSpec.setView(view);
+
+        output.setRenderSpec(outputSpec);
+
+        render::RenderOffscreen renderOffscreen;
+        if (!renderOffscreen.initialize(size)) {
+            core::logErr() << "readback render offscreen initialization failed" << Qt::endl;
+            return false;
+        }
+
+        render::ImageLayer imageLayer;
+        imageLayer.setImage(source);
+
+        render::RenderEngine renderEngine;
+        renderEngine.setImageLayers({ imageLayer });
+        renderEngine.setBackground(Qt::black);
+        renderEngine.setResolution(size);
+        renderEngine.setRenderOutputs({ &output });
+
+        renderOffscreen.setRenderEngine(&renderEngine);
+
+        for (int frame = 0; frame < frames; ++frame) {
+            if (!renderOffscreen.render().isValid()) {
+                core::logErr() << "readback render failed" << Qt::endl;
+                return false;
+            }
+        }
+
+        const int timeoutMs = 5000;
+        QElapsedTimer timer;
+        timer.start();
+
+        while (output.deliveredFrames() + output.droppedFrames() < frames) {
+            if (timer.elapsed() > timeoutMs) {
+                core::logErr() << "timed out waiting for readback" << Qt::endl;
+                return false;
+            }
+
+            QThread::msleep(1);
+        }
+        return true;
+    };
+
+    bool ok = true;
+
+    // released frames free their slot, every frame is read back.
+    ReadbackOutput released(true);
+    if (!renderFrames(released))
+        return false;
+
+    ok &= testValue(released.deliveredFrames(), qint64(frames), "readback.delivered");
+    ok &= testValue(released.droppedFrames(), qint64(0), "readback.dropped");
+    ok &= testValue(released.captured.isAllocated(), true, "readback.captured");
+
+    // held frames keep their slot, once every slot is held frames are dropped.
+    ReadbackOutput held(false);
+    if (!renderFrames(held))
+        return false;
+
+    ok &= testValue(held.deliveredFrames(), qint64(depth), "readback.heldDelivered");
+    ok &= testValue(held.droppedFrames(), qint64(frames - depth), "readback.heldDropped");
+
+    core::logOut() << "readback latency: " << released.readbackLatencyMs() << " ms, max: "
+                   << released.readbackLatencyMaxMs() << " ms" << Qt::endl;
+    return ok;
+}
+
+bool
+testRenderLut()
+{
+    core::logOut() << "test render lut" << Qt::endl;
+
+    QTemporaryDir temp;
+    if (!temp.isValid()) {
+        core::logErr() << "could not create temporary directory" << Qt::endl;
+        return false;
+    }
+
+    auto writeFile = [&](const QString& name, const QByteArray& data) {
+        const QString filePath = QDir(temp.path()).filePath(name);
+        QDir().mkpath(QFileInfo(filePath).path());
+        QFile file(filePath);
+        if (file.open(QIODevice::WriteOnly))
+            file.write(data);
+        return filePath;
+    };
+    auto cube = [](int size) {
+        QByteArray data = QString("TITLE \"identity\"\n# comment\nLUT_3D_SIZE %1\n\n").arg(size).toLatin1();
+        for (int b = 0; b < size; ++b) {
+            for (int g = 0; g < size; ++g) {
+                for (int r = 0; r < size; ++r) {
+                    data += QString("%1 %2 +%3\n")
+                                .arg(double(r) / (size - 1), 0, 'f', 6)
+                                .arg(double(g) / (size - 1), 0, 'f', 6)
+                                .arg(double(b) / (size - 1), 0, 'f', 6)
+                                .toLatin1();
+                }
+            }
+        }
+        return data;
+    };
+    auto identity = [](const render::LutCache::Lut& lut) {
+        // texels are stored with red varying fastest, alpha is one.
+        const qsizetype bytes = qsizetype(lut.size) * lut.size * lut.size * 4 * qsizetype(sizeof(float));
+        if (!lut.isValid() || lut.rgba32f.size() != bytes)
+            return false;
+        const float* texel = reinterpret_cast<const float*>(lut.rgba32f.constData());
+        for (int b = 0; b < lut.size; ++b) {
+            for (int g = 0; g < lut.size; ++g) {
+                for (int r = 0; r < lut.size; ++r) {
+                    const float expected[4] = { float(r) / (lut.size - 1), float(g) / (lut.size - 1),
+                                                float(b) / (lut.size - 1), 1.0f };
+                    for (int c = 0; c < 4; ++c) {
+                        if (qAbs(*texel++ - expected[c]) > 1e-5f)
+                            return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+
+    bool valid = true;
+    const QString smallPath = writeFile("small.cube", cube(2));
+    const render::LutCache::Lut small = render::LutCache::parse(smallPath);
+    valid &= testValue(small.size, 2, "lut small size");
+    valid &= testValue(identity(small), true, "lut small values");
+
+    // the data section of a large file is parsed in several chunks.
+    const QString largePath = writeFile("large.cube", cube(33));
+    valid &= testValue(QFileInfo(largePath).size() > 256 * 1024, true, "lut large file");
+    const render::LutCache::Lut large = render::LutCache::parse(largePath);
+    valid &= testValue(large.size, 33, "lut large size");
+    valid &= testValue(identity(large), true, "lut large values");
+
+    const QString oneDPath = writeFile("oned.cube", "LUT_1D_SIZE 2\n0 0 0\n1 1 1\n");
+    valid &= testValue(render::LutCache::parse(oneDPath).isValid(), false, "lut 1d rejected");
+    QByteArray count = cube(2);
+    count.chop(QByteArray("1.000000 1.000000 +1.000000\n").size());
+    const QString countPath = writeFile("count.cube", count);
+    valid &= testValue(render::LutCache::parse(countPath).isValid(), false, "lut count rejected");
+    QByteArray value = cube(2);
+    value.replace("0.000000 0.000000 +0.000000", "0.000000 x +0.000000");
+    const QString valuePath = writeFile("value.cube", value);
+    valid &= testValue(render::LutCache::parse(valuePath).isValid(), false, "lut value rejected");
+
+    // parsed LUTs are written to the cache and mapped on the next load.
+    render::LutCache cache;
+    cache.setPath(QDir(temp.path()).filePath("cache"));
+    bool cached = true;
+    valid &= testValue(cache.load(largePath, "large", &cached).size, 33, "lut cache write");
+    valid &= testValue(cached, false, "lut cache write cached");
+    valid &= testValue(cache.stats().writes, qint64(1), "lut cache writes");
+    valid &= testValue(QFile::exists(cache.filePath("large")), true, "lut cache file");
+    const render::LutCache::Lut warm = cache.load(largePath, "large", &cached);
+    valid &= testValue(cached, true, "lut cache warm cached");
+    valid &= testValue(warm.mapping != nullptr, true, "lut cache warm mapped");
+    valid &= testValue(identity(warm), true, "lut cache warm values");
+
+    // corrupt cache files are removed, a valid source is parsed again.
+    QFile corrupt(cache.filePath("large"));
+    if (corrupt.open(QIODevice::WriteOnly)) {
+        corrupt.write("invalid");
+        corrupt.close();
+    }
+    valid &= testValue(cache.load(largePath, "large", &cached).size, 33, "lut cache corrupt reparsed");
+    valid &= testValue(cached, false, "lut cache corrupt cached");
+    valid &= testValue(cache.stats().rejects, qint64(1), "lut cache rejects");
+    const qint64 cacheBytes = 16 + 33 * 33 * 33 * 16;
+    valid &= testValue(QFileInfo(cache.filePath("large")).size(), cacheBytes, "lut cache rewritten");
+
+    // a header size that would overflow the expected file size is rejected.
+    const quint32 header[4] = { 0x464d4c54, 1, 1u << 21, 4 };
+    QFile overflow(cache.filePath("overflow"));
+    if (overflow.open(QIODevice::WriteOnly)) {
+        overflow.write(reinterpret_cast<const char*>(header), sizeof(header));
+        overflow.close();
+    }
+    valid &= testValue(cache.load(valuePath, "overflow", &cached).isValid(), false, "lut cache overflow");
+    valid &= testValue(QFile::exists(cache.filePath("overflow")), false, "lut cache overflow removed");
+    return valid;
+}
+
 bool
 testRender()
 {
-    return testRenderOffscreen() && testRenderRoundtrip();
+    return testRenderOffscreen() && testRenderRoundtrip() && testRenderReadback() && testRenderLut();
 }
 
 bool
-testShader()
+testShaderPrecompile()
+{
+    core::logOut() << "test shader precompile" << Qt::endl;
+
+    const QString effectCode = R"(@param float gain 1.0 0.0 1.0
+vec4 effect(vec4 color, vec2 pixel, vec2 size)
+{
+    return vec4(vec3(gain), 1.0);
+})";
+    render::ShaderParser shaderParser;
+    const render::ShaderDefinition effectDefinition = shaderParser.parse(effectCode);
+    if (!shaderParser.isValid()) {
+        core::logErr() << "failed to parse effect code: " << shaderParser.error().message() << Qt::endl;
+        return false;
+    }
+
+    render::ImageEffect imageEffect;
+    imageEffect.setShaderDefinition(effectDefinition);
+
+    const QSize size(16, 16);
+    const QRect rect(QPoint(0, 0), size);
+    core::ImageBuffer image(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 4);
+    image.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
+    image.setPixelRange(core::ImageBuffer::PixelRange::Full);
+    image.allocate();
+    std::memset(image.data(), 128, image.byteSize());
+
+    render::ImageLayer plainLayer;
+    plainLayer.setImage(image);
+
+    render::ImageLayer effectLayer;
+    effectLayer.setImage(image);
+    effectLayer.setImageEffect(imageEffect);
+
+    // the gray image is drawn gray with the plain shader and white once the
+    // effect variant is baked, nothing is drawn while no shader is ready.
+    enum class Drawn { None, Plain, Effect };
+    auto renderFrame = [&](render::RenderDevice& device, render::RenderEngine& renderEngine) -> Drawn {
+        QRhiCommandBuffer* commandBuffer = nullptr;
+        if (!device.beginFrame(commandBuffer))
+            return Drawn::None;
+
+        render::RenderSpec renderSpec;
+        renderSpec.setSize(size);
+
+        QMatrix4x4 view;
+        view.setToIdentity();
+        renderSpec.setView(view);
+
+        const render::RenderContext context = device.context();
+        if (renderEngine.initialize(context, renderSpec))
+            renderEngine.render(context, renderSpec, commandBuffer);
+        device.endFrame();
+
+        const core::ImageBuffer rendered = device.readback();
+        if (!rendered.isValid())
+            return Drawn::None;
+
+        const int value = core::ImageBuffer::convert(rendered, core::ImageFormat::UInt8, 4).constData()[0];
+        return value >= 250 ? Drawn::Effect : value > 8 ? Drawn::Plain : Drawn::None;
+    };
+
+    auto renderUntil = [&](render::RenderDevice& device, render::RenderEngine& renderEngine, Drawn drawn) {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < 30000) {
+            if (renderFrame(device, renderEngine) == drawn)
+                return true;
+            QCoreApplication::processEvents();
+            QThread::msleep(1);
+        }
+        return false;
+    };
+
+    QTemporaryDir cacheDir;
+    const QString cachePath = render::shaderCache()->path();
+    render::shaderCache()->setPath(cacheDir.path());
+
+    bool valid = true;
+    {
+        render::RenderDevice device;
+        if (!device.create(render::RenderDevice::Auto, size)) {
+            core::logErr() << "could not create render device" << Qt::endl;
+            render::shaderCache()->setPath(cachePath);
+            return false;
+        }
+
+        // with the plain shader baked, a new effect is drawn without it
+        // until its variant is baked in the background.
+        render::RenderEngine renderEngine;
+        renderEngine.setBackground(Qt::black);
+        renderEngine.setImageLayers({ plainLayer });
+        valid &= testValue(renderUntil(device, renderEngine, Drawn::Plain), true, "precompile plain");
+
+        renderEngine.setImageLayers({ effectLayer });
+        valid &= testValue(renderFrame(device, renderEngine) == Drawn::Plain, true, "precompile fallback");
+        valid &= testValue(renderUntil(device, renderEngine, Drawn::Effect), true, "precompile baked");
+    }
+    {
+        render::RenderDevice device;
+        if (!device.create(render::RenderDevice::Auto, size)) {
+            core::logErr() << "could not create render device" << Qt::endl;
+            render::shaderCache()->setPath(cachePath);
+            return false;
+        }
+
+        // precompiled variants are queued once the engine has a device, each
+        // job emits updateRequested when done, the first effect frame is
+        // drawn with the baked variant.
+        render::RenderEngine renderEngine;
+        renderEngine.setBackground(Qt::black);
+        renderEngine.precompile({ effectDefinition });
+
+        QElapsedTimer quiet;
+        quiet.start();
+        QObject::connect(&renderEngine, &render::RenderEngine::updateRequested, [&quiet]() { quiet.restart(); });
+        renderFrame(device, renderEngine);
+
+        QElapsedTimer timer;
+        timer.start();
+        while (quiet.elapsed() < 500 && timer.elapsed() < 30000) {
+            QCoreApplication::processEvents();
+            QThread::msleep(1);
+        }
+
+        renderEngine.setImageLayers({ effectLayer });
+        valid &= testValue(renderFrame(device, renderEngine) == Drawn::Effect, true, "precompile effect");
+    }
+
+    render::shaderCache()->setPath(cachePath);
+    return valid;
+}
+
+bool
+testShaderPipelineCache(const QString& cachePath)
+{
+    // pipeline cache data is saved from a device that created pipelines and
+    // restored into the next device. The Null backend exports no data, the
+    // round trip runs on OpenGL or Vulkan and is skipped without either.
+    const QSize size(16, 16);
+    const QRect rect(QPoint(0, 0), size);
+    core::ImageBuffer image(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), 4);
+    image.setPixelLayout(core::ImageBuffer::PixelLayout::RGBA);
+    image.setPixelRange(core::ImageBuffer::PixelRange::Full);
+    image.allocate();
+    std::memset(image.data(), 128, image.byteSize());
+
+    render::ImageLayer imageLayer;
+    imageLayer.setImage(image);
+
+    auto createDevice = [&](render::RenderDevice& device) {
+        return device.create(render::RenderDevice::OpenGL, size) || device.create(render::RenderDevice::Vulkan, size);
+    };
+    auto renderFrame = [&](render::RenderDevice& device) {
+        render::RenderEngine renderEngine;
+        renderEngine.setAsyncShaders(false);
+        renderEngine.setImageLayers({ imageLayer });
+
+        QRhiCommandBuffer* commandBuffer = nullptr;
+        if (!device.beginFrame(commandBuffer))
+            return false;
+
+        render::RenderSpec renderSpec;
+        renderSpec.setSize(size);
+
+        const render::RenderContext context = device.context();
+        const bool initialized = renderEngine.initialize(context, renderSpec);
+        if (initialized)
+            renderEngine.render(context, renderSpec, commandBuffer);
+        device.endFrame();
+        return initialized;
+    };
+
+    render::PipelineCache* pipelineCache = render::pipelineCache();
+    const QString pipelinePath = pipelineCache->path();
+    pipelineCache->setPath(cachePath);
+    pipelineCache->clear();
+    pipelineCache->resetStats();
+
+    bool valid = true;
+    bool skipped = false;
+    {
+        render::RenderDevice device;
+        if (!createDevice(device)) {
+            core::logOut() << "pipeline cache round trip skipped, no OpenGL or Vulkan device" << Qt::endl;
+            skipped = true;
+        }
+        else {
+            valid &= testValue(renderFrame(device), true, "pipeline cache cold frame");
+            QRhi* rhi = device.context().rhi();
+            if (rhi->pipelineCacheData().isEmpty()) {
+                core::logOut() << "pipeline cache round trip skipped, " << rhi->backendName()
+                               << " exports no pipeline cache data" << Qt::endl;
+                skipped = true;
+            }
+            else {
+                valid &= testValue(pipelineCache->stats().loads, qint64(0), "pipeline cache cold loads");
+                valid &= testValue(pipelineCache->save(rhi), true, "pipeline cache save");
+                valid &= testValue(pipelineCache->save(rhi), false, "pipeline cache save unchanged");
+                valid &= testValue(QFile::exists(pipelineCache->filePath(rhi)), true, "pipeline cache file");
+                valid &= testValue(pipelineCache->stats().saves, qint64(1), "pipeline cache saves");
+                valid &= testValue(pipelineCache->stats().savedBytes > 0, true, "pipeline cache saved bytes");
+            }
+        }
+    }
+    if (!skipped) {
+        render::RenderDevice device;
+        valid &= testValue(createDevice(device), true, "pipeline cache warm device");
+        valid &= testValue(renderFrame(device), true, "pipeline cache warm frame");
+        const render::PipelineCache::Stats stats = pipelineCache->stats();
+        valid &= testValue(stats.loads, qint64(1), "pipeline cache warm loads");
+        valid &= testValue(stats.loadedBytes > 0, true, "pipeline cache loaded bytes");
+        valid &= testValue(stats.rejects, qint64(0), "pipeline cache warm rejects");
+    }
+
+    pipelineCache->setPath(pipelinePath);
+    return valid;
+}
+
+bool
+testShaderCompile(const QString& cachePath)
 {
-    core::logOut() << "test media" << Qt::endl;
 
     QString filename = "fx/gaussian.fx";
     core::File file(QString("%1/%2").arg(dataPath).arg(filename));
@@ -1919,7 +2832,78 @@ testShader()
         core::logErr() << "vertex shader compilation failed: " << compiler.error().message() << Qt::endl;
         return false;
     }
-    return true;
+
+    // baked shaders are written to the cache directory, a second compile is
+    // served from memory and a new cache finds the entry on disk.
+    render::shaderCache()->clear();
+
+    bool valid = true;
+    render::ShaderCompiler baker;
+    const QShader baked = baker.compile(transformCode, QShader::VertexStage, opts);
+    valid &= testValue(baked.isValid(), true, "shader bake");
+    valid &= testValue(baker.isCached(), false, "shader bake cached");
+    render::ShaderCompiler cached;
+    valid &= testValue(cached.compile(transformCode, QShader::VertexStage, opts) == baked, true, "shader cache");
+    valid &= testValue(cached.isCached(), true, "shader cache cached");
+    valid &= testValue(cached.isDiskCached(), false, "shader cache memory");
+
+    render::shaderCache()->setPath(cachePath);
+    render::ShaderCompiler diskCached;
+    valid &= testValue(diskCached.compile(transformCode, QShader::VertexStage, opts) == baked, true, "shader disk");
+    valid &= testValue(diskCached.isDiskCached(), true, "shader disk cached");
+
+    render::ShaderCache cache;
+    cache.setPath(cachePath);
+    valid &= testValue(cache.warmUp(), 1, "shader cache warm up");
+    valid &= testValue(cache.stats().entries, qint64(1), "shader cache entries");
+
+    // shaders in memory are bounded without a disk cache.
+    render::ShaderCache memoryCache;
+    memoryCache.setPath(QString());
+    memoryCache.setMemoryLimit(1);
+    memoryCache.insert("fragment", fragmentShader);
+    memoryCache.insert("transform", transformShader);
+    QShader found;
+    valid &= testValue(memoryCache.stats().memoryEntries, qint64(1), "shader cache memory limit");
+    valid &= testValue(memoryCache.find("transform", found), true, "shader cache memory recent");
+    valid &= testValue(memoryCache.find("fragment", found), false, "shader cache memory dropped");
+
+    // pipeline cache files that fail to validate are removed, the device
+    // starts cold.
+    render::RenderDevice device;
+    if (device.create(render::RenderDevice::Null, QSize(16, 16))) {
+        QRhi* rhi = device.context().rhi();
+        render::PipelineCache pipelineCache;
+        pipelineCache.setPath(cachePath);
+        valid &= testValue(pipelineCache.load(rhi), false, "pipeline cache cold");
+
+        const QString filePath = pipelineCache.filePath(rhi);
+        QDir().mkpath(QFileInfo(filePath).path());
+        QFile file(filePath);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write("invalid");
+            file.close();
+        }
+        valid &= testValue(pipelineCache.load(rhi), false, "pipeline cache invalid");
+        valid &= testValue(pipelineCache.stats().rejects, qint64(1), "pipeline cache rejects");
+        valid &= testValue(QFile::exists(filePath), false, "pipeline cache removed");
+    }
+    return valid && testShaderPipelineCache(cachePath);
+}
+
+bool
+testShader()
+{
+    core::logOut() << "test shader" << Qt::endl;
+
+    // shaders are baked into a temporary cache from the first compile, the
+    // user's cache is left untouched.
+    QTemporaryDir cacheDir;
+    const QString cachePath = render::shaderCache()->path();
+    render::shaderCache()->setPath(cacheDir.path());
+    const bool valid = testShaderCompile(cacheDir.path());
+    render::shaderCache()->setPath(cachePath);
+    return valid && testShaderPrecompile();
 }
 
 bool
@@ -2209,6 +3193,46 @@ testTime()
 
     core::logOut() << "frames after increment: " << time.frames() << Qt::endl;
 
+    static_assert(std::is_trivially_copyable_v<av::Fps>, "fps must not allocate");
+    static_assert(std::is_trivially_copyable_v<av::Time>, "time must not allocate");
+    static_assert(std::is_trivially_copyable_v<av::TimeRange>, "timerange must not allocate");
+    static_assert(std::is_trivially_copyable_v<av::SmpteTime>, "smptetime must not allocate");
+
+    constexpr av::Time frame(1001, 24000, av::Fps::fps23_976());
+    static_assert(frame.isValid() && frame.ticks() == 1001, "time must be constexpr");
+
+    // invalid times and rates convert to 0 instead of dividing by zero.
+    const av::Time invalid;
+    const av::Time invalidFps(12000, 24000, av::Fps());
+    bool valid = true;
+    valid &= testValue(invalid.frames(), qint64(0), "invalid.frames");
+    valid &= testValue(invalid.tpf(), qint64(0), "invalid.tpf");
+    valid &= testValue(invalid.ticks(12), qint64(0), "invalid.ticks");
+    valid &= testValue(invalidFps.frames(), qint64(0), "invalidFps.frames");
+    valid &= testValue(invalidFps.ticks(12), qint64(0), "invalidFps.ticks");
+    valid &= testValue(av::Time::convert(invalid, 48000).ticks(), qint64(0), "invalid.convert");
+    if (!valid)
+        return false;
+
+    // frame stepping as done by readers and the processor, no allocations
+    // are involved so the loop is bound by integer math.
+    const qint64 steps = 1000000;
+    av::Timer timer;
+    timer.start();
+    av::Time step = av::Time::fromFrames(0, av::Fps::fps29_97());
+    qint64 checksum = 0;
+    for (qint64 i = 0; i < steps; ++i) {
+        step.setTicks(step.ticks(i + 1));
+        checksum += step.frames();
+    }
+    timer.stop();
+    core::logOut() << "frame step: " << qreal(timer.elapsed()) / steps << " ns" << Qt::endl;
+
+    if (checksum != steps * (steps + 1) / 2) {
+        core::logErr() << "frame stepping mismatch" << Qt::endl;
+        return false;
+    }
+
     return true;
 }
 
@@ -2261,6 +3285,7 @@ testTimer()
 
         qint64 frames = range.duration().frames();
         qint64 dropped = 0;
+        qint64 waits = 0;
 
         for (qint64 frame = range.start().frames(); frame < range.duration().frames(); ++frame) {
             quint64 currenttime = timer.elapsed();
@@ -2268,6 +3293,7 @@ testTimer()
 
             timer.sleep(delay);
             timer.wait();
+            waits++;
 
             qreal elapsed = av::Timer::convert(timer.elapsed() - currenttime, av::Timer::Unit::Seconds);
             qreal deviation = elapsed - fps.seconds();
@@ -2300,6 +3326,19 @@ testTimer()
             core::logErr() << "FAIL: deviation more than 50 ms" << Qt::endl;
             ok = false;
         }
+
+        QList<quint64> laps = timer.laps();
+        quint64 jitter = 0;
+        for (quint64 lap : laps)
+            jitter = qMax(jitter, lap);
+
+        core::logOut() << "max jitter: " << av::Timer::convert(jitter, av::Timer::Unit::Seconds) * 1000.0 << " ms"
+                       << Qt::endl;
+
+        if (laps.size() != waits) {
+            core::logErr() << "FAIL: jitter not recorded for each wait" << Qt::endl;
+            ok = false;
+        }
     });
     group.wait();
     return ok.load();
@@ -2578,6 +3617,17 @@ testPluginImage()
             return;
         }
 
+        // seeking and reading again reuses the pooled input.
+        const core::MetaData::Group custom = core::MetaData::Group::Custom;
+        const qint64 opens = reader->metaData().value(custom, "inputOpens").toLongLong();
+        reader->seek(reader->timeRange());
+        reader->read();
+        bool pooled = true;
+        pooled &= testValue(reader->image().isValid(), true, "pooled read");
+        pooled &= testValue(reader->metaData().value(custom, "inputOpens").toLongLong(), opens, "pooled opens");
+        if (!pooled)
+            ok = false;
+
         QString output = "test.00086400.exr";
         core::File outputFile(QString("%1/testPluginImage/%2").arg(testPath).arg(output));
         QDir outDir(outputFile.dirName());
@@ -2607,6 +3657,110 @@ testPluginImage()
             core::logErr() << "could not write image" << Qt::endl;
             return;
         }
+
+        QScopedPointer<plugins::MediaReader> prober(
+            core::pluginRegistry()->getPlugin<plugins::MediaReader>(file.extension()));
+        const core::MetaData metaData = prober->probe(file);
+        const core::MetaData::Group video = core::MetaData::Group::Video;
+        bool valid = true;
+        valid &= testValue(metaData.value(video, "width").toInt(), image.dataWindow().width(), "probe width");
+        valid &= testValue(metaData.value(video, "height").toInt(), image.dataWindow().height(), "probe height");
+        valid &= testValue(metaData.value(video, "fps").value<av::Fps>().isValid(), true, "probe fps");
+        valid &= testValue(prober->isOpen(), false, "probe closed");
+        valid &= testValue(prober->probe(file).keys(video) == metaData.keys(video), true, "probe cached");
+        if (!valid)
+            ok = false;
+    });
+    group.wait();
+    return ok.load();
+}
+
+bool
+testPluginGray()
+{
+    core::logOut() << "test plugin gray" << Qt::endl;
+
+    QTemporaryDir temp;
+    if (!temp.isValid()) {
+        core::logErr() << "could not create temporary directory" << Qt::endl;
+        return false;
+    }
+
+    // gray is replicated to rgb and read with opaque alpha, gray and alpha
+    // carries the alpha. A second read decodes into the same storage.
+    std::atomic<bool> ok { true };
+    core::DispatchGroup group;
+    group.async([&temp, &ok]() {
+        const QRect rect(0, 0, 4, 2);
+        const av::Fps fps = av::Fps::fps24();
+        for (int channels : { 1, 2 }) {
+            core::ImageBuffer source(rect, rect, core::ImageFormat(core::ImageFormat::UInt8), channels);
+            source.allocate();
+            quint8* src = source.data();
+            for (int i = 0; i < rect.width() * rect.height(); ++i) {
+                src[i * channels] = quint8(i * 30);
+                if (channels == 2)
+                    src[i * channels + 1] = quint8(255 - i * 20);
+            }
+
+            const core::File output(QString("%1/gray%2.tif").arg(temp.path()).arg(channels));
+            QScopedPointer<plugins::MediaWriter> writer(
+                core::pluginRegistry()->getPlugin<plugins::MediaWriter>(output.extension()));
+            if (!writer || !writer->open(output)) {
+                core::logErr() << "could not open writer for file:" << output << Qt::endl;
+                ok = false;
+                return;
+            }
+            writer->setTimeRange(av::TimeRange(av::Time::fromFrames(1, fps), av::Time::fromFrames(1, fps)));
+            writer->write(source);
+            if (writer->error().hasError()) {
+                core::logErr() << "could not write image: " << writer->error().message() << Qt::endl;
+                ok = false;
+                return;
+            }
+            writer->close();
+
+            const core::File file(QString("%1/gray%2.1.tif").arg(temp.path()).arg(channels));
+            QScopedPointer<plugins::MediaReader> reader(
+                core::pluginRegistry()->getPlugin<plugins::MediaReader>(file.extension()));
+            if (!reader || !reader->open(file)) {
+                core::logErr() << "could not open reader for file:" << file << Qt::endl;
+                ok = false;
+                return;
+            }
+            if (!reader->isOpen()) {
+                QEventLoop loop;
+                QObject::connect(reader.data(), &plugins::MediaReader::opened, &loop, &QEventLoop::quit);
+                loop.exec();
+            }
+
+            auto texels = [&](const core::ImageBuffer& image) {
+                if (image.channels() != 4 || image.dataWindow() != rect
+                    || image.imageFormat().type() != core::ImageFormat::UInt8)
+                    return false;
+                const quint8* dst = image.constData();
+                for (int i = 0; i < rect.width() * rect.height(); ++i, dst += 4) {
+                    const quint8 gray = quint8(i * 30);
+                    const quint8 alpha = channels == 2 ? quint8(255 - i * 20) : quint8(255);
+                    if (dst[0] != gray || dst[1] != gray || dst[2] != gray || dst[3] != alpha)
+                        return false;
+                }
+                return true;
+            };
+
+            const QString label = QString("gray %1 channels").arg(channels);
+            bool valid = true;
+            reader->read();
+            const quint8* first = reader->image().constData();
+            valid &= testValue(texels(reader->image()), true, qPrintable(label + " read"));
+
+            reader->seek(reader->timeRange());
+            reader->read();
+            valid &= testValue(texels(reader->image()), true, qPrintable(label + " reread"));
+            valid &= testValue(reader->image().constData() == first, true, qPrintable(label + " storage"));
+            if (!valid)
+                ok = false;
+        }
     });
     group.wait();
     return ok.load();
@@ -2615,7 +3769,7 @@ testPluginImage()
 bool
 testPlugin()
 {
-    return testPluginFx() && testPluginContainer() && testPluginImage();
+    return testPluginFx() && testPluginContainer() && testPluginImage() && testPluginGray();
 }
 
 bool
@@ -2697,6 +3851,138 @@ testTimeLine()
         core::logErr() << "timeline track management failed" << Qt::endl;
         return false;
     }
+
+    av::Fps fps = av::Fps::fps24();
+    av::Clip* clip1 = new av::Clip(&timeline);
+    av::Clip* clip2 = new av::Clip(&timeline);
+    av::Clip* clip3 = new av::Clip(&timeline);
+    track2->insertClip(clip1, av::TimeRange(av::Time::fromFrames(0, fps), av::Time::fromFrames(48, fps)));
+    track2->insertClip(clip2, av::TimeRange(av::Time::fromFrames(24, fps), av::Time::fromFrames(48, fps)));
+    track2->insertClip(clip3, av::TimeRange(av::Time::fromFrames(96, fps), av::Time::fromFrames(24, fps)));
+
+    ok &= testValue(track2->clips().size(), static_cast<qsizetype>(3), "clip count");
+    ok &= testValue(track2->clips(av::Time::fromFrames(0, fps)).size(), static_cast<qsizetype>(1), "clips at 0");
+    ok &= testValue(track2->clips(av::Time::fromFrames(30, fps)).size(), static_cast<qsizetype>(2), "clips at 30");
+    ok &= testValue(track2->clips(av::Time::fromFrames(48, fps)).size(), static_cast<qsizetype>(1), "clips at 48");
+    ok &= testValue(track2->clips(av::Time::fromFrames(72, fps)).size(), static_cast<qsizetype>(0), "clips at 72");
+    ok &= testValue(track2->clips(av::Time::fromFrames(100, fps)).first() == clip3, true, "clip3 at 100");
+    ok &= testValue(
+        track2->clips(av::TimeRange(av::Time::fromFrames(60, fps), av::Time::fromFrames(40, fps))).size(),
+        static_cast<qsizetype>(2), "clips in range");
+    ok &= testValue(timeline.clips(av::Time::fromFrames(30, fps)).size(), static_cast<qsizetype>(2),
+                    "timeline clips at 30");
+
+    track2->insertClip(clip1, av::TimeRange(av::Time::fromFrames(120, fps), av::Time::fromFrames(24, fps)));
+    ok &= testValue(track2->clips(av::Time::fromFrames(0, fps)).size(), static_cast<qsizetype>(0), "moved clip");
+    ok &= testValue(track2->clips().last() == clip1, true, "clip order");
+    track2->removeClip(clip3);
+    ok &= testValue(track2->clips(av::Time::fromFrames(100, fps)).size(), static_cast<qsizetype>(0), "removed clip");
+
+    // clips that meet at a boundary in different timescales never overlap,
+    // even where the boundary in seconds rounds differently.
+    const qint64 boundary = (qint64(1) << 53) + 1;
+    av::Track* boundaryTrack = new av::Track(&timeline);
+    av::Clip* before = new av::Clip(&timeline);
+    av::Clip* after = new av::Clip(&timeline);
+    boundaryTrack->insertClip(before, av::TimeRange(av::Time(0, 1, fps), av::Time(boundary, 1, fps)));
+    boundaryTrack->insertClip(after, av::TimeRange(av::Time(3 * boundary, 3, fps), av::Time(3, 3, fps)));
+    const QList<av::Clip*> atBoundary = boundaryTrack->clips(av::Time(boundary, 1, fps));
+    ok &= testValue(atBoundary.size(), static_cast<qsizetype>(1), "clips at boundary");
+    ok &= testValue(atBoundary.value(0) == after, true, "clip after boundary");
+    const QList<av::Clip*> toBoundary = boundaryTrack->clips(
+        av::TimeRange(av::Time(boundary - 1, 1, fps), av::Time(1, 1, fps)));
+    ok &= testValue(toBoundary.size(), static_cast<qsizetype>(1), "clips to boundary");
+    ok &= testValue(toBoundary.value(0) == before, true, "clip before boundary");
+
+    if (!ok) {
+        core::logErr() << "timeline clip lookup failed" << Qt::endl;
+        return false;
+    }
+
+    ok &= testValue(timeline.isPlaying(), false, "not playing");
+    ok &= testValue(timeline.stats().presented, static_cast<qint64>(0), "stats presented");
+    ok &= testValue(timeline.stats().dropped, static_cast<qint64>(0), "stats dropped");
+    timeline.stop();
+    ok &= testValue(timeline.isPlaying(), false, "stop when idle");
+
+    if (!ok) {
+        core::logErr() << "timeline playback state failed" << Qt::endl;
+        return false;
+    }
+
+    // frame offsets at 1001 rates convert with exact ticks, a rounded tick
+    // step puts every frame from 2002 on one frame late.
+    av::Fps ntsc = av::Fps::fps29_97();
+    sdk::av::Timeline ntscTimeline;
+    ntscTimeline.setTimeRange(av::TimeRange(av::Time::fromFrames(0, ntsc), av::Time::fromFrames(3000, ntsc)));
+    for (qint64 frame : { qint64(2002), qint64(2100), qint64(2999) }) {
+        ntscTimeline.seek(av::Time::fromFrames(frame, ntsc));
+        ok &= testValue(ntscTimeline.time().frames(), frame, "29.97 seek frame");
+        ok &= testValue(ntscTimeline.time().ticks(), av::Time::fromFrames(frame, ntsc).ticks(), "29.97 seek ticks");
+    }
+
+    if (!ok) {
+        core::logErr() << "timeline frame conversion failed" << Qt::endl;
+        return false;
+    }
+
+    // an empty timeline plays 12 frames. A frame that stalls for three frame
+    // durations drops the frames that passed, in every frame mode the next
+    // frame is late and the schedule restarts from it. Pacing runs against
+    // the wall clock, counts that a loaded machine can change are checked
+    // as ranges.
+    sdk::av::Timeline playback;
+    playback.setTimeRange(av::TimeRange(av::Time::fromFrames(0, fps), av::Time::fromFrames(12, fps)));
+
+    std::atomic<bool> stall = false;
+    QObject::connect(&playback, &av::Timeline::timeChanged, [&](const av::Time& time) {
+        if (stall && time.frames() == 2)
+            QThread::msleep(3 * 1000 / 24);
+    });
+
+    auto waitForStop = [&]() {
+        QElapsedTimer timer;
+        timer.start();
+        while (playback.isPlaying() && timer.elapsed() < 5000)
+            QThread::msleep(1);
+        return !playback.isPlaying();
+    };
+
+    playback.play();
+    playback.stop();
+    playback.play();
+    ok &= testValue(playback.isPlaying(), true, "play after stop");
+    ok &= testValue(waitForStop(), true, "play after stop to end");
+
+    playback.seek(av::Time::fromFrames(0, fps));
+    playback.resetStats();
+    playback.play();
+    ok &= testValue(waitForStop(), true, "play to end");
+    ok &= testValue(playback.stats().presented > 0 && playback.stats().presented <= 12, true, "presented frames");
+    ok &= testValue(playback.stats().presented + playback.stats().dropped >= 12, true, "frames accounted");
+    ok &= testValue(playback.stats().onTime > 0, true, "on time frames");
+
+    stall = true;
+    playback.seek(av::Time::fromFrames(0, fps));
+    playback.resetStats();
+    playback.play();
+    ok &= testValue(waitForStop(), true, "play with stall");
+    ok &= testValue(playback.stats().dropped > 0, true, "stalled frames dropped");
+    ok &= testValue(playback.stats().presented + playback.stats().dropped >= 12, true, "stalled frames accounted");
+
+    playback.setEveryFrame(true);
+    playback.seek(av::Time::fromFrames(0, fps));
+    playback.resetStats();
+    playback.play();
+    ok &= testValue(waitForStop(), true, "play every frame");
+    ok &= testValue(playback.stats().presented, static_cast<qint64>(12), "every frame presented");
+    ok &= testValue(playback.stats().dropped, static_cast<qint64>(0), "every frame dropped");
+    ok &= testValue(playback.stats().late >= 1 && playback.stats().late < 12, true, "every frame late");
+
+    if (!ok) {
+        core::logErr() << "timeline playback failed" << Qt::endl;
+        return false;
+    }
     return true;
 }
 }  // namespace flipman::sdk::test
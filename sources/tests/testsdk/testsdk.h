@@ -11,6 +11,8 @@ testClip();
 bool
 testFile();
 bool
+testFileScanner();
+bool
 testFps();
 bool
 testImage();
@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/core/application.h>
+#include <flipmansdk/core/file.h>
+#include <flipmansdk/core/filerange.h>
+#include <flipmansdk/core/filescanner.h>
+#include <flipmansdk/core/log.h>
+#include <flipmansdk/core/threadpool.h>
+#include <flipmansdk/plugins/mediareader.h>
+#include <flipmansdk/plugins/pluginregistry.h>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRect>
+
+#include <vector>
+
+using namespace flipman::sdk;
+
+namespace {
+struct Probe {
+    core::File file;
+    core::MetaData metaData;
+    av::Fps fps;
+    av::TimeRange timeRange;
+    core::Error error;
+    qint64 createNs = 0;
+    qint64 probeNs = 0;
+    qint64 totalNs = 0;
+};
+
+const QList<core::MetaData::Group> groups = { core::MetaData::Group::Container, core::MetaData::Group::Video,
+                                              core::MetaData::Group::Audio,     core::MetaData::Group::Camera,
+                                              core::MetaData::Group::Timecode,  core::MetaData::Group::Production,
+                                              core::MetaData::Group::Custom };
+
+QList<core::File>
+resolve(const QStringList& paths)
+{
+    // directories are listed as sequences, '#' patterns resolve to their
+    // range and other paths are probed as given.
+    QList<core::File> files;
+    core::FileScanner scanner;
+    scanner.setHoles(true);
+    for (const QString& path : paths) {
+        if (QFileInfo(path).isDir())
+            files.append(scanner.scan(path));
+        else if (path.contains('#'))
+            files.append(core::File(path));
+        else
+            files.append(core::File(QFileInfo(path)));
+    }
+    return files;
+}
+
+void
+probe(Probe& probe)
+{
+    QElapsedTimer total;
+    total.start();
+
+    QScopedPointer<plugins::MediaReader> reader(
+        core::pluginRegistry()->getPlugin<plugins::MediaReader>(probe.file.extension().toLower()));
+    probe.createNs = total.nsecsElapsed();
+    if (!reader) {
+        probe.error = core::Error("flipinfo",
+                                  QString("could not find plugin for extension: %1").arg(probe.file.extension()));
+        probe.totalNs = total.nsecsElapsed();
+        return;
+    }
+
+    // probe reads headers only, no pixels are allocated or decoded.
+    QElapsedTimer timer;
+    timer.start();
+    probe.metaData = reader->probe(probe.file);
+    probe.probeNs = timer.nsecsElapsed();
+    probe.totalNs = total.nsecsElapsed();
+
+    if (!probe.metaData.isValid()) {
+        probe.error = reader->error().hasError() ? reader->error() : core::Error("flipinfo", "could not probe file");
+        return;
+    }
+    probe.fps = probe.metaData.value(core::MetaData::Group::Video, "fps").value<av::Fps>();
+    probe.timeRange = probe.metaData.value(core::MetaData::Group::Container, "timeRange").value<av::TimeRange>();
+}
+
+QString
+path(const core::File& file)
+{
+    const core::FileRange range = file.fileRange();
+    return range.isValid() ? range.pattern() : file.filePath();
+}
+
+QString
+value(const QVariant& value)
+{
+    if (value.typeId() == qMetaTypeId<av::Fps>())
+        return value.value<av::Fps>().toString();
+    if (value.typeId() == qMetaTypeId<av::TimeRange>())
+        return value.value<av::TimeRange>().toString();
+    if (value.typeId() == QMetaType::QRect) {
+        const QRect rect = value.toRect();
+        return QString("%1,%2 %3x%4").arg(rect.x()).arg(rect.y()).arg(rect.width()).arg(rect.height());
+    }
+    if (value.typeId() == QMetaType::QStringList)
+        return value.toStringList().join(',');
+    return value.toString();
+}
+
+QJsonValue
+json(const QVariant& variant)
+{
+    const QJsonValue json = QJsonValue::fromVariant(variant);
+    return json.isNull() || json.isUndefined() ? QJsonValue(value(variant)) : json;
+}
+
+void
+writeText(QTextStream& stream, const Probe& probe, bool timing)
+{
+    stream << path(probe.file) << '\n';
+    if (probe.error.hasError()) {
+        stream << "  error: " << probe.error.message() << '\n';
+    }
+    else {
+        const core::FileRange range = probe.file.fileRange();
+        const core::MetaData& metaData = probe.metaData;
+        const core::MetaData::Group video = core::MetaData::Group::Video;
+        stream << "  resolution: " << value(metaData.value(video, "width")) << "x"
+               << value(metaData.value(video, "height")) << '\n';
+        stream << "  channels: " << value(metaData.value(video, "channels")) << " ("
+               << value(metaData.value(video, "channelNames")) << ")" << '\n';
+        stream << "  pixel type: " << value(metaData.value(video, "pixelType")) << '\n';
+        stream << "  fps: " << probe.fps.toString() << '\n';
+        stream << "  time range: " << probe.timeRange.toString() << '\n';
+        if (range.isValid())
+            stream << "  frames: " << range.start() << "-" << range.end() << " (" << range.size() << ")" << '\n';
+
+        for (core::MetaData::Group group : groups) {
+            const QList<QString> keys = metaData.keys(group);
+            if (keys.isEmpty())
+                continue;
+            stream << "  " << core::MetaData::convert(group) << ":" << '\n';
+            for (const QString& key : keys)
+                stream << "    " << key << ": " << value(metaData.value(group, key)) << '\n';
+        }
+    }
+    if (timing) {
+        stream << "  timing: create " << probe.createNs / 1e6 << " ms, probe " << probe.probeNs / 1e6 << " ms, total "
+               << probe.totalNs / 1e6 << " ms" << '\n';
+    }
+}
+
+void
+writeJson(QTextStream& stream, const Probe& probe, bool timing)
+{
+    QJsonObject object;
+    object["path"] = path(probe.file);
+    if (probe.error.hasError()) {
+        object["error"] = probe.error.message();
+    }
+    else {
+        const core::FileRange range = probe.file.fileRange();
+        object["fps"] = probe.fps.toString();
+        object["timeRange"] = probe.timeRange.toString();
+        if (range.isValid()) {
+            object["first"] = range.start();
+            object["last"] = range.end();
+            object["frames"] = range.size();
+        }
+
+        QJsonObject metaData;
+        for (core::MetaData::Group group : groups) {
+            QJsonObject values;
+            for (const QString& key : probe.metaData.keys(group))
+                values[key] = json(probe.metaData.value(group, key));
+            if (!values.isEmpty())
+                metaData[core::MetaData::convert(group)] = values;
+        }
+        object["metaData"] = metaData;
+    }
+    if (timing) {
+        object["timing"] = QJsonObject { { "createMs", probe.createNs / 1e6 },
+                                         { "probeMs", probe.probeNs / 1e6 },
+                                         { "totalMs", probe.totalNs / 1e6 } };
+    }
+    stream << QJsonDocument(object).toJson(QJsonDocument::Compact) << '\n';
+}
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // probing needs no display, the application is only created for the
+    // plugin registry.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    core::Application app(argc, argv);
+    QCoreApplication::setApplicationName("flipinfo");
+    QCoreApplication::setApplicationVersion(PROJECT_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Probes media headers without decoding pixels.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("paths", "Files, '#' sequence patterns or directories to probe.", "paths...");
+
+    const QCommandLineOption jsonOption({ "j", "json" }, "Write one JSON object per line.");
+    const QCommandLineOption timingOption({ "T", "timing" }, "Report plugin, probe and total time per input.");
+    const QCommandLineOption threadsOption({ "t", "threads" }, "Number of inputs probed concurrently.", "count");
+    parser.addOptions({ jsonOption, timingOption, threadsOption });
+    parser.process(app);
+
+    if (parser.isSet(threadsOption)) {
+        bool ok = false;
+        const int threads = parser.value(threadsOption).toInt(&ok);
+        if (!ok || threads < 1) {
+            core::logErr() << "flipinfo: invalid thread count: " << parser.value(threadsOption) << Qt::endl;
+            return 1;
+        }
+        core::threadPool()->setMaxThreadCount(threads);
+    }
+
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty())
+        parser.showHelp(1);
+
+    std::vector<Probe> probes;
+    for (const core::File& file : resolve(paths))
+        probes.push_back(Probe { file });
+
+    core::threadPool()->parallelFor(qint64(probes.size()), [&](qint64 index) { probe(probes[size_t(index)]); });
+
+    QTextStream& stream = core::logOut();
+    const bool json = parser.isSet(jsonOption);
+    const bool timing = parser.isSet(timingOption);
+    bool failed = false;
+    for (const Probe& probe : probes) {
+        if (json)
+            writeJson(stream, probe, timing);
+        else
+            writeText(stream, probe, timing);
+        failed |= probe.error.hasError();
+    }
+    stream.flush();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) 2024 - present Mikael Sundell
+// https://github.com/mikaelsundell/flipman
+
+#include <flipmansdk/core/file.h>
+#include <flipmansdk/core/filerange.h>
+#include <flipmansdk/core/filescanner.h>
+#include <flipmansdk/core/log.h>
+#include <flipmansdk/core/threadpool.h>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace flipman::sdk;
+
+namespace {
+struct Sequence {
+    core::File file;
+    qint64 bytes = -1;
+};
+
+struct Span {
+    qint64 first;
+    qint64 last;
+};
+
+QList<Span>
+missing(const core::FileRange& range)
+{
+    // holes are reported as spans, a missing block of frames is one entry.
+    QList<Span> spans;
+    for (qint64 frame : range.holes()) {
+        if (spans.size() && spans.back().last + range.step() == frame)
+            spans.back().last = frame;
+        else
+            spans.append(Span { frame, frame });
+    }
+    return spans;
+}
+
+QString
+span(const Span& span)
+{
+    return span.first == span.last ? QString::number(span.first) : QString("%1-%2").arg(span.first).arg(span.last);
+}
+
+QString
+path(const core::File& file)
+{
+    const core::FileRange range = file.fileRange();
+    return range.isValid() ? range.pattern() : file.filePath();
+}
+
+void
+measure(std::vector<Sequence>& sequences)
+{
+    // sizes need a stat per frame, the frames of all sequences are spread
+    // over the pool in one flat loop so one long sequence does not serialize
+    // the run and no loop is nested on the pool.
+    std::vector<core::FileRange> ranges(sequences.size());
+    std::vector<qint64> offsets(sequences.size() + 1, 0);
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        const core::FileRange& range = ranges[i] = sequences[i].file.fileRange();
+        const qint64 slots = range.isValid() ? (range.end() - range.start()) / range.step() + 1 : 1;
+        offsets[i + 1] = offsets[i] + slots;
+    }
+
+    std::vector<std::atomic<qint64>> bytes(sequences.size());
+    core::threadPool()->parallelFor(offsets.back(), [&](qint64 slot) {
+        const size_t index = size_t(std::upper_bound(offsets.begin(), offsets.end(), slot) - offsets.begin()) - 1;
+        const core::FileRange& range = ranges[index];
+        if (!range.isValid()) {
+            bytes[index] += sequences[index].file.size();
+            return;
+        }
+        const qint64 frame = range.start() + (slot - offsets[index]) * range.step();
+        if (range.hasFrame(frame))
+            bytes[index] += QFileInfo(range.filePath(frame)).size();
+    });
+
+    for (size_t i = 0; i < sequences.size(); ++i)
+        sequences[i].bytes = bytes[i];
+}
+
+void
+writeText(QTextStream& stream, const Sequence& sequence, bool bytes)
+{
+    const core::FileRange range = sequence.file.fileRange();
+    stream << QString("%1/%2").arg(sequence.file.dirName(), sequence.file.displayName());
+    if (range.isValid()) {
+        stream << "  " << range.size() << (range.size() == 1 ? " frame" : " frames");
+        const QList<Span> spans = missing(range);
+        if (spans.size()) {
+            QStringList holes;
+            for (const Span& hole : spans)
+                holes.append(span(hole));
+            stream << "  missing: " << holes.join(',');
+        }
+    }
+    if (bytes)
+        stream << "  " << sequence.bytes;
+    stream << '\n';
+}
+
+void
+writeJson(QTextStream& stream, const Sequence& sequence, bool bytes)
+{
+    const core::FileRange range = sequence.file.fileRange();
+    QJsonObject object;
+    object["path"] = path(sequence.file);
+    if (range.isValid()) {
+        object["first"] = range.start();
+        object["last"] = range.end();
+        object["frames"] = range.size();
+        QJsonArray holes;
+        for (const Span& hole : missing(range))
+            holes.append(QJsonArray { hole.first, hole.last });
+        object["missing"] = holes;
+    }
+    if (bytes)
+        object["bytes"] = sequence.bytes;
+    stream << QJsonDocument(object).toJson(QJsonDocument::Compact) << '\n';
+}
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("flipls");
+    QCoreApplication::setApplicationVersion(PROJECT_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Lists files and collapses numbered files into frame ranges.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("paths", "Directories to list, defaults to the current directory.", "[paths...]");
+
+    const QCommandLineOption recursiveOption({ "r", "recursive" }, "List subdirectories recursively.");
+    const QCommandLineOption jsonOption({ "j", "json" }, "Write one JSON object per line.");
+    const QCommandLineOption bytesOption({ "b", "bytes" }, "Report total bytes per file and sequence.");
+    const QCommandLineOption splitOption({ "s", "split" }, "Split ranges at missing frames.");
+    const QCommandLineOption threadsOption({ "t", "threads" }, "Number of worker threads.", "count");
+    parser.addOptions({ recursiveOption, jsonOption, bytesOption, splitOption, threadsOption });
+    parser.process(app);
+
+    if (parser.isSet(threadsOption)) {
+        bool ok = false;
+        const int threads = parser.value(threadsOption).toInt(&ok);
+        if (!ok || threads < 1) {
+            core::logErr() << "flipls: invalid thread count: " << parser.value(threadsOption) << Qt::endl;
+            return 1;
+        }
+        core::threadPool()->setMaxThreadCount(threads);
+    }
+
+    QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty())
+        paths.append(".");
+
+    core::FileScanner scanner;
+    scanner.setRecursive(parser.isSet(recursiveOption));
+    scanner.setHoles(!parser.isSet(splitOption));
+
+    std::vector<Sequence> sequences;
+    for (const core::File& file : scanner.scan(paths))
+        sequences.push_back(Sequence { file });
+
+    const bool bytes = parser.isSet(bytesOption);
+    if (bytes)
+        measure(sequences);
+
+    QTextStream& stream = core::logOut();
+    const bool json = parser.isSet(jsonOption);
+    for (const Sequence& sequence : sequences) {
+        if (json)
+            writeJson(stream, sequence, bytes);
+        else
+            writeText(stream, sequence, bytes);
+    }
+    stream.flush();
+
+    if (scanner.error().hasError()) {
+        core::logErr() << "flipls: " << scanner.error().message() << Qt::endl;
+        return 1;
+    }
+    return 0;
+}